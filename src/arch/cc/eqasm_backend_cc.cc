@@ -38,10 +38,10 @@ namespace ql
     namespace arch
     {
 #if OPT_CC_SCHEDULE_RC
-        ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt,
+        ql::ir::flat_bundles_t cc_light_schedule_rc(ql::circuit & ckt,
             const ql::quantum_platform & platform, std::string & dot, size_t nqubits, size_t ncreg = 0);
 #else
-        ql::ir::bundles_t cc_light_schedule(ql::circuit & ckt,
+        ql::ir::flat_bundles_t cc_light_schedule(ql::circuit & ckt,
             const ql::quantum_platform & platform, std::string & dot, size_t nqubits, size_t ncreg = 0);
 #endif
 
@@ -132,14 +132,14 @@ void eqasm_backend_cc::compile(std::string prog_name, std::vector<quantum_kernel
             std::string kernel_sched_dot;
             std::string kernel_dot;
             kernel.schedule(platform, kernel_sched_qasm, kernel_dot, kernel_sched_dot);
-            ql::ir::bundles_t bundles = ql::ir::bundler(kernel.c, platform.cycle_time);
+            ql::ir::flat_bundles_t bundles = ql::ir::bundler(kernel.c, platform.cycle_time);
 #else
             auto creg_count = kernel.creg_count;     // FIXME: there is no platform.creg_count
 
 #if OPT_CC_SCHEDULE_RC
             // schedule with platform resource constraints
             std::string     sched_dot;
-            ql::ir::bundles_t bundles = cc_light_schedule_rc(ckt, platform, sched_dot, platform.qubit_number, creg_count);
+            ql::ir::flat_bundles_t bundles = cc_light_schedule_rc(ckt, platform, sched_dot, platform.qubit_number, creg_count);
 #else
             // schedule without resource constraints
             /* FIXME: we use the "CC-light" scheduler, which actually has little platform specifics apart from
@@ -147,7 +147,7 @@ void eqasm_backend_cc::compile(std::string prog_name, std::vector<quantum_kernel
              * That function could and should be generalized.
              */
             std::string     sched_dot;
-            ql::ir::bundles_t bundles = cc_light_schedule(ckt, platform, sched_dot, platform.qubit_number, creg_count);
+            ql::ir::flat_bundles_t bundles = cc_light_schedule(ckt, platform, sched_dot, platform.qubit_number, creg_count);
 #endif
 #endif
 
@@ -166,7 +166,7 @@ void eqasm_backend_cc::compile(std::string prog_name, std::vector<quantum_kernel
 
             codegen.kernel_start();
             codegen_bundles(bundles, platform);
-            codegen.kernel_finish(kernel.name, bundles.back().start_cycle+bundles.back().duration_in_cycles);
+            codegen.kernel_finish(kernel.name, bundles.start_cycle.back()+bundles.duration_in_cycles.back());
         } else {
             DOUT("Empty kernel: " << kernel.name);                      // NB: normal situation for kernels with classical control
         }
@@ -364,26 +364,29 @@ void eqasm_backend_cc::codegen_kernel_epilogue(ql::quantum_kernel &k)
 
 
 // based on cc_light_eqasm_compiler.h::bundles2qisa()
-void eqasm_backend_cc::codegen_bundles(ql::ir::bundles_t &bundles, const ql::quantum_platform &platform)
+void eqasm_backend_cc::codegen_bundles(ql::ir::flat_bundles_t &bundles, const ql::quantum_platform &platform)
 {
     IOUT("Generating .vq1asm for bundles");
 
-    for(ql::ir::bundle_t &bundle : bundles) {
+    for(size_t b = 0; b < bundles.size(); b++) {
+        size_t start_cycle = bundles.start_cycle[b];
+        size_t duration_in_cycles = bundles.duration_in_cycles[b];
+
         // generate bundle header
         codegen.bundle_start(SS2S("## Bundle " << bundleIdx++
-                                  << ": start_cycle=" << bundle.start_cycle
-                                  << ", duration_in_cycles=" << bundle.duration_in_cycles << ":"
+                                  << ": start_cycle=" << start_cycle
+                                  << ", duration_in_cycles=" << duration_in_cycles << ":"
                                   ));
         // NB: the "wait" instruction never makes it into the bundle. It is accounted for in scheduling though,
         // and if a non-zero duration is specified that duration is reflected in 'start_cycle' of the subsequent instruction
 
         // generate code for this bundle
-        for(auto section = bundle.parallel_sections.begin(); section != bundle.parallel_sections.end(); ++section ) {
+        for(size_t section = bundles.sections_begin(b); section < bundles.sections_end(b); section++) {
             // check whether section defines classical gate
-            ql::gate *firstInstr = *section->begin();
+            ql::gate *firstInstr = bundles.gates[bundles.gates_begin(section)];
             auto firstInstrType = firstInstr->type();
             if(firstInstrType == __classical_gate__) {
-                if(section->size() != 1) {
+                if(bundles.gates_end(section) - bundles.gates_begin(section) != 1) {
                     FATAL("Inconsistency detected in bundle contents: classical gate with parallel sections");
                 }
                 codegen_classical_instruction(firstInstr);
@@ -392,8 +395,8 @@ void eqasm_backend_cc::codegen_bundles(ql::ir::bundles_t &bundles, const ql::qua
                  * NB: our strategy differs from cc_light_eqasm_compiler, we have no special treatment of first instruction
                  * and don't require all instructions to be identical
                  */
-                for(auto insIt = section->begin(); insIt != section->end(); ++insIt) {
-                    ql::gate *instr = *insIt;
+                for(size_t i = bundles.gates_begin(section); i < bundles.gates_end(section); i++) {
+                    ql::gate *instr = bundles.gates[i];
                     ql::gate_type_t itype = instr->type();
                     std::string iname = instr->name;
 
@@ -407,7 +410,7 @@ void eqasm_backend_cc::codegen_bundles(ql::ir::bundles_t &bundles, const ql::qua
                             break;
 
                         case __custom_gate__:
-                            codegen.custom_gate(iname, instr->operands, instr->creg_operands, instr->angle, bundle.start_cycle, instr->duration);
+                            codegen.custom_gate(iname, instr->operands, instr->creg_operands, instr->angle, start_cycle, instr->duration);
                             break;
 
                         case __display__:
@@ -426,8 +429,8 @@ void eqasm_backend_cc::codegen_bundles(ql::ir::bundles_t &bundles, const ql::qua
         }
 
         // generate bundle trailer, and code for classical gates
-        bool isLastBundle = &bundle==&bundles.back();
-        codegen.bundle_finish(bundle.start_cycle, bundle.duration_in_cycles, isLastBundle);
+        bool isLastBundle = b+1 == bundles.size();
+        codegen.bundle_finish(start_cycle, duration_in_cycles, isLastBundle);
     }   // for(bundles)
 
     IOUT("Generating .vq1asm for bundles [Done]");
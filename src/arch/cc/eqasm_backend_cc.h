@@ -38,7 +38,7 @@ private:
     void codegen_classical_instruction(ql::gate *classical_ins);
     void codegen_kernel_prologue(ql::quantum_kernel &k);
     void codegen_kernel_epilogue(ql::quantum_kernel &k);
-    void codegen_bundles(ql::ir::bundles_t &bundles, const ql::quantum_platform &platform);
+    void codegen_bundles(ql::ir::flat_bundles_t &bundles, const ql::quantum_platform &platform);
     void load_hw_settings(const ql::quantum_platform& platform);
 
 private: // vars
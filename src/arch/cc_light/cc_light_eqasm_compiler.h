@@ -19,6 +19,7 @@
 #include <arch/cc_light/cc_light_eqasm.h>
 #include <arch/cc_light/cc_light_scheduler.h>
 #include <mapper.h>
+#include <thread_pool.h>
 #include <clifford.h>
 #include <qsoverlay.h>
 
@@ -421,7 +422,7 @@ std::string classical_instruction2qisa(ql::arch::classical_cc* classical_ins)
 }
 
 
-std::string bundles2qisa(ql::ir::bundles_t & bundles,
+std::string bundles2qisa(ql::ir::flat_bundles_t & bundles,
     const ql::quantum_platform & platform, MaskManager & gMaskManager)
 {
     IOUT("Generating CC-Light QISA");
@@ -439,25 +440,21 @@ std::string bundles2qisa(ql::ir::bundles_t & bundles,
     // y s1 | x s0
     // However, with sorting it will always generate:
     // x s0 | y s1
-    for (ql::ir::bundle_t & abundle : bundles)
+    for (size_t b = 0; b < bundles.size(); b++)
     {
         // sorts instructions alphabetically
-        abundle.parallel_sections.sort( []
-            (const ql::ir::section_t & sec1, const ql::ir::section_t & sec2) -> bool
+        bundles.sort_sections(b, []
+            (const ql::gate * first1, const ql::gate * first2) -> bool
             {
-                auto i1 = sec1.begin();
-                auto iname1 = (*(i1))->name;
-                auto i2 = sec2.begin();
-                auto iname2 = (*(i2))->name;
-                return iname2 < iname1;
+                return first2->name < first1->name;
             });
     }
 
-    for (ql::ir::bundle_t & abundle : bundles)
+    for (size_t b = 0; b < bundles.size(); b++)
     {
         std::string iname;
         std::stringstream sspre, ssinst;
-        auto bcycle = abundle.start_cycle;
+        auto bcycle = bundles.start_cycle[b];
         auto delta = bcycle - curr_cycle;
         bool classical_bundle=false;
         if(delta < 8)
@@ -466,42 +463,41 @@ std::string bundles2qisa(ql::ir::bundles_t & bundles,
             sspre << "    qwait " << delta-1 << "\n"
                   << "    1    ";
 
-        for(auto secIt = abundle.parallel_sections.begin();
-            secIt != abundle.parallel_sections.end(); ++secIt )
+        for (size_t s = bundles.sections_begin(b); s < bundles.sections_end(b); s++)
         {
             qubit_set_t squbits;
             qubit_pair_set_t dqubits;
-            auto firstInsIt = secIt->begin();
-            iname = (*(firstInsIt))->name;
-            auto itype = (*(firstInsIt))->type();
+            auto firstIns = bundles.gates[bundles.gates_begin(s)];
+            iname = firstIns->name;
+            auto itype = firstIns->type();
 
             if(__classical_gate__ == itype)
             {
                 classical_bundle = true;
-                ssinst << classical_instruction2qisa( (ql::arch::classical_cc *)(*firstInsIt) );
+                ssinst << classical_instruction2qisa( (ql::arch::classical_cc *)firstIns );
             }
             else
             {
                 DOUT("get cclight instr name for : " << iname);
                 std::string cc_light_instr_name = get_cc_light_instruction_name(iname, platform);
-                auto nOperands = ((*firstInsIt)->operands).size();
+                auto nOperands = (firstIns->operands).size();
                 if( itype == __nop_gate__ )
                 {
                     ssinst << cc_light_instr_name;
                 }
                 else
                 {
-                    for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
+                    for (size_t i = bundles.gates_begin(s); i < bundles.gates_end(s); i++)
                     {
                         if( 1 == nOperands )
                         {
-                            auto & op = (*insIt)->operands[0];
+                            auto & op = bundles.gates[i]->operands[0];
                             squbits.push_back(op);
                         }
                         else if( 2 == nOperands )
                         {
-                            auto & op1 = (*insIt)->operands[0];
-                            auto & op2 = (*insIt)->operands[1];
+                            auto & op1 = bundles.gates[i]->operands[0];
+                            auto & op2 = bundles.gates[i]->operands[1];
                             dqubits.push_back( qubit_pair_t(op1, op2) );
                         }
                         else
@@ -528,7 +524,7 @@ std::string bundles2qisa(ql::ir::bundles_t & bundles,
                 }
             }
 
-            if( std::next(secIt) != abundle.parallel_sections.end() )
+            if( s+1 != bundles.sections_end(b) )
             {
                 ssinst << " | ";
             }
@@ -565,17 +561,19 @@ std::string bundles2qisa(ql::ir::bundles_t & bundles,
         curr_cycle+=delta;
     }
 
-    auto & lastBundle = bundles.back();
-    int lbduration = lastBundle.duration_in_cycles;
-    if(lbduration>1)
-        ssbundles << "    qwait " << lbduration << "\n";
+    if (!bundles.empty())
+    {
+        int lbduration = bundles.duration_in_cycles.back();
+        if(lbduration>1)
+            ssbundles << "    qwait " << lbduration << "\n";
+    }
 
     IOUT("Generating CC-Light QISA [Done]");
     return ssbundles.str();
 }
 
 void WriteCCLightQisa(std::string prog_name, const ql::quantum_platform & platform, MaskManager & gMaskManager,
-    ql::ir::bundles_t & bundles)
+    ql::ir::flat_bundles_t & bundles)
 {
     IOUT("Generating CC-Light QISA");
 
@@ -606,7 +604,7 @@ void WriteCCLightQisa(std::string prog_name, const ql::quantum_platform & platfo
 
 
 void WriteCCLightQisaTimeStamped(std::string prog_name, const ql::quantum_platform & platform, MaskManager & gMaskManager,
-    ql::ir::bundles_t & bundles)
+    ql::ir::flat_bundles_t & bundles)
 {
     IOUT("Generating Time-stamped CC-Light QISA");
     ofstream fout;
@@ -623,9 +621,9 @@ void WriteCCLightQisaTimeStamped(std::string prog_name, const ql::quantum_platfo
     std::stringstream ssbundles;
     size_t curr_cycle=0; // first instruction should be with pre-interval 1, 'bs 1'
     ssbundles << "start:" << "\n";
-    for (ql::ir::bundle_t & abundle : bundles)
+    for (size_t b = 0; b < bundles.size(); b++)
     {
-        auto bcycle = abundle.start_cycle;
+        auto bcycle = bundles.start_cycle[b];
         auto delta = bcycle - curr_cycle;
 
         if(delta < 8)
@@ -634,33 +632,33 @@ void WriteCCLightQisaTimeStamped(std::string prog_name, const ql::quantum_platfo
             ssbundles << std::setw(8) << curr_cycle << ":    qwait " << delta-1 << "\n"
                       << std::setw(8) << curr_cycle + (delta-1) << ":    bs 1    ";
 
-        for(auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt)
+        for (size_t s = bundles.sections_begin(b); s < bundles.sections_end(b); s++)
         {
             qubit_set_t squbits;
             qubit_pair_set_t dqubits;
-            auto firstInsIt = secIt->begin();
+            auto firstIns = bundles.gates[bundles.gates_begin(s)];
 
-            auto id = (*(firstInsIt))->name;
+            auto id = firstIns->name;
             std::string cc_light_instr_name = get_cc_light_instruction_name(id, platform);
-            auto itype = (*(firstInsIt))->type();
-            auto nOperands = ((*firstInsIt)->operands).size();
+            auto itype = firstIns->type();
+            auto nOperands = (firstIns->operands).size();
             if(itype == __nop_gate__)
             {
                 ssbundles << cc_light_instr_name;
             }
             else
             {
-                for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
+                for (size_t i = bundles.gates_begin(s); i < bundles.gates_end(s); i++)
                 {
                     if( 1 == nOperands )
                     {
-                        auto & op = (*insIt)->operands[0];
+                        auto & op = bundles.gates[i]->operands[0];
                         squbits.push_back(op);
                     }
                     else if( 2 == nOperands )
                     {
-                        auto & op1 = (*insIt)->operands[0];
-                        auto & op2 = (*insIt)->operands[1];
+                        auto & op1 = bundles.gates[i]->operands[0];
+                        auto & op2 = bundles.gates[i]->operands[1];
                         dqubits.push_back( qubit_pair_t(op1,op2) );
                     }
                     else
@@ -685,7 +683,7 @@ void WriteCCLightQisaTimeStamped(std::string prog_name, const ql::quantum_platfo
                 ssbundles << cc_light_instr_name << " " << rname;
             }
 
-            if(std::next(secIt) != abundle.parallel_sections.end())
+            if(s+1 != bundles.sections_end(b))
             {
                 ssbundles << " | ";
             }
@@ -694,8 +692,7 @@ void WriteCCLightQisaTimeStamped(std::string prog_name, const ql::quantum_platfo
         ssbundles << "\n";
     }
 
-    auto & lastBundle = bundles.back();
-    int lbduration = lastBundle.duration_in_cycles;
+    int lbduration = (bundles.empty() ? 0 : bundles.duration_in_cycles.back());
     if( lbduration>1 )
         ssbundles << std::setw(8) << curr_cycle   << ":    qwait " << lbduration << "\n";
     curr_cycle+=lbduration;
@@ -824,11 +821,9 @@ public:
     }
 
 
-    void decompose_post_schedule(ql::ir::bundles_t & bundles_dst,
+    void decompose_post_schedule(ql::ir::flat_bundles_t & bundles, ql::gate_arena_t & arena,
         const ql::quantum_platform& platform)
     {
-        auto bundles_src = bundles_dst;
-
         IOUT("Post scheduling decomposition ...");
         if (ql::options::get("cz_mode") == "auto")
         {
@@ -867,23 +862,26 @@ public:
                     edge_detunes_qubits[edgeNo].push_back(q);
             }
 
-            for (
-                auto bundles_src_it = bundles_src.begin(), bundles_dst_it = bundles_dst.begin();
-                bundles_src_it != bundles_src.end() && bundles_dst_it != bundles_dst.end();
-                ++bundles_src_it, ++bundles_dst_it
-                )
+            // build the decomposed bundles in a single scan over the bundles;
+            // the sqf gates for a bundle are added in private sections after its original sections
+            ql::ir::flat_bundles_t decomposed;
+            decomposed.reserve(bundles.gates.size());
+            std::vector<ql::gate*> sqf_gates;
+            for (size_t b = 0; b < bundles.size(); b++)
             {
-                for(auto sec_src_it = bundles_src_it->parallel_sections.begin();
-                    sec_src_it != bundles_src_it->parallel_sections.end();
-                    ++sec_src_it)
+                decomposed.add_bundle(bundles.start_cycle[b], bundles.duration_in_cycles[b]);
+                sqf_gates.clear();
+                for (size_t s = bundles.sections_begin(b); s < bundles.sections_end(b); s++)
                 {
-                    for(auto ins_src_it = sec_src_it->begin();
-                        ins_src_it != sec_src_it->end();
-                        ++ins_src_it )
+                    decomposed.add_section();
+                    for (size_t i = bundles.gates_begin(s); i < bundles.gates_end(s); i++)
                     {
-                        std::string id = (*ins_src_it)->name;
+                        ql::gate* ins = bundles.gates[i];
+                        decomposed.add_gate(ins);
+
+                        std::string id = ins->name;
                         std::string operation_type = "";
-                        size_t nOperands = ((*ins_src_it)->operands).size();
+                        size_t nOperands = (ins->operands).size();
                         if(2 == nOperands)
                         {
                             auto it = platform.instruction_map.find(id);
@@ -902,8 +900,8 @@ public:
                             bool is_flux_2_qubit = ( (operation_type == "flux") );
                             if( is_flux_2_qubit )
                             {
-                                auto & q0 = (*ins_src_it)->operands[0];
-                                auto & q1 = (*ins_src_it)->operands[1];
+                                auto & q0 = ins->operands[0];
+                                auto & q1 = ins->operands[1];
                                 DOUT("found 2 qubit flux gate on " << q0 << " and " << q1);
                                 qubits_pair_t aqpair(q0, q1);
                                 auto it = qubitpair2edge.find(aqpair);
@@ -914,19 +912,22 @@ public:
                                     for( auto & q : edge_detunes_qubits[edge_no])
                                     {
                                         DOUT("sqf q" << q);
-                                        custom_gate* g = new custom_gate("sqf q"+std::to_string(q));
+                                        custom_gate* g = arena.create<custom_gate>("sqf q"+std::to_string(q));
                                         g->operands.push_back(q);
-
-                                        ql::ir::section_t asec;
-                                        asec.push_back(g);
-                                        bundles_dst_it->parallel_sections.push_back(asec);
+                                        sqf_gates.push_back(g);
                                     }
                                 }
                             }
                         }
                     }
                 }
+                for (auto g : sqf_gates)
+                {
+                    decomposed.add_section();
+                    decomposed.add_gate(g);
+                }
             }
+            bundles = std::move(decomposed);
         }
         IOUT("Post scheduling decomposition [Done]");
     }
@@ -1004,6 +1005,15 @@ public:
             ss << "# ----- realqubit states before mapper:" << ql::utils::to_string(mapper.rs_in) << "\n";
             ss << "# ----- realqubit states after mapper:" << ql::utils::to_string(mapper.rs_out) << "\n";
             ss << "# ----- time taken: " << timetaken << "\n";
+            ss << "# ----- alternatives generated: " << mapper.stats.nalters << "\n";
+            ss << "# ----- past checkpoints: " << mapper.stats.ncheckpoints << "\n";
+            ss << "# ----- past forks: " << mapper.stats.npastforks << "\n";
+            ss << "# ----- mapmappablegates iterations: " << mapper.stats.nmapmappable << "\n";
+            ss << "# ----- selectalter calls per recursion level:" << ql::utils::to_string(mapper.stats.levels) << "\n";
+            ss << "# ----- time taken by initialplace: " << mapper.stats.initialplacetime << "\n";
+            ss << "# ----- time taken by genalters: " << mapper.stats.genalterstime << "\n";
+            ss << "# ----- time taken by selectalter: " << mapper.stats.selectaltertime << "\n";
+            ss << "# ----- time taken by bundler: " << mapper.stats.bundlertime << "\n";
             ql::report::report_string(ofs, ss.str());
 
             total_swaps += mapper.nswapsadded;
@@ -1026,22 +1036,39 @@ public:
         ql::report::report_statistics(prog_name, kernels, platform, "in", "rcscheduler", "# ");
         ql::report::report_qasm(prog_name, kernels, platform, "in", "rcscheduler");
 
-        for(auto &kernel : kernels)
+        // kernels are scheduled independently, each with its own scheduler and resource manager,
+        // so these run in parallel (option scheduler_threads);
+        // the dot files are written afterwards in kernel order
+        std::vector<std::string>    sched_dots(kernels.size());
+        size_t nthreads = ql::threads_from_option(ql::options::get("scheduler_threads"));
+        if (nthreads > 1 && ql::kernels_share_gates(kernels))
+        {
+            nthreads = 1;
+        }
+        ql::thread_pool pool(nthreads);
+        pool.parallel_for(kernels.size(), [&](size_t k, size_t worker)
         {
+            auto &kernel = kernels[k];
             IOUT("Scheduling kernel: " << kernel.name);
             if (! kernel.c.empty())
             {
                 auto num_creg = kernel.creg_count;
-                std::string     sched_dot;
 
-                kernel.bundles = cc_light_schedule_rc(kernel.c, platform, sched_dot, num_qubits, num_creg);
+                kernel.bundles = cc_light_schedule_rc(kernel.c, platform, sched_dots[k], num_qubits, num_creg);
+            }
+        });
 
-                if (ql::options::get("print_dot_graphs") == "yes")
+        if (ql::options::get("print_dot_graphs") == "yes")
+        {
+            for (size_t k = 0; k < kernels.size(); k++)
+            {
+                auto &kernel = kernels[k];
+                if (! kernel.c.empty())
                 {
                     std::stringstream fname;
                     fname << ql::options::get("output_dir") << "/" << kernel.name << "_" << opt << ".dot";
                     IOUT("writing " << opt << " dependence graph dot file to '" << fname.str() << "' ...");
-                    ql::utils::write_file(fname.str(), sched_dot);
+                    ql::utils::write_file(fname.str(), sched_dots[k]);
                 }
             }
         }
@@ -1086,7 +1113,7 @@ public:
             {
                 // decompose meta-instructions
                 ql::circuit decomposed_ckt;
-                decompose_pre_schedule(kernel.c, decomposed_ckt, platform);
+                decompose_pre_schedule(kernel.c, decomposed_ckt, *kernel.arena, platform);
                 kernel.c = decomposed_ckt;
             }
         }
@@ -1134,7 +1161,7 @@ public:
             IOUT("Decomposing meta-instructions kernel after post-scheduling: " << kernel.name);
             if (! kernel.c.empty())
             {
-                decompose_post_schedule(kernel.bundles, platform);
+                decompose_post_schedule(kernel.bundles, *kernel.arena, platform);
                 // after this, kernel.bundles is valid, kernel.circuit is old/invalid
             }
         }
@@ -1186,7 +1213,7 @@ public:
     /**
      * decompose
      */
-    void decompose_pre_schedule(ql::circuit& ckt, ql::circuit& decomp_ckt, const ql::quantum_platform& platform)
+    void decompose_pre_schedule(ql::circuit& ckt, ql::circuit& decomp_ckt, ql::gate_arena_t& arena, const ql::quantum_platform& platform)
     {
         DOUT("decomposing instructions...");
         for( auto ins : ckt )
@@ -1210,26 +1237,26 @@ public:
                   )
                 {
                     // decomp_ckt.push_back(ins);
-                    decomp_ckt.push_back(new ql::arch::classical_cc(iname, icopers));
+                    decomp_ckt.push_back(arena.create<ql::arch::classical_cc>(iname, icopers));
                     DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
                 }
                 else if( (iname == "eq") || (iname == "ne") || (iname == "lt") ||
                          (iname == "gt") || (iname == "le") || (iname == "ge")
                        )
                 {
-                    decomp_ckt.push_back(new ql::arch::classical_cc("cmp", {icopers[1], icopers[2]}));
+                    decomp_ckt.push_back(arena.create<ql::arch::classical_cc>("cmp", std::vector<size_t>{icopers[1], icopers[2]}));
                     DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
-                    decomp_ckt.push_back(new ql::arch::classical_cc("nop", {}));
+                    decomp_ckt.push_back(arena.create<ql::arch::classical_cc>("nop", std::vector<size_t>{}));
                     DOUT("                                      " << decomp_ckt.back()->qasm());
-                    decomp_ckt.push_back(new ql::arch::classical_cc("fbr_"+iname, {icopers[0]}));
+                    decomp_ckt.push_back(arena.create<ql::arch::classical_cc>("fbr_"+iname, std::vector<size_t>{icopers[0]}));
                     DOUT("                                      " << decomp_ckt.back()->qasm());
                 }
                 else if(iname == "mov")
                 {
                     // r28 is used as temp, TODO use creg properly to create temporary
-                    decomp_ckt.push_back(new ql::arch::classical_cc("ldi", {28}, 0));
+                    decomp_ckt.push_back(arena.create<ql::arch::classical_cc>("ldi", std::vector<size_t>{28}, 0));
                     DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
-                    decomp_ckt.push_back(new ql::arch::classical_cc("add", {icopers[0], icopers[1], 28}));
+                    decomp_ckt.push_back(arena.create<ql::arch::classical_cc>("add", std::vector<size_t>{icopers[0], icopers[1], 28}));
                     DOUT("                                      " << decomp_ckt.back()->qasm());
                 }
                 else if(iname == "ldi")
@@ -1237,7 +1264,7 @@ public:
                     // auto imval = ((classical_cc*)ins)->int_operand;
                     auto imval = ((classical*)ins)->int_operand;
                     DOUT("    classical instruction decomposed: imval=" << imval);
-                    decomp_ckt.push_back(new ql::arch::classical_cc("ldi", {icopers[0]}, imval));
+                    decomp_ckt.push_back(arena.create<ql::arch::classical_cc>("ldi", std::vector<size_t>{icopers[0]}, imval));
                     DOUT("    classical instruction decomposed: " << decomp_ckt.back()->qasm());
                 }
                 else
@@ -1279,7 +1306,7 @@ public:
                             if(!coperands.empty())
                             {
                                 auto cop = coperands[0];
-                                decomp_ckt.push_back(new ql::arch::classical_cc("fmr", {cop, qop}));
+                                decomp_ckt.push_back(arena.create<ql::arch::classical_cc>("fmr", std::vector<size_t>{cop, qop}));
                             }
                             else
                             {
@@ -1908,20 +1935,21 @@ private:
             }
             else
             {
-                for ( ql::ir::bundle_t & abundle : kernel.bundles)
+                auto & bundles = kernel.bundles;
+                for (size_t b = 0; b < bundles.size(); b++)
                 {
                     DOUT("... adding gates, a new bundle");
-                    auto bcycle = abundle.start_cycle;
+                    auto bcycle = bundles.start_cycle[b];
 
                     std::stringstream ssbundles;
-                    for( auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt )
+                    for (size_t s = bundles.sections_begin(b); s < bundles.sections_end(b); s++)
                     {
                         DOUT("... adding gates, a new section in a bundle");
-                        for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
+                        for (size_t i = bundles.gates_begin(s); i < bundles.gates_end(s); i++)
                         {
-                            auto & iname = (*insIt)->name;
-                            auto & operands = (*insIt)->operands;
-                            auto duration = (*insIt)->duration;     // duration in nano-seconds
+                            auto & iname = bundles.gates[i]->name;
+                            auto & operands = bundles.gates[i]->operands;
+                            auto duration = bundles.gates[i]->duration;     // duration in nano-seconds
                             // size_t operation_duration = std::ceil( static_cast<float>(duration) / ns_per_cycle);
                             if( iname == "measure")
                             {
@@ -13,6 +13,8 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <memory>
+#include <limits>
 #include <json.h>
 #include <resource_manager.h>
 
@@ -23,6 +25,99 @@ namespace ql
 namespace arch
 {
 
+// The constant configuration tables of the resources below are dense arrays, built at construction,
+// so that their lookups in available, reserve and next_available are just a few loads.
+
+// table from qubit to the unit (e.g. qwg) that it is connected to; 0 for qubits not in the table
+class qubit2unit_t
+{
+    std::vector<size_t> units;
+public:
+    void set(size_t q, size_t unit)
+    {
+        if (q >= units.size())
+        {
+            units.resize(q+1, 0);
+        }
+        units[q] = unit;
+    }
+    size_t get(size_t q) const
+    {
+        return (q < units.size() ? units[q] : 0);
+    }
+};
+
+// matrix from an ordered pair of qubits to the id of the edge between them; no_edge when there is none;
+// it is sized once by init, before the edges are set
+class edge_matrix_t
+{
+    size_t              nq = 0;     // number of rows and of columns
+    std::vector<size_t> ids;        // ids[q0*nq+q1] is id of edge q0->q1
+public:
+    static const size_t no_edge = std::numeric_limits<size_t>::max();
+
+    // size for the qubits of the platform and those named by the edges of its topology
+    void init(const ql::quantum_platform & platform)
+    {
+        size_t n = platform.qubit_number;
+        for (auto & anedge : platform.topology["edges"])
+        {
+            size_t s = anedge["src"];
+            size_t d = anedge["dst"];
+            n = std::max(n, std::max(s, d) + 1);
+        }
+        nq = n;
+        ids.assign(n*n, size_t(no_edge));
+    }
+    void set(size_t q0, size_t q1, size_t e)
+    {
+        ids[q0*nq+q1] = e;
+    }
+    size_t get(size_t q0, size_t q1) const
+    {
+        return (q0 < nq && q1 < nq ? ids[q0*nq+q1] : no_edge);
+    }
+};
+
+// lists of numbers per index, in compressed sparse row form: list i is values[start[i]] up to values[start[i+1]];
+// built once from a map from index to list; the lists of indices not in that map are empty
+class csr_lists_t
+{
+    std::vector<size_t> start;
+    std::vector<size_t> values;
+public:
+    typedef struct {
+        const size_t* first;
+        const size_t* last;
+        const size_t* begin() const { return first; }
+        const size_t* end() const { return last; }
+    } range_t;
+
+    void build(const std::map<size_t, std::vector<size_t>>& lists)
+    {
+        size_t n = (lists.empty() ? 0 : lists.rbegin()->first + 1);
+        start.assign(n+1, 0);
+        values.clear();
+        for (size_t i = 0; i < n; i++)
+        {
+            auto it = lists.find(i);
+            if (it != lists.end())
+            {
+                values.insert(values.end(), it->second.begin(), it->second.end());
+            }
+            start[i+1] = values.size();
+        }
+    }
+    range_t get(size_t i) const
+    {
+        if (i+1 >= start.size())
+        {
+            return range_t{ NULL, NULL };
+        }
+        return range_t{ values.data()+start[i], values.data()+start[i+1] };
+    }
+};
+
 class qubit_resource_t : public resource_t
 {
 public:
@@ -44,8 +139,8 @@ public:
         }
     }
 
-    bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    bool available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         for( auto q : ins->operands )
         {
@@ -72,15 +167,41 @@ public:
         return true;
     }
 
-    void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    void reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         for( auto q : ins->operands )
         {
-            state[q] = (forward_scheduling == direction ?  op_start_cycle + operation_duration : op_start_cycle );
+            assign(state[q], (forward_scheduling == direction ?  op_start_cycle + operation_duration : op_start_cycle ));
             DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qubit: " << q << " reserved till/from cycle: " << state[q]);
         }
     }
+
+    size_t next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        size_t cycle = op_start_cycle;
+        for( auto q : ins->operands )
+        {
+            if (forward_scheduling == direction)
+            {
+                cycle = std::max(cycle, state[q]);
+            }
+            else
+            {
+                cycle = std::min(cycle, until_cycle(state[q], operation_duration));
+            }
+        }
+        return cycle;
+    }
+    // each operand qubit exclusively
+    void claim(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc)
+    {
+        for( auto q : ins->operands )
+        {
+            claims.push_back(claim_t{q, exclusive});
+        }
+    }
     ~qubit_resource_t() {}
 };
 
@@ -99,8 +220,19 @@ public:
     // but a new y must wait until the last x has finished;
     // the bug was that a new x was always ok (so also when starting earlier than cycle i)
 
-    std::vector<std::string> operations;    // with operation_name==operations[qwg]
-    std::map<size_t,size_t> qubit2qwg;      // on qwg==qubit2qwg[q]
+    std::vector<size_t> operations;         // with operation_name_id==operations[qwg]
+
+    // constant configuration, shared by the copies of this resource
+    typedef struct {
+        qubit2unit_t qubit2qwg;             // on qwg==qwg_of(q)
+    } config_t;
+    std::shared_ptr<const config_t> config;
+
+    // the qwg of qubit q, 0 when q is not in the connection map
+    size_t qwg_of(size_t q) const
+    {
+        return config->qubit2qwg.get(q);
+    }
 
     qwg_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : 
         resource_t("qwgs", dir)
@@ -115,8 +247,9 @@ public:
         {
             fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
             tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-            operations[i] = "";
+            operations[i] = 0;
         }
+        std::shared_ptr<config_t> c = std::make_shared<config_t>();
         auto & constraints = platform.resources[name]["connection_map"];
         for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
         {
@@ -124,23 +257,24 @@ public:
             size_t qwgNo = stoi( it.key() );
             auto & connected_qubits = it.value();
             for(auto & q : connected_qubits)
-                qubit2qwg[q] = qwgNo;
+                c->qubit2qwg.set(q, qwgNo);
         }
+        config = c;
     }
 
-    bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    bool available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
-        bool is_mw = (operation_type == "mw");
+        bool is_mw = (desc.optype == ql::optype_mw);
         if( is_mw )
         {
             for( auto q : ins->operands )
             {
-                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qubit2qwg[q] << " is busy from cycle: " << fromcycle[ qubit2qwg[q] ] << " to cycle: " << tocycle[qubit2qwg[q]] << " for operation: " << operations[ qubit2qwg[q] ]);
+                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qwg_of(q) << " is busy from cycle: " << fromcycle[ qwg_of(q) ] << " to cycle: " << tocycle[qwg_of(q)] << " for operation: " << operations[ qwg_of(q) ]);
                 if (forward_scheduling == direction)
                 {
-                    if ( op_start_cycle < fromcycle[ qubit2qwg[q] ]
-                    || ( op_start_cycle < tocycle[qubit2qwg[q]] && operations[ qubit2qwg[q] ] != operation_name ) )
+                    if ( op_start_cycle < fromcycle[ qwg_of(q) ]
+                    || ( op_start_cycle < tocycle[qwg_of(q)] && operations[ qwg_of(q) ] != desc.operation_name_id ) )
                     {
                         DOUT("    " << name << " resource busy ...");
                         return false;
@@ -148,8 +282,8 @@ public:
                 }
                 else
                 {
-                    if ( op_start_cycle + operation_duration > tocycle[ qubit2qwg[q] ]
-                    || ( op_start_cycle + operation_duration > fromcycle[qubit2qwg[q]] && operations[ qubit2qwg[q] ] != operation_name ) )
+                    if ( op_start_cycle + operation_duration > tocycle[ qwg_of(q) ]
+                    || ( op_start_cycle + operation_duration > fromcycle[qwg_of(q)] && operations[ qwg_of(q) ] != desc.operation_name_id ) )
                     {
                         DOUT("    " << name << " resource busy ...");
                         return false;
@@ -161,41 +295,77 @@ public:
         return true;
     }
 
-    void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    void reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
-        bool is_mw = (operation_type == "mw");
+        bool is_mw = (desc.optype == ql::optype_mw);
         if( is_mw )
         {
             for( auto q : ins->operands )
             {
                 if (forward_scheduling == direction)
                 {
-                    if (operations[ qubit2qwg[q] ] == operation_name)
+                    if (operations[ qwg_of(q) ] == desc.operation_name_id)
                     {
-                        tocycle[ qubit2qwg[q] ]  = std::max( tocycle[qubit2qwg[q]], op_start_cycle + operation_duration);
+                        assign(tocycle[ qwg_of(q) ], std::max( tocycle[qwg_of(q)], op_start_cycle + operation_duration));
                     }
                     else
                     {
-                        fromcycle[ qubit2qwg[q] ]  = op_start_cycle;
-                        tocycle[ qubit2qwg[q] ]  = op_start_cycle + operation_duration;
-                        operations[ qubit2qwg[q] ] = operation_name;
+                        assign(fromcycle[ qwg_of(q) ], op_start_cycle);
+                        assign(tocycle[ qwg_of(q) ], op_start_cycle + operation_duration);
+                        assign(operations[ qwg_of(q) ], desc.operation_name_id);
                     }
                 }
                 else
                 {
-                    if (operations[ qubit2qwg[q] ] == operation_name)
+                    if (operations[ qwg_of(q) ] == desc.operation_name_id)
                     {
-                        fromcycle[ qubit2qwg[q] ]  = std::min( fromcycle[qubit2qwg[q]], op_start_cycle);
+                        assign(fromcycle[ qwg_of(q) ], std::min( fromcycle[qwg_of(q)], op_start_cycle));
                     }
                     else
                     {
-                        fromcycle[ qubit2qwg[q] ]  = op_start_cycle;
-                        tocycle[ qubit2qwg[q] ]  = op_start_cycle + operation_duration;
-                        operations[ qubit2qwg[q] ] = operation_name;
+                        assign(fromcycle[ qwg_of(q) ], op_start_cycle);
+                        assign(tocycle[ qwg_of(q) ], op_start_cycle + operation_duration);
+                        assign(operations[ qwg_of(q) ], desc.operation_name_id);
                     }
                 }
-                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qubit2qwg[q] << " reserved from cycle: " << fromcycle[ qubit2qwg[q] ] << " to cycle: " << tocycle[qubit2qwg[q]] << " for operation: " << operations[ qubit2qwg[q] ]);
+                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qwg_of(q) << " reserved from cycle: " << fromcycle[ qwg_of(q) ] << " to cycle: " << tocycle[qwg_of(q)] << " for operation: " << operations[ qwg_of(q) ]);
+            }
+        }
+    }
+
+    // the same operation can start from fromcycle on, another one must wait until tocycle (fwd);
+    // the same operation must complete by tocycle, another one by fromcycle (bwd)
+    size_t next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        size_t cycle = op_start_cycle;
+        if( desc.optype == ql::optype_mw )
+        {
+            for( auto q : ins->operands )
+            {
+                size_t qwg = qwg_of(q);
+                bool same = (operations[qwg] == desc.operation_name_id);
+                if (forward_scheduling == direction)
+                {
+                    cycle = std::max(cycle, same ? fromcycle[qwg] : tocycle[qwg]);
+                }
+                else
+                {
+                    cycle = std::min(cycle, until_cycle(same ? tocycle[qwg] : fromcycle[qwg], operation_duration));
+                }
+            }
+        }
+        return cycle;
+    }
+    // the qwgs of the operands of a mw operation, shared with the same operation
+    void claim(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc)
+    {
+        if( desc.optype == ql::optype_mw )
+        {
+            for( auto q : ins->operands )
+            {
+                claims.push_back(claim_t{qwg_of(q), desc.operation_name_id});
             }
         }
     }
@@ -210,7 +380,18 @@ public:
 
     std::vector<size_t> fromcycle;  // last measurement start cycle
     std::vector<size_t> tocycle;    // is busy till cycle
-    std::map<size_t,size_t> qubit2meas;
+
+    // constant configuration, shared by the copies of this resource
+    typedef struct {
+        qubit2unit_t qubit2meas;            // on measurement unit meas_of(q)
+    } config_t;
+    std::shared_ptr<const config_t> config;
+
+    // the measurement unit of qubit q, 0 when q is not in the connection map
+    size_t meas_of(size_t q) const
+    {
+        return config->qubit2meas.get(q);
+    }
 
     meas_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : 
         resource_t("meas_units", dir)
@@ -225,6 +406,7 @@ public:
             fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
             tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
         }
+        std::shared_ptr<config_t> c = std::make_shared<config_t>();
         auto & constraints = platform.resources[name]["connection_map"];
         for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
         {
@@ -232,26 +414,27 @@ public:
             size_t measUnitNo = stoi( it.key() );
             auto & connected_qubits = it.value();
             for(auto & q : connected_qubits)
-                qubit2meas[q] = measUnitNo;
+                c->qubit2meas.set(q, measUnitNo);
         }
+        config = c;
     }
 
-    bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    bool available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
-        bool is_measure = (operation_type == "readout");
+        bool is_measure = (desc.optype == ql::optype_readout);
         if( is_measure )
         {
             for(auto q : ins->operands)
             {
-                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << qubit2meas[q] << " is busy from cycle: " << fromcycle[ qubit2meas[q] ] << " to cycle: " << tocycle[qubit2meas[q]] );
+                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << meas_of(q) << " is busy from cycle: " << fromcycle[ meas_of(q) ] << " to cycle: " << tocycle[meas_of(q)] );
                 if (forward_scheduling == direction)
                 {
-	                if( op_start_cycle != fromcycle[ qubit2meas[q] ] )
+	                if( op_start_cycle != fromcycle[ meas_of(q) ] )
 	                {
 	                    // If current measurement on same measurement-unit does not start in the
 	                    // same cycle, then it should wait for current measurement to finish
-	                    if( op_start_cycle < tocycle[ qubit2meas[q] ] )
+	                    if( op_start_cycle < tocycle[ meas_of(q) ] )
 	                    {
 	                        DOUT("    " << name << " resource busy ...");
 	                        return false;
@@ -260,11 +443,11 @@ public:
                 }
                 else
                 {
-	                if( op_start_cycle != fromcycle[ qubit2meas[q] ] )
+	                if( op_start_cycle != fromcycle[ meas_of(q) ] )
 	                {
 	                    // If current measurement on same measurement-unit does not start in the
 	                    // same cycle, then it should wait until it would finish at start of or earlier than current measurement
-	                    if( op_start_cycle + operation_duration > fromcycle[ qubit2meas[q] ] )
+	                    if( op_start_cycle + operation_duration > fromcycle[ meas_of(q) ] )
 	                    {
 	                        DOUT("    " << name << " resource busy ...");
 	                        return false;
@@ -277,17 +460,60 @@ public:
         return true;
     }
 
-    void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    void reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
-        bool is_measure = (operation_type == "readout");
+        bool is_measure = (desc.optype == ql::optype_readout);
         if( is_measure )
         {
             for(auto q : ins->operands)
             {
-                fromcycle[ qubit2meas[q] ] = op_start_cycle;
-                tocycle[ qubit2meas[q] ] = op_start_cycle + operation_duration;
-                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << qubit2meas[q] << " reserved from cycle: " << fromcycle[ qubit2meas[q] ] << " to cycle: " << tocycle[qubit2meas[q]] );
+                assign(fromcycle[ meas_of(q) ], op_start_cycle);
+                assign(tocycle[ meas_of(q) ], op_start_cycle + operation_duration);
+                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << meas_of(q) << " reserved from cycle: " << fromcycle[ meas_of(q) ] << " to cycle: " << tocycle[meas_of(q)] );
+            }
+        }
+    }
+
+    // a measurement can start in the same cycle as the current one,
+    // or after it has finished (fwd) or finish before it starts (bwd)
+    size_t next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        size_t cycle = op_start_cycle;
+        if( desc.optype == ql::optype_readout )
+        {
+            for(auto q : ins->operands)
+            {
+                size_t from = fromcycle[ meas_of(q) ];
+                size_t to = tocycle[ meas_of(q) ];
+                size_t qcycle;
+                if (forward_scheduling == direction)
+                {
+                    if (op_start_cycle == from || op_start_cycle >= to) qcycle = op_start_cycle;
+                    else if (op_start_cycle < from) qcycle = from;
+                    else qcycle = to;
+                    cycle = std::max(cycle, qcycle);
+                }
+                else
+                {
+                    if (op_start_cycle == from || op_start_cycle + operation_duration <= from) qcycle = op_start_cycle;
+                    else if (op_start_cycle > from) qcycle = from;
+                    else qcycle = until_cycle(from, operation_duration);
+                    cycle = std::min(cycle, qcycle);
+                }
+            }
+        }
+        return cycle;
+    }
+    // the measurement units of the operands of a measurement, shared with measurements starting in the same cycle
+    void claim(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc)
+    {
+        if( desc.optype == ql::optype_readout )
+        {
+            for( auto q : ins->operands )
+            {
+                claims.push_back(claim_t{meas_of(q), op_start_cycle});
             }
         }
     }
@@ -303,9 +529,41 @@ public:
     // fwd: edge is busy till cycle=state[edge], i.e. all cycles < state[edge] it is busy, i.e. start_cycle must be >= state[edge]
     // bwd: edge is busy from cycle=state[edge], i.e. all cycles >= state[edge] it is busy, i.e. start_cycle+duration must be <= state[edge]
     std::vector<size_t> state;                          // machine state recording the cycles that given edge is free/busy
-    typedef std::pair<size_t,size_t> qubits_pair_t;
-    std::map< qubits_pair_t, size_t > qubits2edge;      // constant helper table to find edge between a pair of qubits
-    std::map<size_t, std::vector<size_t> > edge2edges;  // constant "edges" table from configuration file
+
+    // constant configuration, shared by the copies of this resource
+    typedef struct {
+        edge_matrix_t   qubits2edge;        // helper table to find edge between a pair of qubits
+        csr_lists_t     edge2edges;         // "edges" table from configuration file
+    } config_t;
+    std::shared_ptr<const config_t> config;
+
+    // the edges that edge_no excludes, empty when there are none
+    csr_lists_t::range_t edges_of(size_t edge_no) const
+    {
+        return config->edge2edges.get(edge_no);
+    }
+
+    // is edge_no or any of the edges it excludes busy at op_start_cycle?
+    bool busy(size_t op_start_cycle, size_t edge_no, size_t operation_duration) const
+    {
+        if (forward_scheduling == direction)
+        {
+            if (op_start_cycle < state[edge_no]) return true;
+            for (auto e : edges_of(edge_no))
+            {
+                if (op_start_cycle < state[e]) return true;
+            }
+        }
+        else
+        {
+            if (op_start_cycle + operation_duration > state[edge_no]) return true;
+            for (auto e : edges_of(edge_no))
+            {
+                if (op_start_cycle + operation_duration > state[e]) return true;
+            }
+        }
+        return false;
+    }
 
     edge_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : resource_t("edges", dir)
     {
@@ -318,25 +576,26 @@ public:
             state[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
         }
 
+        std::shared_ptr<config_t> c = std::make_shared<config_t>();
+        c->qubits2edge.init(platform);
         for( auto & anedge : platform.topology["edges"] )
         {
             size_t s = anedge["src"];
             size_t d = anedge["dst"];
             size_t e = anedge["id"];
 
-            qubits_pair_t aqpair(s,d);
-            auto it = qubits2edge.find(aqpair);
-            if( it != qubits2edge.end() )
+            if( c->qubits2edge.get(s,d) != edge_matrix_t::no_edge )
             {
                 EOUT("re-defining edge " << s <<"->" << d << " !");
                 throw ql::exception("[x] Error : re-defining edge !",false);
             }
             else
             {
-                qubits2edge[aqpair] = e;
+                c->qubits2edge.set(s, d, e);
             }
         }
 
+        std::map<size_t, std::vector<size_t> > edge2edges;
         auto & constraints = platform.resources[name]["connection_map"];
         for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
         {
@@ -346,13 +605,15 @@ public:
             for(auto & e : connected_edges)
                 edge2edges[e].push_back(edgeNo);
         }
+        c->edge2edges.build(edge2edges);
+        config = c;
     }
 
-    bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    bool available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         auto gname = ins->name;
-        bool is_flux = (operation_type == "flux");
+        bool is_flux = (desc.optype == ql::optype_flux);
         if( is_flux )
         {
             auto nopers = ins->operands.size();
@@ -365,36 +626,17 @@ public:
             {
                 auto q0 = ins->operands[0];
                 auto q1 = ins->operands[1];
-                qubits_pair_t aqpair(q0, q1);
-                auto it = qubits2edge.find(aqpair);
-                if( it != qubits2edge.end() )
+                auto edge_no = config->qubits2edge.get(q0, q1);
+                if( edge_no != edge_matrix_t::no_edge )
                 {
-                    auto edge_no = qubits2edge[aqpair];
-
                     DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle 
                         << ", edge: " << edge_no << " is busy till/from cycle : " << state[edge_no] 
                         << " for operation: " << ins->name);
 
-                    std::vector<size_t> edges2check(edge2edges[edge_no]);
-                    edges2check.push_back(edge_no);
-                    for(auto & e : edges2check)
+                    if( busy(op_start_cycle, edge_no, operation_duration) )
                     {
-                        if (forward_scheduling == direction)
-                        {
-                            if( op_start_cycle < state[e] )
-                            {
-                                DOUT("    " << name << " resource busy ...");
-                                return false;
-                            }
-                        }
-                        else
-                        {
-                            if( op_start_cycle + operation_duration > state[e] )
-                            {
-                                DOUT("    " << name << " resource busy ...");
-                                return false;
-                            }
-                        }
+                        DOUT("    " << name << " resource busy ...");
+                        return false;
                     }
                     DOUT("    " << name << " resource available ...");
                 }
@@ -411,11 +653,11 @@ public:
         return true;
     }
 
-    void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    void reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         auto gname = ins->name;
-        bool is_flux = (operation_type == "flux");
+        bool is_flux = (desc.optype == ql::optype_flux);
         if( is_flux )
         {
             auto nopers = ins->operands.size();
@@ -427,22 +669,25 @@ public:
             {
                 auto q0 = ins->operands[0];
                 auto q1 = ins->operands[1];
-                qubits_pair_t aqpair(q0, q1);
-                auto edge_no = qubits2edge[aqpair];
+                auto edge_no = config->qubits2edge.get(q0, q1);
+                if (edge_no == edge_matrix_t::no_edge)
+                {
+                    edge_no = 0;
+                }
                 if (forward_scheduling == direction)
                 {
-                    state[edge_no] = op_start_cycle + operation_duration;
-                    for(auto & e : edge2edges[edge_no])
+                    assign(state[edge_no], op_start_cycle + operation_duration);
+                    for(auto & e : edges_of(edge_no))
                     {
-                        state[e] = op_start_cycle + operation_duration;
+                        assign(state[e], op_start_cycle + operation_duration);
                     }
                 }
                 else
                 {
-                    state[edge_no] = op_start_cycle;
-                    for(auto & e : edge2edges[edge_no])
+                    assign(state[edge_no], op_start_cycle);
+                    for(auto & e : edges_of(edge_no))
                     {
-                        state[e] = op_start_cycle;
+                        assign(state[e], op_start_cycle);
                     }
                 }
                 DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle 
@@ -455,6 +700,64 @@ public:
             }
         }
     }
+
+    // illegal edges and operand counts are left to available to report
+    size_t next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        size_t cycle = op_start_cycle;
+        if( desc.optype == ql::optype_flux && ins->operands.size() == 2 )
+        {
+            auto edge_no = config->qubits2edge.get(ins->operands[0], ins->operands[1]);
+            if( edge_no != edge_matrix_t::no_edge )
+            {
+                if (forward_scheduling == direction)
+                {
+                    cycle = std::max(cycle, state[edge_no]);
+                    for(auto e : edges_of(edge_no))
+                    {
+                        cycle = std::max(cycle, state[e]);
+                    }
+                }
+                else
+                {
+                    cycle = std::min(cycle, until_cycle(state[edge_no], operation_duration));
+                    for(auto e : edges_of(edge_no))
+                    {
+                        cycle = std::min(cycle, until_cycle(state[e], operation_duration));
+                    }
+                }
+            }
+        }
+        return cycle;
+    }
+    // the edge of a two-qubit flux operation and the edges it excludes, exclusively
+    void claim(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc)
+    {
+        if( desc.optype == ql::optype_flux )
+        {
+            auto nopers = ins->operands.size();
+            if (nopers == 2)
+            {
+                auto q0 = ins->operands[0];
+                auto q1 = ins->operands[1];
+                auto edge_no = config->qubits2edge.get(q0, q1);
+                if( edge_no == edge_matrix_t::no_edge )
+                {
+                    FATAL("Use of illegal edge: " << q0 << "->" << q1 << " in operation: " << ins->name << " !");
+                }
+                claims.push_back(claim_t{edge_no, exclusive});
+                for(auto e : edges_of(edge_no))
+                {
+                    claims.push_back(claim_t{e, exclusive});
+                }
+            }
+            else if (nopers != 1)
+            {
+                FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
+            }
+        }
+    }
     ~edge_resource_t() {}
 };
 
@@ -475,7 +778,7 @@ public:
 // The resource state machine maintains:
 // - fromcycle[q]: qubit q is busy from cycle fromcycle[q]
 // - tocycle[q]: to cycle tocycle[q] with an operation of the current operation type ...
-// - operations[q]: a "flux" or a "mw" (note: "" is initial value different from these two)
+// - operations[q]: a "flux" or a "mw" (note: optype_none is initial value different from these two)
 // The fromcycle and tocycle are needed since a qubit can be busy with multiple "flux"s (i.e. being the detuned qubit for several "flux"s),
 // so the second, third, etc. of these "flux"s can be scheduled in parallel to the first but not earlier than fromcycle[q],
 // since till that cycle is was likely to be busy with "mw", which doesn't allow a "flux" in parallel. Similar for backward scheduling.
@@ -488,11 +791,27 @@ public:
 
     std::vector<size_t> fromcycle;                              // qubit q is busy from cycle fromcycle[q]
     std::vector<size_t> tocycle;                                // till cycle tocycle[q]
-    std::vector<std::string> operations;                        // with an operation of operation_type==operations[q]
+    std::vector<size_t> operations;                             // with an operation of optype==operations[q]
 
-    typedef std::pair<size_t,size_t> qubits_pair_t;
-    std::map< qubits_pair_t, size_t > qubitpair2edge;           // map: pair of qubits to edge (from grid configuration)
-    std::map<size_t, std::vector<size_t> > edge_detunes_qubits; // map: edge to vector of qubits that edge detunes (resource desc.)
+    // constant configuration, shared by the copies of this resource
+    typedef struct {
+        edge_matrix_t   qubitpair2edge;         // map: pair of qubits to edge (from grid configuration)
+        csr_lists_t     edge_detunes_qubits;    // map: edge to qubits that edge detunes (resource desc.)
+    } config_t;
+    std::shared_ptr<const config_t> config;
+
+    // the edge between qubits q0 and q1, 0 when there is none
+    size_t edge_of(size_t q0, size_t q1) const
+    {
+        size_t edge_no = config->qubitpair2edge.get(q0, q1);
+        return (edge_no == edge_matrix_t::no_edge ? 0 : edge_no);
+    }
+
+    // the qubits that edge_no detunes, empty when there are none
+    csr_lists_t::range_t detunes_of(size_t edge_no) const
+    {
+        return config->edge_detunes_qubits.get(edge_no);
+    }
 
     detuned_qubits_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : 
         resource_t("detuned_qubits", dir)
@@ -508,30 +827,31 @@ public:
         {
             fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
             tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-            operations[i] = "";
+            operations[i] = ql::optype_none;
         }
 
         // initialize qubitpair2edge map from json description; this is a constant map
+        std::shared_ptr<config_t> c = std::make_shared<config_t>();
+        c->qubitpair2edge.init(platform);
         for(auto & anedge : platform.topology["edges"])
         {
             size_t s = anedge["src"];
             size_t d = anedge["dst"];
             size_t e = anedge["id"];
 
-            qubits_pair_t aqpair(s,d);
-            auto it = qubitpair2edge.find(aqpair);
-            if( it != qubitpair2edge.end() )
+            if( c->qubitpair2edge.get(s,d) != edge_matrix_t::no_edge )
             {
                 EOUT("re-defining edge " << s <<"->" << d << " !");
                 throw ql::exception("[x] Error : re-defining edge !",false);
             }
             else
             {
-                qubitpair2edge[aqpair] = e;
+                c->qubitpair2edge.set(s, d, e);
             }
         }
 
         // initialize edge_detunes_qubits map from json description; this is a constant map
+        std::map<size_t, std::vector<size_t> > edge_detunes_qubits;
         auto & constraints = platform.resources[name]["connection_map"];
         for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
         {
@@ -541,15 +861,17 @@ public:
             for(auto & q : detuned_qubits)
                 edge_detunes_qubits[edgeNo].push_back(q);
         }
+        c->edge_detunes_qubits.build(edge_detunes_qubits);
+        config = c;
     }
 
     // When a two-qubit flux gate, check whether the qubits it would detune are not busy with a rotation.
     // When a one-qubit rotation, check whether the qubit is not detuned (busy with a flux gate).
-    bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    bool available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         auto gname = ins->name;
-        bool is_flux = (operation_type == "flux");
+        bool is_flux = (desc.optype == ql::optype_flux);
         if( is_flux )
         {
             auto nopers = ins->operands.size();
@@ -562,19 +884,16 @@ public:
             {
 	    	    auto q0 = ins->operands[0];
             	auto q1 = ins->operands[1];
-            	qubits_pair_t aqpair(q0, q1);
-            	auto it = qubitpair2edge.find(aqpair);
-            	if( it != qubitpair2edge.end() )
+            	auto edge_no = config->qubitpair2edge.get(q0, q1);
+            	if( edge_no != edge_matrix_t::no_edge )
             	{
-                    auto edge_no = qubitpair2edge[aqpair];
-
-                    for( auto & q : edge_detunes_qubits[edge_no])
+                    for( auto & q : detunes_of(edge_no))
                     {
-                        DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
+                        DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << desc.operation_type);
                         if (forward_scheduling == direction)
                         {
                             if ( op_start_cycle < fromcycle[q]
-                            || ( op_start_cycle < tocycle[q] && operations[q] != operation_type ) )
+                            || ( op_start_cycle < tocycle[q] && operations[q] != size_t(desc.optype) ) )
                             {
                                 DOUT("    " << name << " resource busy for a two-qubit gate...");
                                 return false;
@@ -583,7 +902,7 @@ public:
                         else
                         {
                             if ( op_start_cycle + operation_duration > tocycle[q]
-                            || ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type ) )
+                            || ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != size_t(desc.optype) ) )
                             {
                                 DOUT("    " << name << " resource busy for a two-qubit gate...");
                                 return false;
@@ -603,12 +922,12 @@ public:
             }
         }
 
-        bool is_mw = (operation_type == "mw");
+        bool is_mw = (desc.optype == ql::optype_mw);
         if ( is_mw )
         {
             for( auto q : ins->operands )
             {
-                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
+                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << desc.operation_type);
                 if (forward_scheduling == direction)
                 {
                     if ( op_start_cycle < fromcycle[q])
@@ -616,7 +935,7 @@ public:
                         DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " < fromcycle[" << q << "] " << fromcycle[q] );
                         return false;
                     }
-                    if ( op_start_cycle < tocycle[q] && operations[q] != operation_type )
+                    if ( op_start_cycle < tocycle[q] && operations[q] != size_t(desc.optype) )
                     {
                         DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " < tocycle[" << q << "] " << tocycle[q] );
                         return false;
@@ -629,7 +948,7 @@ public:
                         DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " + duration > tocycle[" << q << "] " << tocycle[q] );
                         return false;
                     }
-                    if ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type )
+                    if ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != size_t(desc.optype) )
                     {
                         DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " + duration > fromcycle[" << q << "] " << fromcycle[q] );
                         return false;
@@ -643,11 +962,11 @@ public:
 
     // A two-qubit flux gate must set the qubits it would detune to detuned, busy with a flux gate.
     // A one-qubit rotation gate must set its operand qubit to busy, busy with a rotation.
-    void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    void reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         auto gname = ins->name;
-        bool is_flux = (operation_type == "flux");
+        bool is_flux = (desc.optype == ql::optype_flux);
         if( is_flux )
         {
             auto nopers = ins->operands.size();
@@ -659,38 +978,37 @@ public:
             {
                 auto q0 = ins->operands[0];
                 auto q1 = ins->operands[1];
-                qubits_pair_t aqpair(q0, q1);
-                auto edge_no = qubitpair2edge[aqpair];
+                auto edge_no = edge_of(q0, q1);
 
-                for(auto & q : edge_detunes_qubits[edge_no])
+                for(auto & q : detunes_of(edge_no))
                 {
                     if (forward_scheduling == direction)
                     {
-                        if (operations[q] == operation_type)
+                        if (operations[q] == size_t(desc.optype))
                         {
-                            tocycle[q] = std::max( tocycle[q], op_start_cycle + operation_duration);
+                            assign(tocycle[q], std::max( tocycle[q], op_start_cycle + operation_duration));
                             DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                         }
                         else
                         {
-                            fromcycle[q] = op_start_cycle;
-                            tocycle[q] = op_start_cycle + operation_duration;
-                            operations[q] = operation_type;
+                            assign(fromcycle[q], op_start_cycle);
+                            assign(tocycle[q], op_start_cycle + operation_duration);
+                            assign(operations[q], size_t(desc.optype));
                             DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                         }
                     }
                     else
                     {
-                        if (operations[q] == operation_type)
+                        if (operations[q] == size_t(desc.optype))
                         {
-                            fromcycle[q] = std::min( fromcycle[q], op_start_cycle);
+                            assign(fromcycle[q], std::min( fromcycle[q], op_start_cycle));
                             DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                         }
                         else
                         {
-                            fromcycle[q] = op_start_cycle;
-                            tocycle[q] = op_start_cycle + operation_duration;
-                            operations[q] = operation_type;
+                            assign(fromcycle[q], op_start_cycle);
+                            assign(tocycle[q], op_start_cycle + operation_duration);
+                            assign(operations[q], size_t(desc.optype));
                             DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                         }
                     }
@@ -702,38 +1020,38 @@ public:
                 FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
             }
         }
-        bool is_mw = (operation_type == "mw");
+        bool is_mw = (desc.optype == ql::optype_mw);
         if ( is_mw )
         {
             for( auto q : ins->operands )
             {
                 if (forward_scheduling == direction)
                 {
-                    if (operations[q] == operation_type)
+                    if (operations[q] == size_t(desc.optype))
                     {
-                        tocycle[q] = std::max( tocycle[q], op_start_cycle + operation_duration);
+                        assign(tocycle[q], std::max( tocycle[q], op_start_cycle + operation_duration));
                         DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                     }
                     else
                     {
-                        fromcycle[q] = op_start_cycle;
-                        tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
+                        assign(fromcycle[q], op_start_cycle);
+                        assign(tocycle[q], op_start_cycle + operation_duration);
+                        assign(operations[q], size_t(desc.optype));
                         DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                     }
                 }
                 else
                 {
-                    if (operations[q] == operation_type)
+                    if (operations[q] == size_t(desc.optype))
                     {
-                        fromcycle[q] = std::min( fromcycle[q], op_start_cycle);
+                        assign(fromcycle[q], std::min( fromcycle[q], op_start_cycle));
                         DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
                     }
                     else
                     {
-                        fromcycle[q] = op_start_cycle;
-                        tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
+                        assign(fromcycle[q], op_start_cycle);
+                        assign(tocycle[q], op_start_cycle + operation_duration);
+                        assign(operations[q], size_t(desc.optype));
                         DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
                     }
                 }
@@ -741,6 +1059,75 @@ public:
             }
         }
     }
+
+    // as for qwgs, but with the operation_type of the qubits that a flux gate detunes or a rotation uses
+    size_t next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        csr_lists_t::range_t qubits = { NULL, NULL };
+        if( desc.optype == ql::optype_flux && ins->operands.size() == 2 )
+        {
+            auto edge_no = config->qubitpair2edge.get(ins->operands[0], ins->operands[1]);
+            if( edge_no != edge_matrix_t::no_edge )
+            {
+                qubits = detunes_of(edge_no);
+            }
+        }
+        else if( desc.optype == ql::optype_mw )
+        {
+            qubits = { ins->operands.data(), ins->operands.data() + ins->operands.size() };
+        }
+
+        size_t cycle = op_start_cycle;
+        for( auto q : qubits )
+        {
+            bool same = (operations[q] == size_t(desc.optype));
+            if (forward_scheduling == direction)
+            {
+                cycle = std::max(cycle, same ? fromcycle[q] : tocycle[q]);
+            }
+            else
+            {
+                cycle = std::min(cycle, until_cycle(same ? tocycle[q] : fromcycle[q], operation_duration));
+            }
+        }
+        return cycle;
+    }
+    // the qubits that a two-qubit flux operation detunes and the operand qubits of a mw operation,
+    // shared with operations of the same operation type
+    void claim(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc)
+    {
+        if( desc.optype == ql::optype_flux )
+        {
+            auto nopers = ins->operands.size();
+            if (nopers == 2)
+            {
+                auto q0 = ins->operands[0];
+                auto q1 = ins->operands[1];
+                auto edge_no = config->qubitpair2edge.get(q0, q1);
+                if( edge_no == edge_matrix_t::no_edge )
+                {
+                    EOUT("Use of illegal edge: " << q0 << "->" << q1 << " in operation: " << ins->name << " !");
+                    throw ql::exception("[x] Error : Use of illegal edge"+std::to_string(q0)+"->"+std::to_string(q1)+"in operation:"+ins->name+" !",false);
+                }
+                for(auto q : detunes_of(edge_no))
+                {
+                    claims.push_back(claim_t{q, size_t(desc.optype)});
+                }
+            }
+            else if (nopers != 1)
+            {
+                FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
+            }
+        }
+        else if( desc.optype == ql::optype_mw )
+        {
+            for( auto q : ins->operands )
+            {
+                claims.push_back(claim_t{q, size_t(desc.optype)});
+            }
+        }
+    }
     ~detuned_qubits_resource_t() {}
 };
 
@@ -56,7 +56,77 @@ inline std::string get_cc_light_instruction_name(std::string & id, const ql::qua
     return cc_light_instr_name;
 }
 
-ql::ir::bundles_t cc_light_schedule(ql::circuit & ckt, 
+// combine parallel instructions of same type from different sections into a single section,
+// and remove empty sections; this is done in a single scan over each bundle's sections:
+// the combined section takes the place of the first section with that cc_light instruction,
+// and gates of later sections come before those of earlier sections in it
+inline ql::ir::flat_bundles_t combine_parallel_sections(const ql::ir::flat_bundles_t & bundles1,
+    const ql::quantum_platform & platform)
+{
+    ql::ir::flat_bundles_t bundles2;
+    bundles2.reserve(bundles1.gates.size());
+
+    std::vector<std::vector<size_t>> combined;      // per section of the new bundle: the old sections making it up
+    std::map<std::string,size_t> instr2combined;    // cc_light instruction name to its index in combined
+    for (size_t b = 0; b < bundles1.size(); b++)
+    {
+        combined.clear();
+        instr2combined.clear();
+
+        // only when there is something to combine, the cc_light instruction names are needed
+        size_t nquantum = 0;
+        for (size_t s = bundles1.sections_begin(b); s < bundles1.sections_end(b); s++)
+        {
+            if (bundles1.gates_begin(s) != bundles1.gates_end(s)
+                && bundles1.gates[bundles1.gates_begin(s)]->type() != __classical_gate__)
+            {
+                nquantum++;
+            }
+        }
+
+        for (size_t s = bundles1.sections_begin(b); s < bundles1.sections_end(b); s++)
+        {
+            if (bundles1.gates_begin(s) == bundles1.gates_end(s))
+            {
+                continue;
+            }
+            auto gp = bundles1.gates[bundles1.gates_begin(s)];
+            if (nquantum < 2 || gp->type() == __classical_gate__)
+            {
+                combined.push_back(std::vector<size_t>(1, s));
+                continue;
+            }
+            auto n = get_cc_light_instruction_name(gp->name, platform);
+            auto it = instr2combined.find(n);
+            if (it == instr2combined.end())
+            {
+                instr2combined[n] = combined.size();
+                combined.push_back(std::vector<size_t>(1, s));
+            }
+            else
+            {
+                DOUT("Splicing " << gp->name << "/" << n << " into section of " << n);
+                combined[it->second].push_back(s);
+            }
+        }
+
+        bundles2.add_bundle(bundles1.start_cycle[b], bundles1.duration_in_cycles[b]);
+        for (auto & secs : combined)
+        {
+            bundles2.add_section();
+            for (auto sit = secs.rbegin(); sit != secs.rend(); ++sit)
+            {
+                for (size_t i = bundles1.gates_begin(*sit); i < bundles1.gates_end(*sit); i++)
+                {
+                    bundles2.add_gate(bundles1.gates[i]);
+                }
+            }
+        }
+    }
+    return bundles2;
+}
+
+ql::ir::flat_bundles_t cc_light_schedule(ql::circuit & ckt, 
     const ql::quantum_platform & platform, std::string & dot, size_t nqubits, size_t ncreg = 0)
 {
     IOUT("Scheduling CC-Light instructions ...");
@@ -64,7 +134,7 @@ ql::ir::bundles_t cc_light_schedule(ql::circuit & ckt,
     Scheduler sched;
     sched.init(ckt, platform, nqubits, ncreg);
 
-    ql::ir::bundles_t bundles1;
+    ql::ir::flat_bundles_t bundles1;
     std::string schedopt = ql::options::get("scheduler");
     if ("ASAP" == schedopt)
     {
@@ -83,72 +153,15 @@ ql::ir::bundles_t cc_light_schedule(ql::circuit & ckt,
 
     ql::ir::DebugBundles("After scheduling", bundles1);
 
-    // combine parallel instrcutions of same type from different sections
-    // into a single section
-    for (ql::ir::bundle_t & abundle : bundles1)
-    {
-        auto secIt1 = abundle.parallel_sections.begin();
-
-        for( ; secIt1 != abundle.parallel_sections.end(); ++secIt1 )
-        {
-            for( auto secIt2 = std::next(secIt1); secIt2 != abundle.parallel_sections.end(); ++secIt2)
-            {
-                auto insIt1 = secIt1->begin();
-                auto insIt2 = secIt2->begin();
-                if(insIt1 != secIt1->end() && insIt2 != secIt2->end() )
-                {
-                    auto id1 = (*insIt1)->name;
-                    auto id2 = (*insIt2)->name;
-                    auto itype1 = (*insIt1)->type();
-                    auto itype2 = (*insIt2)->type();
-                    if (itype1 == __classical_gate__ || itype2 == __classical_gate__)
-                    {
-                        DOUT("Not splicing " << id1 << " and " << id2);
-                        continue;
-                    }
-
-                    auto n1 = get_cc_light_instruction_name(id1, platform);
-                    auto n2 = get_cc_light_instruction_name(id2, platform);
-                    if( n1 == n2 )
-                    {
-                        DOUT("Splicing " << id1 << "/" << n1 << " and " << id2 << "/" << n2);
-                        (*secIt1).splice(insIt1, (*secIt2) );
-                    }
-                    // else
-                    // {
-                    //     DOUT("Not splicing " << id1 << "/" << n1 << " and " << id2 << "/" << n2);
-                    // }
-                }
-            }
-        }
-    }
-
-    ql::ir::DebugBundles("After combining", bundles1);
-
-    // remove empty sections
-    ql::ir::bundles_t bundles2;
-    for (ql::ir::bundle_t & abundle1 : bundles1)
-    {
-        ql::ir::bundle_t abundle2;
-        abundle2.start_cycle = abundle1.start_cycle;
-        abundle2.duration_in_cycles = abundle1.duration_in_cycles;
-        for(auto & sec : abundle1.parallel_sections)
-        {
-            if( !sec.empty() )
-            {
-                abundle2.parallel_sections.push_back(sec);
-            }
-        }
-        bundles2.push_back(abundle2);
-    }
+    ql::ir::flat_bundles_t bundles2 = combine_parallel_sections(bundles1, platform);
 
-    ql::ir::DebugBundles("After removing empty sections", bundles2);
+    ql::ir::DebugBundles("After combining and removing empty sections", bundles2);
 
     IOUT("Scheduling CC-Light instructions [Done].");
     return bundles2;
 }
 
-ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt, 
+ql::ir::flat_bundles_t cc_light_schedule_rc(ql::circuit & ckt, 
     const ql::quantum_platform & platform, std::string & dot, size_t nqubits, size_t ncreg = 0)
 {
     IOUT("Resource constraint scheduling of CC-Light instructions ...");
@@ -173,7 +186,7 @@ ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt,
 
     Scheduler sched;
     sched.init(ckt, platform, nqubits, ncreg);
-    ql::ir::bundles_t bundles1;
+    ql::ir::flat_bundles_t bundles1;
     if ("ASAP" == schedopt)
     {
         bundles1 = sched.schedule_asap(rm, platform, dot);
@@ -189,68 +202,12 @@ ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt,
 
     }
 
-    IOUT("Combining parallel sections...");
+    IOUT("Combining parallel sections and removing empty sections...");
     ql::ir::DebugBundles("After scheduling_rc", bundles1);
 
-    // combine parallel instrcutions of same type from different sections
-    // into a single section
-    for (ql::ir::bundle_t & abundle : bundles1)
-    {
-        auto secIt1 = abundle.parallel_sections.begin();
+    ql::ir::flat_bundles_t bundles2 = combine_parallel_sections(bundles1, platform);
 
-        for( ; secIt1 != abundle.parallel_sections.end(); ++secIt1 )
-        {
-            for( auto secIt2 = std::next(secIt1); secIt2 != abundle.parallel_sections.end(); ++secIt2)
-            {
-                auto insIt1 = secIt1->begin();
-                auto insIt2 = secIt2->begin();
-                if(insIt1 != secIt1->end() && insIt2 != secIt2->end() )
-                {
-                    auto id1 = (*insIt1)->name;
-                    auto id2 = (*insIt2)->name;
-                    auto itype1 = (*insIt1)->type();
-                    auto itype2 = (*insIt2)->type();
-                    if (itype1 == __classical_gate__ || itype2 == __classical_gate__)
-                    {
-                        DOUT("Not splicing " << id1 << " and " << id2);
-                        continue;
-                    }
-
-                    auto n1 = get_cc_light_instruction_name(id1, platform);
-                    auto n2 = get_cc_light_instruction_name(id2, platform);
-                    if( n1 == n2 )
-                    {
-                        DOUT("Splicing " << id1 << "/" << n1 << " and " << id2 << "/" << n2);
-                        (*secIt1).splice(insIt1, (*secIt2) );
-                    }
-                    else
-                    {
-                        DOUT("Not splicing " << id1 << "/" << n1 << " and " << id2 << "/" << n2);
-                    }
-                }
-            }
-        }
-    }
-    ql::ir::DebugBundles("After combinging", bundles1);
-
-    IOUT("Removing empty sections...");
-    // remove empty sections
-    ql::ir::bundles_t bundles2;
-    for (ql::ir::bundle_t & abundle1 : bundles1)
-    {
-        ql::ir::bundle_t abundle2;
-        abundle2.start_cycle = abundle1.start_cycle;
-        abundle2.duration_in_cycles = abundle1.duration_in_cycles;
-        for(auto & sec : abundle1.parallel_sections)
-        {
-            if( !sec.empty() )
-            {
-                abundle2.parallel_sections.push_back(sec);
-            }
-        }
-        bundles2.push_back(abundle2);
-    }
-    ql::ir::DebugBundles("After removing empty sections", bundles2);
+    ql::ir::DebugBundles("After combining and removing empty sections", bundles2);
 
     IOUT("Resource constraint scheduling of CC-Light instructions [Done].");
     return bundles2;
@@ -0,0 +1,118 @@
+/**
+ * @file   gate_arena.h
+ * @date   10/2026
+ * @brief  arena owning the gates created for the kernels of a program
+ */
+
+#ifndef QL_GATE_ARENA_H
+#define QL_GATE_ARENA_H
+
+#include <new>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+namespace ql
+{
+
+/**
+ * gate_arena_t
+ *
+ * Owns the gates that are created for a kernel: by the kernel's gate interface,
+ * by the passes that add gates to its circuit (such as the mapper and the clifford optimizer,
+ * which use that interface) and by the backend's decompositions.
+ * Circuits, bundles and dependence graphs only refer to these gates;
+ * they are released in bulk when the arena goes.
+ *
+ * The gates are constructed in large blocks, one after the other in order of creation,
+ * so that the gates of a circuit are close together in memory.
+ * A kernel refers to its arena by a std::shared_ptr, which copies of the kernel share,
+ * so that a kernel can be copied and moved (e.g. into a program) while its gates remain valid;
+ * the arena is released with the last kernel (or program copy of it) referring to it.
+ *
+ * Gates have no virtual destructor, so the arena remembers the destructor of the type created.
+ *
+ * An arena is not thread-safe: threads creating gates concurrently each need their own arena.
+ * When such gates may end up in the kernel's circuit, the kernel's arena adopts those arenas,
+ * which keeps them alive as long as it is.
+ */
+class gate_arena_t
+{
+public:
+    gate_arena_t() {}
+    gate_arena_t(const gate_arena_t&) = delete;
+    gate_arena_t& operator=(const gate_arena_t&) = delete;
+
+    // construct a T from args in the arena, and return it
+    template<typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        void* p = allocate(sizeof(T), alignof(T));
+        T* obj = new (p) T(std::forward<Args>(args)...);
+        objects.push_back(object_t{obj, &destroy<T>});
+        return obj;
+    }
+
+    // keep other alive as long as this arena, so that the gates created in it can be used like our own
+    void adopt(const std::shared_ptr<gate_arena_t>& other)
+    {
+        adopted.push_back(other);
+    }
+
+    // number of objects created in the arena
+    size_t size() const
+    {
+        return objects.size();
+    }
+
+    ~gate_arena_t()
+    {
+        for (auto it = objects.rbegin(); it != objects.rend(); ++it)
+        {
+            it->destroy(it->obj);
+        }
+    }
+
+private:
+    static const size_t block_size = 64*1024;   // bytes per block; larger objects get a block of their own
+
+    typedef struct {
+        void*   obj;                            // created object
+        void    (*destroy)(void*);              // its destructor
+    } object_t;
+
+    std::vector<std::unique_ptr<char[]>>    blocks; // the blocks allocated, the last one being filled
+    std::vector<std::unique_ptr<char[]>>    large;  // the blocks of the objects larger than block_size
+    size_t                                  used = block_size;  // bytes used in the last block
+    std::vector<object_t>                   objects;// the objects created, in order of creation
+    std::vector<std::shared_ptr<gate_arena_t>> adopted; // the arenas kept alive by this one
+
+    template<typename T>
+    static void destroy(void* p)
+    {
+        static_cast<T*>(p)->~T();
+    }
+
+    void* allocate(size_t size, size_t align)
+    {
+        // blocks are allocated by new char[], so are aligned for any fundamental type
+        if (size > block_size)
+        {
+            large.emplace_back(new char[size]);
+            return large.back().get();
+        }
+        size_t offset = (used + align - 1) / align * align;
+        if (offset + size > block_size)
+        {
+            blocks.emplace_back(new char[block_size]);
+            offset = 0;
+        }
+        used = offset + size;
+        return blocks.back().get() + offset;
+    }
+};
+
+}
+
+#endif // QL_GATE_ARENA_H
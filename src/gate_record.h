@@ -0,0 +1,269 @@
+/**
+ * @file   gate_record.h
+ * @date   10/2026
+ * @brief  compact gate records with interned instruction names and inline operands
+ */
+
+#ifndef QL_GATE_RECORD_H
+#define QL_GATE_RECORD_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <limits>
+#include <cstdint>
+
+#include "utils.h"
+#include "gate.h"
+#include "circuit.h"
+
+namespace ql
+{
+
+/**
+ * instruction_names
+ *
+ * Interns instruction names: maps each distinct name to a 32-bit id, and back.
+ * Ids are dense, starting at 0 in order of first use, and stay valid for the lifetime of the process;
+ * equal names get equal ids, so names can be compared by comparing ids.
+ * The table is shared by all threads, so accesses are serialized;
+ * the returned names are references into storage that doesn't move.
+ */
+class instruction_names
+{
+public:
+    static uint32_t id(const std::string& name)
+    {
+        table_t& t = table();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        auto it = t.ids.find(name);
+        if (it != t.ids.end())
+        {
+            return it->second;
+        }
+        if (t.names.size() >= std::numeric_limits<uint32_t>::max())
+        {
+            FATAL("instruction_names: too many instruction names");
+        }
+        uint32_t newid = uint32_t(t.names.size());
+        t.names.push_back(name);
+        t.ids.emplace(name, newid);
+        return newid;
+    }
+
+    static const std::string& name(uint32_t id)
+    {
+        table_t& t = table();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        return t.names.at(id);
+    }
+
+private:
+    typedef struct {
+        std::mutex                                  mutex;
+        std::deque<std::string>                     names;  // id -> name; a deque doesn't move its elements
+        std::unordered_map<std::string,uint32_t>    ids;    // name -> id
+    } table_t;
+
+    static table_t& table()
+    {
+        static table_t t;
+        return t;
+    }
+};
+
+/**
+ * gate_record_t
+ *
+ * Compact copy of the attributes of a gate, in 48 bytes, for passes that iterate over many gates
+ * and only need their attributes: the name is interned as an instruction id, the type is stored
+ * instead of obtained by a virtual call, and up to max_qubits qubit operands and max_cregs classical
+ * register operands are stored inline, so that such a pass reads a contiguous vector of records
+ * instead of following the pointers of each gate.
+ * The record is made in addition to the gate, which kernels still store, so it doesn't save memory.
+ * A gate with more operands, or with operands or a duration not fitting in 32 bits, is recorded as spilled:
+ * its operands and duration are not in the record and must be read from the gate itself,
+ * which compact_circuit_t does.
+ */
+class gate_record_t
+{
+public:
+    static const size_t max_qubits = 3;
+    static const size_t max_cregs = 1;
+    static const uint32_t no_name = std::numeric_limits<uint32_t>::max();   // name_id when the name was left out
+
+    uint32_t    name_id;                // interned name, see instruction_names; or no_name
+    uint8_t     gtype;                  // gate_type_t
+    uint8_t     nqubits;                // number of qubit operands in qubits
+    uint8_t     ncregs;                 // number of classical register operands in cregs
+    uint8_t     spilled;                // operands or duration didn't fit; nqubits/ncregs/duration are 0
+    uint32_t    qubits[max_qubits];
+    uint32_t    cregs[max_cregs];
+    uint32_t    duration;               // in ns, as gate::duration
+    int32_t     int_operand;
+    double      angle;
+    size_t      cycle;                  // MAX_CYCLE when not scheduled
+
+    gate_record_t() {}
+
+    gate_record_t(ql::gate* gp, bool with_name = true)
+    {
+        name_id = no_name;
+        if (with_name)
+        {
+            name_id = instruction_names::id(gp->name);
+        }
+        gtype = uint8_t(gp->type());
+        nqubits = 0;
+        ncregs = 0;
+        spilled = 0;
+        duration = 0;
+        int_operand = int32_t(gp->int_operand);
+        angle = gp->angle;
+        cycle = gp->cycle;
+
+        if (!fits(gp))
+        {
+            spilled = 1;
+            return;
+        }
+        duration = uint32_t(gp->duration);
+        for (auto q : gp->operands)
+        {
+            qubits[nqubits++] = uint32_t(q);
+        }
+        for (auto r : gp->creg_operands)
+        {
+            cregs[ncregs++] = uint32_t(r);
+        }
+    }
+
+    // whether the operands and the duration of the gate fit in a record
+    static bool fits(ql::gate* gp)
+    {
+        const size_t max32 = std::numeric_limits<uint32_t>::max();
+
+        if (gp->duration > max32 || gp->operands.size() > max_qubits || gp->creg_operands.size() > max_cregs)
+        {
+            return false;
+        }
+        for (auto q : gp->operands)
+        {
+            if (q > max32) return false;
+        }
+        for (auto r : gp->creg_operands)
+        {
+            if (r > max32) return false;
+        }
+        return true;
+    }
+
+    gate_type_t type() const
+    {
+        return gate_type_t(gtype);
+    }
+
+    const std::string& name() const
+    {
+        if (name_id == no_name)
+        {
+            FATAL("gate_record_t: name of record was left out");
+        }
+        return instruction_names::name(name_id);
+    }
+};
+
+/**
+ * compact_circuit_t
+ *
+ * The gates of a circuit as a contiguous vector of gate records, for passes that
+ * iterate over many gates and only need their attributes.
+ * It also is the adapter to the existing virtual gate API: gate(i) is the ql::gate the i-th record was made of,
+ * so a pass can be migrated to records one part at a time,
+ * and operands and durations are read through qubit_count/qubit, creg_count/creg and duration,
+ * which handle spilled records.
+ * Interning the name of each gate is the main cost of making the records,
+ * so a pass that doesn't use the names (such as the statistics report) leaves them out with with_names false.
+ * The gates must stay alive while the compact circuit is used;
+ * a pass changing cycles in the records can copy them back to the gates with write_cycles.
+ */
+class compact_circuit_t
+{
+public:
+    compact_circuit_t(const ql::circuit& c, bool with_names = true)
+    {
+        records.reserve(c.size());
+        gates.reserve(c.size());
+        for (auto gp : c)
+        {
+            records.emplace_back(gp, with_names);
+            gates.push_back(gp);
+        }
+    }
+
+    size_t size() const
+    {
+        return records.size();
+    }
+
+    const gate_record_t& operator[](size_t i) const
+    {
+        return records[i];
+    }
+
+    gate_record_t& operator[](size_t i)
+    {
+        return records[i];
+    }
+
+    std::vector<gate_record_t>::const_iterator begin() const { return records.begin(); }
+    std::vector<gate_record_t>::const_iterator end() const { return records.end(); }
+
+    ql::gate* gate(size_t i) const
+    {
+        return gates[i];
+    }
+
+    size_t qubit_count(size_t i) const
+    {
+        return records[i].spilled ? gates[i]->operands.size() : records[i].nqubits;
+    }
+
+    size_t qubit(size_t i, size_t k) const
+    {
+        return records[i].spilled ? gates[i]->operands[k] : records[i].qubits[k];
+    }
+
+    size_t creg_count(size_t i) const
+    {
+        return records[i].spilled ? gates[i]->creg_operands.size() : records[i].ncregs;
+    }
+
+    size_t creg(size_t i, size_t k) const
+    {
+        return records[i].spilled ? gates[i]->creg_operands[k] : records[i].cregs[k];
+    }
+
+    size_t duration(size_t i) const
+    {
+        return records[i].spilled ? gates[i]->duration : records[i].duration;
+    }
+
+    void write_cycles() const
+    {
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            gates[i]->cycle = records[i].cycle;
+        }
+    }
+
+private:
+    std::vector<gate_record_t>  records;
+    std::vector<ql::gate*>      gates;      // gates[i] is the gate records[i] was made of
+};
+
+} // namespace ql
+
+#endif // QL_GATE_RECORD_H
@@ -14,6 +14,7 @@
 #include <iostream>
 #include <fstream>
 #include <list>
+#include <algorithm>
 
 namespace ql
 {
@@ -30,15 +31,162 @@ namespace ql
 
         typedef std::list<bundle_t>bundles_t;           // note that subsequent bundles can overlap in time
 
-        inline std::string qasm(bundles_t & bundles)
+        // contiguous form of bundles_t, used by the schedulers, the mapper and the backends;
+        // bundles_t is kept for legacy callers, see to_flat_bundles and to_bundles below.
+        //
+        // The gates of all bundles are stored in a single vector, bundle after bundle,
+        // and within a bundle section after section.
+        // A section is represented by the index in gates of its first gate,
+        // a bundle by the index in section_first of its first section;
+        // each ends where the next one starts (or at the end of the vector).
+        // So walking the bundles just walks three vectors and copying them doesn't allocate per gate.
+        class flat_bundles_t
+        {
+        public:
+            std::vector<ql::gate *> gates;              // all gates, ordered by bundle and within a bundle by section
+            std::vector<size_t>     section_first;      // per section: index in gates of its first gate
+            std::vector<size_t>     bundle_first;       // per bundle: index in section_first of its first section
+            std::vector<size_t>     start_cycle;        // per bundle: start cycle for all gates in its sections
+            std::vector<size_t>     duration_in_cycles; // per bundle: the maximum gate duration in its sections
+
+            size_t size() const { return start_cycle.size(); }
+            bool empty() const { return start_cycle.empty(); }
+
+            void clear()
+            {
+                gates.clear();
+                section_first.clear();
+                bundle_first.clear();
+                start_cycle.clear();
+                duration_in_cycles.clear();
+            }
+
+            void reserve(size_t ngates)
+            {
+                gates.reserve(ngates);
+                section_first.reserve(ngates);
+            }
+
+            // sections of bundle b: [sections_begin(b), sections_end(b))
+            size_t sections_begin(size_t b) const
+            {
+                return bundle_first[b];
+            }
+            size_t sections_end(size_t b) const
+            {
+                return (b+1 < bundle_first.size() ? bundle_first[b+1] : section_first.size());
+            }
+
+            // gates of section s: [gates_begin(s), gates_end(s)), indices in gates
+            size_t gates_begin(size_t s) const
+            {
+                return section_first[s];
+            }
+            size_t gates_end(size_t s) const
+            {
+                return (s+1 < section_first.size() ? section_first[s+1] : gates.size());
+            }
+
+            // all gates of bundle b, regardless of section: [bundle_gates_begin(b), bundle_gates_end(b))
+            size_t bundle_gates_begin(size_t b) const
+            {
+                return (bundle_first[b] < section_first.size() ? section_first[bundle_first[b]] : gates.size());
+            }
+            size_t bundle_gates_end(size_t b) const
+            {
+                return (b+1 < bundle_first.size() ? bundle_gates_begin(b+1) : gates.size());
+            }
+
+            // building in order: open a new bundle, open a new section in the last bundle, add a gate to the last section
+            void add_bundle(size_t start, size_t duration)
+            {
+                bundle_first.push_back(section_first.size());
+                start_cycle.push_back(start);
+                duration_in_cycles.push_back(duration);
+            }
+            void add_section()
+            {
+                section_first.push_back(gates.size());
+            }
+            void add_gate(ql::gate *gp)
+            {
+                gates.push_back(gp);
+            }
+
+            // stable sort of the sections of bundle b, comparing sections by their first gates;
+            // sections must not be empty
+            template<class Compare>
+            void sort_sections(size_t b, Compare first_gate_less)
+            {
+                size_t sb = sections_begin(b);
+                size_t se = sections_end(b);
+                std::vector<size_t> order;
+                for (size_t s = sb; s < se; s++)
+                {
+                    order.push_back(s);
+                }
+                std::stable_sort(order.begin(), order.end(),
+                    [&](size_t s1, size_t s2) { return first_gate_less(gates[section_first[s1]], gates[section_first[s2]]); });
+
+                size_t gb = bundle_gates_begin(b);
+                std::vector<ql::gate *> sorted_gates;
+                std::vector<size_t>     sorted_first;
+                sorted_gates.reserve(bundle_gates_end(b) - gb);
+                for (auto s : order)
+                {
+                    sorted_first.push_back(gb + sorted_gates.size());
+                    sorted_gates.insert(sorted_gates.end(), gates.begin() + gates_begin(s), gates.begin() + gates_end(s));
+                }
+                std::copy(sorted_gates.begin(), sorted_gates.end(), gates.begin() + gb);
+                std::copy(sorted_first.begin(), sorted_first.end(), section_first.begin() + sb);
+            }
+        };
+
+        // adapters between the legacy list form and the contiguous form
+        inline flat_bundles_t to_flat_bundles(const bundles_t & bundles)
+        {
+            flat_bundles_t flat;
+            for (const bundle_t & abundle : bundles)
+            {
+                flat.add_bundle(abundle.start_cycle, abundle.duration_in_cycles);
+                for (const section_t & sec : abundle.parallel_sections)
+                {
+                    flat.add_section();
+                    for (auto gp : sec)
+                    {
+                        flat.add_gate(gp);
+                    }
+                }
+            }
+            return flat;
+        }
+
+        inline bundles_t to_bundles(const flat_bundles_t & flat)
+        {
+            bundles_t bundles;
+            for (size_t b = 0; b < flat.size(); b++)
+            {
+                bundle_t abundle;
+                abundle.start_cycle = flat.start_cycle[b];
+                abundle.duration_in_cycles = flat.duration_in_cycles[b];
+                for (size_t s = flat.sections_begin(b); s < flat.sections_end(b); s++)
+                {
+                    abundle.parallel_sections.push_back(section_t(flat.gates.begin() + flat.gates_begin(s), flat.gates.begin() + flat.gates_end(s)));
+                }
+                bundles.push_back(abundle);
+            }
+            return bundles;
+        }
+
+        inline std::string qasm(const flat_bundles_t & bundles)
         {
             std::stringstream ssqasm;
             size_t curr_cycle=1;
 
             ssqasm << '\n';
-            for (bundle_t & abundle : bundles)
+            for (size_t b = 0; b < bundles.size(); b++)
             {
-                auto st_cycle = abundle.start_cycle;
+                auto st_cycle = bundles.start_cycle[b];
                 auto delta = st_cycle - curr_cycle;
                 // DOUT("Printing bundle with st_cycle: " << st_cycle);
                 if(delta>1)
@@ -46,23 +194,16 @@ namespace ql
                 // else
                 //   ssqasm << '\n';
 
-                auto ngates = 0;
-                for( auto sec_it = abundle.parallel_sections.begin(); sec_it != abundle.parallel_sections.end(); ++sec_it )
-                {
-                    ngates += sec_it->size();
-                }
+                auto gb = bundles.bundle_gates_begin(b);
+                auto ge = bundles.bundle_gates_end(b);
+                auto ngates = ge - gb;
                 ssqasm << "    ";
                 if (ngates > 1) ssqasm << "{ ";
-                auto isfirst = 1;
-                for( auto sec_it = abundle.parallel_sections.begin(); sec_it != abundle.parallel_sections.end(); ++sec_it )
+                for (auto i = gb; i < ge; i++)
                 {
-                    for ( auto gp : (*sec_it))
-                    {
-                        if (isfirst == 0)
-                            ssqasm << " | ";
-                        ssqasm << gp->qasm();
-                        isfirst = 0;
-                    }
+                    if (i != gb)
+                        ssqasm << " | ";
+                    ssqasm << bundles.gates[i]->qasm();
                 }
                 if (ngates > 1) ssqasm << " }";
                 curr_cycle+=delta;
@@ -71,8 +212,7 @@ namespace ql
 
             if( !bundles.empty() )
             {
-                auto & last_bundle = bundles.back();
-                int lsduration = last_bundle.duration_in_cycles;
+                int lsduration = bundles.duration_in_cycles.back();
                 if( lsduration > 1 )
                     ssqasm << "    wait " << lsduration -1 << '\n';
             }
@@ -80,7 +220,12 @@ namespace ql
             return ssqasm.str();
         }
 
-        inline void write_qasm(bundles_t & bundles)
+        inline std::string qasm(bundles_t & bundles)
+        {
+            return qasm(to_flat_bundles(bundles));
+        }
+
+        inline void write_qasm(const flat_bundles_t & bundles)
         {
             std::ofstream fout;
             std::string fname( ql::options::get("output_dir") + "/ir.qasm" );
@@ -96,20 +241,23 @@ namespace ql
             fout.close();
         }
 
+        inline void write_qasm(bundles_t & bundles)
+        {
+            write_qasm(to_flat_bundles(bundles));
+        }
+
 
         // return bundles for the given circuit;
         // assumes gatep->cycle attribute reflects the cycle assignment;
         // assumes circuit being a vector of gate pointers is ordered by this cycle value;
-        // create bundles in a single scan over the circuit, using currBundle and currCycle as state
-        inline bundles_t bundler(ql::circuit& circ, size_t cycle_time)
+        // create bundles in a single scan over the circuit, using currCycle and the last bundle as state
+        inline flat_bundles_t bundler(ql::circuit& circ, size_t cycle_time)
         {
-            bundles_t bundles;          // result bundles
-        
-            bundle_t    currBundle;     // current bundle at currCycle that is being filled
-            size_t      currCycle = 0;  // cycle at which bundle is to be scheduled
+            flat_bundles_t bundles;     // result bundles
+            bundles.reserve(circ.size());
     
-            currBundle.start_cycle = currCycle; // starts off as empty bundle starting at currCycle
-            currBundle.duration_in_cycles = 0;
+            size_t      currCycle = 0;  // cycle at which last bundle is scheduled
+            bool        inBundle = false;   // whether there is a last bundle at currCycle that is being filled
     
             DOUT("bundler ...");
     
@@ -129,51 +277,29 @@ namespace ql
                     EOUT("Error: circuit not ordered by cycle value");
                     throw ql::exception("[x] Error: circuit not ordered by cycle value",false);
                 }
-                if (newCycle > currCycle)
+                if (newCycle > currCycle || !inBundle)
                 {
-                    if (!currBundle.parallel_sections.empty())
+                    if (inBundle)
                     {
-                        // finish currBundle at currCycle
-                        DOUT(".. bundle at cycle " << currCycle << " duration in cycles: " << currBundle.duration_in_cycles);
-                        for (auto &s : currBundle.parallel_sections)
-                        {
-                            for (auto &sgp: s)
-                            {
-                                DOUT("... with gate(@" << sgp->cycle << ")  " << sgp->qasm());
-                            }
-                        }
-                        bundles.push_back(currBundle);
-                        DOUT(".. ready with bundle at cycle " << currCycle);
-                        currBundle.parallel_sections.clear();
+                        DOUT(".. ready with bundle at cycle " << currCycle << " duration in cycles: " << bundles.duration_in_cycles.back());
                     }
-    
-                    // new empty currBundle at newCycle
+
+                    // new empty bundle at newCycle
                     currCycle = newCycle;
                     DOUT(".. bundling at cycle: " << currCycle);
-                    currBundle.start_cycle = currCycle;
-                    currBundle.duration_in_cycles = 0;
+                    bundles.add_bundle(currCycle, 0);
+                    inBundle = true;
                 }
     
-                // add gp to currBundle
-                section_t asec;
-                asec.push_back(gp);
-                currBundle.parallel_sections.push_back(asec);
+                // add gp to the last bundle
+                bundles.add_section();
+                bundles.add_gate(gp);
                 DOUT("... gate: " << gp->qasm() << " in private parallel section");
-                currBundle.duration_in_cycles = std::max(currBundle.duration_in_cycles, (gp->duration+cycle_time-1)/cycle_time); 
+                bundles.duration_in_cycles.back() = std::max(bundles.duration_in_cycles.back(), (gp->duration+cycle_time-1)/cycle_time); 
             }
-            if (!currBundle.parallel_sections.empty())
+            if (inBundle)
             {
-                // finish currBundle (which is last bundle) at currCycle
-                DOUT("... bundle at cycle " << currCycle << " duration in cycles: " << currBundle.duration_in_cycles);
-                for (auto &s : currBundle.parallel_sections)
-                {
-                    for (auto &sgp: s)
-                    {
-                        DOUT("... with gate(@" << sgp->cycle << ")  " << sgp->qasm());
-                    }
-                }
-                bundles.push_back(currBundle);
-                DOUT(".. ready with bundle at cycle " << currCycle);
+                DOUT(".. ready with bundle at cycle " << currCycle << " duration in cycles: " << bundles.duration_in_cycles.back());
             }
     
             // currCycle == cycle of last gate of circuit scheduled
@@ -185,30 +311,35 @@ namespace ql
             }
             else
             {
-                DOUT("Depth: " << currCycle + currBundle.duration_in_cycles - bundles.front().start_cycle);
+                DOUT("Depth: " << currCycle + bundles.duration_in_cycles.back() - bundles.start_cycle.front());
             }
             DOUT("bundler [DONE]");
             return bundles;
         }
 
-        inline void DebugBundles(std::string at, bundles_t& bundles)
+        inline void DebugBundles(std::string at, const flat_bundles_t& bundles)
         {
             DOUT("DebugBundles at: " << at << " showing " << bundles.size() << " bundles");
-            for (bundle_t & abundle : bundles)
+            for (size_t b = 0; b < bundles.size(); b++)
             {
-                DOUT("... bundle with nsections: " << abundle.parallel_sections.size());
-                for( auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt )
+                DOUT("... bundle with nsections: " << bundles.sections_end(b) - bundles.sections_begin(b));
+                for (size_t s = bundles.sections_begin(b); s < bundles.sections_end(b); s++)
                 {
-                    DOUT("... section with ngates: " << secIt->size());
-                    for ( auto gp : (*secIt))
+                    DOUT("... section with ngates: " << bundles.gates_end(s) - bundles.gates_begin(s));
+                    for (size_t i = bundles.gates_begin(s); i < bundles.gates_end(s); i++)
                     {
-                        // auto n = get_cc_light_instruction_name(gp->name, platform);
+                        auto gp = bundles.gates[i];
                         DOUT("... ... gate: " << gp->qasm() << " name: " << gp->name << " cc_light_iname: " << "?");
                     }
                 }
             }
         }
 
+        inline void DebugBundles(std::string at, bundles_t& bundles)
+        {
+            DebugBundles(at, to_flat_bundles(bundles));
+        }
+
     } // namespace ir
 } //namespace ql
 
@@ -11,6 +11,7 @@
 
 #include <sstream>
 #include <algorithm>
+#include <unordered_set>
 #include <iterator>
 
 #include "compile_options.h"
@@ -18,6 +19,7 @@
 #include "utils.h"
 #include "options.h"
 #include "gate.h"
+#include "gate_arena.h"
 #include "classical.h"
 #include "optimizer.h"
 #include "ir.h"
@@ -51,20 +53,21 @@ public: // FIXME: should be private
     size_t        creg_count;
     kernel_type_t type;
     circuit       c;
-    ql::ir::bundles_t bundles;
+    ql::ir::flat_bundles_t bundles;
     operation     br_condition;
     size_t        cycle_time;                               // FIXME: just a copy of platform.cycle_time
+    std::shared_ptr<gate_arena_t> arena;                    // owns the gates created for this kernel; shared by its copies
 private:
     instruction_map_t instruction_map;
 
 public:
     quantum_kernel(std::string name) :
-        name(name), iterations(1), type(kernel_type_t::STATIC) {}
+        name(name), iterations(1), type(kernel_type_t::STATIC), arena(std::make_shared<gate_arena_t>()) {}
 
     quantum_kernel(std::string name, const ql::quantum_platform& platform,
                    size_t qcount, size_t ccount=0) :
         name(name), iterations(1), qubit_count(qcount),
-        creg_count(ccount), type(kernel_type_t::STATIC)
+        creg_count(ccount), type(kernel_type_t::STATIC), arena(std::make_shared<gate_arena_t>())
     {
         instruction_map = platform.instruction_map;
         cycle_time = platform.cycle_time;
@@ -172,21 +175,21 @@ public:
     {
         std::string gname("rx");    // FIXME: unused
         // to do : rotation decomposition
-        c.push_back(new ql::rx(qubit,angle));
+        c.push_back(arena->create<ql::rx>(qubit,angle));
     }
 
     void ry(size_t qubit, double angle)
     {
         std::string gname("ry");    // FIXME: unused
         // to do : rotation decomposition
-        c.push_back(new ql::ry(qubit,angle));
+        c.push_back(arena->create<ql::ry>(qubit,angle));
     }
 
     void rz(size_t qubit, double angle)
     {
         std::string gname("rz");    // FIXME: unused
         // to do : rotation decomposition
-        c.push_back(new ql::rz(qubit,angle));
+        c.push_back(arena->create<ql::rz>(qubit,angle));
     }
 
     void s(size_t qubit)
@@ -282,7 +285,7 @@ public:
     void toffoli(size_t qubit1, size_t qubit2, size_t qubit3)
     {
         // TODO add custom gate check if needed
-        c.push_back(new ql::toffoli(qubit1, qubit2, qubit3));
+        c.push_back(arena->create<ql::toffoli>(qubit1, qubit2, qubit3));
     }
 
     void swap(size_t qubit1, size_t qubit2)
@@ -297,7 +300,7 @@ public:
 
     void display()
     {
-        c.push_back(new ql::display());
+        c.push_back(arena->create<ql::display>());
     }
 
     /**
@@ -460,121 +463,121 @@ private:
 
         if( gname == "identity" || gname == "i" )
         {
-            c.push_back(new ql::identity(qubits[0]) );
+            c.push_back(arena->create<ql::identity>(qubits[0]) );
             result = true;
         }
         else if( gname == "hadamard" || gname == "h" )
         {
-            c.push_back(new ql::hadamard(qubits[0]) );
+            c.push_back(arena->create<ql::hadamard>(qubits[0]) );
             result = true;
         }
         else if( gname == "pauli_x" || gname == "x" )
         {
-            c.push_back(new ql::pauli_x(qubits[0]) );
+            c.push_back(arena->create<ql::pauli_x>(qubits[0]) );
             result = true;
         }
         else if( gname == "pauli_y" || gname == "y" )
         {
-            c.push_back(new ql::pauli_y(qubits[0]) );
+            c.push_back(arena->create<ql::pauli_y>(qubits[0]) );
             result = true;
         }
         else if( gname == "pauli_z" || gname == "z" )
         {
-            c.push_back(new ql::pauli_z(qubits[0]) );
+            c.push_back(arena->create<ql::pauli_z>(qubits[0]) );
             result = true;
         }
         else if( gname == "s" || gname == "phase" )
         {
-            c.push_back(new ql::phase(qubits[0]) );
+            c.push_back(arena->create<ql::phase>(qubits[0]) );
             result = true;
         }
         else if( gname == "sdag" || gname == "phasedag" )
         {
-            c.push_back(new ql::phasedag(qubits[0]) );
+            c.push_back(arena->create<ql::phasedag>(qubits[0]) );
             result = true;
         }
         else if( gname == "t" )
         {
-            c.push_back(new ql::t(qubits[0]) );
+            c.push_back(arena->create<ql::t>(qubits[0]) );
             result = true;
         }
         else if( gname == "tdag" )
         {
-            c.push_back(new ql::tdag(qubits[0]) );
+            c.push_back(arena->create<ql::tdag>(qubits[0]) );
             result = true;
         }
         else if( gname == "rx" )
         {
-            c.push_back(new ql::rx(qubits[0], angle));
+            c.push_back(arena->create<ql::rx>(qubits[0], angle));
             result = true;
         }
         else if( gname == "ry" )
         {
-            c.push_back(new ql::ry(qubits[0], angle));
+            c.push_back(arena->create<ql::ry>(qubits[0], angle));
             result = true;
         }
         else if( gname == "rz" )
         {
-            c.push_back(new ql::rz(qubits[0], angle));
+            c.push_back(arena->create<ql::rz>(qubits[0], angle));
             result = true;
         }
         else if( gname == "rx90" )
         {
-            c.push_back(new ql::rx90(qubits[0]) );
+            c.push_back(arena->create<ql::rx90>(qubits[0]) );
             result = true;
         }
         else if( gname == "mrx90" )
         {
-            c.push_back(new ql::mrx90(qubits[0]) );
+            c.push_back(arena->create<ql::mrx90>(qubits[0]) );
             result = true;
         }
         else if( gname == "rx180" )
         {
-            c.push_back(new ql::rx180(qubits[0]) );
+            c.push_back(arena->create<ql::rx180>(qubits[0]) );
             result = true;
         }
         else if( gname == "ry90" )
         {
-            c.push_back(new ql::ry90(qubits[0]) );
+            c.push_back(arena->create<ql::ry90>(qubits[0]) );
             result = true;
         }
         else if( gname == "mry90" )
         {
-            c.push_back(new ql::mry90(qubits[0]) );
+            c.push_back(arena->create<ql::mry90>(qubits[0]) );
             result = true;
         }
         else if( gname == "ry180" )
         {
-            c.push_back(new ql::ry180(qubits[0]) );
+            c.push_back(arena->create<ql::ry180>(qubits[0]) );
             result = true;
         }
         else if( gname == "measure" )
         {
             if(cregs.empty())
-                c.push_back(new ql::measure(qubits[0]) );
+                c.push_back(arena->create<ql::measure>(qubits[0]) );
             else
-                c.push_back(new ql::measure(qubits[0], cregs[0]) );
+                c.push_back(arena->create<ql::measure>(qubits[0], cregs[0]) );
 
             result = true;
         }
         else if( gname == "prepz" )
         {
-            c.push_back(new ql::prepz(qubits[0]) );
+            c.push_back(arena->create<ql::prepz>(qubits[0]) );
             result = true;
         }
         else if( gname == "cnot" )
         {
-            c.push_back(new ql::cnot(qubits[0], qubits[1]) );
+            c.push_back(arena->create<ql::cnot>(qubits[0], qubits[1]) );
             result = true;
         }
         else if( gname == "cz" || gname == "cphase" )
         {
-            c.push_back(new ql::cphase(qubits[0], qubits[1]) );
+            c.push_back(arena->create<ql::cphase>(qubits[0], qubits[1]) );
             result = true;
         }
         else if( gname == "toffoli" )
-            { c.push_back(new ql::toffoli(qubits[0], qubits[1], qubits[2]) ); result = true; }
-        else if( gname == "swap" )       { c.push_back(new ql::swap(qubits[0], qubits[1]) ); result = true; }
+            { c.push_back(arena->create<ql::toffoli>(qubits[0], qubits[1], qubits[2]) ); result = true; }
+        else if( gname == "swap" )       { c.push_back(arena->create<ql::swap>(qubits[0], qubits[1]) ); result = true; }
         else if( gname == "barrier")
         {
             /*
@@ -587,7 +590,7 @@ private:
                     qubits.push_back(q);
             }
 
-            c.push_back(new ql::wait(qubits, 0, 0));
+            c.push_back(arena->create<ql::wait>(qubits, 0, 0));
             result = true;
         }
         else if( gname == "wait")
@@ -603,7 +606,7 @@ private:
             }
 
             size_t duration_in_cycles = std::ceil(static_cast<float>(duration)/cycle_time);
-            c.push_back(new ql::wait(qubits, duration, duration_in_cycles));
+            c.push_back(arena->create<ql::wait>(qubits, duration, duration_in_cycles));
             result = true;
         }
         else
@@ -635,7 +638,7 @@ private:
         if (it != instruction_map.end())
         {
             // a specialized custom gate is of the form: "cz q0 q3"
-            custom_gate* g = new custom_gate(*(it->second));
+            custom_gate* g = arena->create<custom_gate>(*(it->second));
             for(auto & qubit : qubits)
                 g->operands.push_back(qubit);
             for(auto & cop : cregs)
@@ -652,7 +655,7 @@ private:
             instruction_map_t::iterator it = instruction_map.find(gname);
             if (it != instruction_map.end())
             {
-                custom_gate* g = new custom_gate(*(it->second));
+                custom_gate* g = arena->create<custom_gate>(*(it->second));
                 for(auto & qubit : qubits)
                     g->operands.push_back(qubit);
                 for(auto & cop : cregs)
@@ -1151,12 +1154,12 @@ public:
             }
         }
 
-        c.push_back(new ql::classical(destination, oper));
+        c.push_back(arena->create<ql::classical>(destination, oper));
     }
 
     void classical(std::string operation)
     {
-        c.push_back(new ql::classical(operation));
+        c.push_back(arena->create<ql::classical>(operation));
     }
 
 #if OPT_MICRO_CODE
@@ -1231,6 +1234,7 @@ public:
             toff_kernel.instruction_map = instruction_map;
             toff_kernel.qubit_count = qubit_count;
             toff_kernel.cycle_time = cycle_time;
+            toff_kernel.arena = arena;      // its gates end up in this kernel's circuit
 
             if( __toffoli_gate__ == gtype )
             {
@@ -1282,7 +1286,7 @@ public:
             }
             else if ("no" == scheduler_uniform)
             {
-                ql::ir::bundles_t bundles = sched.schedule_asap(sched_dot);
+                ql::ir::flat_bundles_t bundles = sched.schedule_asap(sched_dot);
                 kqasm = ql::ir::qasm(bundles);
             }
             else
@@ -1294,12 +1298,12 @@ public:
         {
             if ("yes" == scheduler_uniform)
             {
-                ql::ir::bundles_t bundles = sched.schedule_alap_uniform();
+                ql::ir::flat_bundles_t bundles = sched.schedule_alap_uniform();
                 kqasm = ql::ir::qasm(bundles);
             }
             else if ("no" == scheduler_uniform)
             {
-                ql::ir::bundles_t bundles = sched.schedule_alap(sched_dot);
+                ql::ir::flat_bundles_t bundles = sched.schedule_alap(sched_dot);
                 kqasm = ql::ir::qasm(bundles);
             }
             else
@@ -1900,6 +1904,28 @@ public:
     }
 };
 
+/**
+ * whether a gate is in the circuits of more than one of the kernels,
+ * e.g. when a kernel was copied; such kernels cannot be scheduled in parallel
+ * since a scheduler stores its result in the gates (gate::cycle)
+ */
+inline bool kernels_share_gates(const std::vector<quantum_kernel> & kernels)
+{
+    std::unordered_set<ql::gate*> seen;
+    for (auto & k : kernels)
+    {
+        std::unordered_set<ql::gate*> ingates(k.c.begin(), k.c.end());
+        for (auto gp : ingates)
+        {
+            if (!seen.insert(gp).second)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 
 } // namespace ql
 
@@ -14,7 +14,13 @@
 #include <chrono>
 #include <ctime>
 #include <ratio>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <cstdint>
 #include "utils.h"
+#include "thread_pool.h"
 #include "platform.h"
 #include "kernel.h"
 #include "arch/cc_light/cc_light_resource_manager.h"
@@ -22,11 +28,11 @@
 #include "scheduler.h"
 #include "metrics.h"
 
-#ifdef INITIALPLACE
 #include <thread>
-#include <mutex>
-#include <condition_variable>
+#include <exception>
+#ifdef INITIALPLACE
 #include <lemon/lp.h>
+#include <glpk.h>
 #endif // INITIALPLACE
 
 // Note on the use of constructors and Init functions for classes of the mapper
@@ -459,6 +465,13 @@ void Init(const ql::quantum_platform *p)
     // DOUT("... done copy local resource manager to FreeCycle member rm");
 }
 
+// estimate of the memory occupied by this map, see Past::Bytes;
+// each resource keeps a state of a few entries per qubit or edge, which is counted as nq entries
+size_t Bytes() const
+{
+    return sizeof(FreeCycle) + (1 + platformp->resources.size()) * nq * sizeof(size_t);
+}
+
 // depth of the FreeCycle map
 // equals the max of all entries minus the min of all entries
 // not used yet; would be used to compute the max size of a top window on the past
@@ -523,25 +536,6 @@ void Print(std::string s)
     // rm.Print("... in FreeCycle: ");
 }
 
-// get the gate parameters that need to be passed to the resource manager;
-// it would have been nicer if they would have been made available by the platform
-// directly to the resource manager since this function makes the mapper dependent on cc_light
-static void GetGateParameters(std::string id, const ql::quantum_platform *platformp, std::string& operation_name, std::string& operation_type, std::string& instruction_type)
-{
-    if ( !platformp->instruction_settings[id]["cc_light_instr"].is_null() )
-    {
-        operation_name = platformp->instruction_settings[id]["cc_light_instr"];
-    }
-    if ( !platformp->instruction_settings[id]["type"].is_null() )
-    {
-        operation_type = platformp->instruction_settings[id]["type"];
-    }
-    if ( !platformp->instruction_settings[id]["cc_light_instr_type"].is_null() )
-    {
-        instruction_type = platformp->instruction_settings[id]["cc_light_instr_type"];
-    }
-}
-
 // return whether gate with first operand qubit r0 can be scheduled earlier than with operand qubit r1
 bool IsFirstOperandEarlier(size_t r0, size_t r1)
 {
@@ -595,33 +589,27 @@ size_t StartCycleNoRc(ql::gate *g)
 }
 
 // when we would schedule gate g, what would be its start cycle? return it
-// gate operands are real qubit indices
+// gate operands are real qubit indices; desc is the platform's descriptor of g, see Past::Add
 // is purely functional, doesn't affect state
-size_t StartCycle(ql::gate *g)
+size_t StartCycle(ql::gate *g, const ql::instruction_descriptor_t& desc)
 {
     size_t      startCycle = StartCycleNoRc(g);
     
-    auto        mapopt = ql::options::get("mapper");
-    if (mapopt == "baserc" || mapopt == "minextendrc")
+    if (IsRc())
     {
         size_t      baseStartCycle = startCycle;
         size_t      duration = (g->duration+ct-1)/ct;   // rounded-up unsigned integer division
-        auto&       id = g->name;
-        std::string operation_name(id);
-        std::string operation_type;
-        std::string instruction_type;
 
-        GetGateParameters(id, platformp, operation_name, operation_type, instruction_type);
         while (startCycle < MAX_CYCLE)
         {
-            if (rm.available(startCycle, g, operation_name, operation_type, instruction_type, duration))
+            if (rm.available(startCycle, g, desc, duration))
             {
                 break;
             }   
             else
             {
                 // DOUT(" ... [" << startCycle << "] Busy resource for " << g->qasm());
-                startCycle++;
+                startCycle = rm.next_available(startCycle+1, g, desc, duration);
             }
         }
         if (baseStartCycle != startCycle)
@@ -634,6 +622,41 @@ size_t StartCycle(ql::gate *g)
     return startCycle;
 }
 
+// is the resource map used, i.e. are resource constraints taken into account?
+static bool IsRc()
+{
+    auto        mapopt = ql::options::get("mapper");
+    return (mapopt == "baserc" || mapopt == "minextendrc" || mapopt == "beam");
+}
+
+// state of the FreeCycle map, saved by SaveState and restored by RestoreState (e.g. by Past::Checkpoint and Rollback);
+// fcv is O(nq) so it is just saved; the resource map is checkpointed instead,
+// so that restoring it only undoes the reservations made since (see resource_manager_t::checkpoint);
+// without the resource constraints, the resource map isn't used and so it needn't be checkpointed;
+// each SaveState must be matched by a RestoreState, in last-in first-out order
+typedef struct
+{
+    std::vector<size_t>                     fcv;    // saved copy of fcv
+} fcstate_t;
+
+void SaveState(fcstate_t& s)
+{
+    s.fcv = fcv;
+    if (IsRc())
+    {
+        rm.checkpoint();
+    }
+}
+
+void RestoreState(fcstate_t& s)
+{
+    fcv.swap(s.fcv);
+    if (IsRc())
+    {
+        rm.rollback();
+    }
+}
+
 // schedule gate g in the FreeCycle map
 // gate operands are real qubit indices
 // the FreeCycle map is updated, not the resource map
@@ -659,21 +682,15 @@ void AddNoRc(ql::gate *g, size_t startCycle)
 // gate operands are real qubit indices
 // both the FreeCycle map and the resource map are updated
 // startcycle must be the result of an earlier StartCycle call (with rc!)
-void Add(ql::gate *g, size_t startCycle)
+void Add(ql::gate *g, size_t startCycle, const ql::instruction_descriptor_t& desc)
 {
     AddNoRc(g, startCycle);
 
-    auto        mapopt = ql::options::get("mapper");
-    if (mapopt == "baserc" || mapopt == "minextendrc")
+    if (IsRc())
     {
-        auto&       id = g->name;
-        std::string operation_name(id);
-        std::string operation_type;
-        std::string instruction_type;
         size_t      duration = (g->duration+ct-1)/ct;   // rounded-up unsigned integer division
 
-        GetGateParameters(id, platformp, operation_name, operation_type, instruction_type);
-        rm.reserve(startCycle, g, operation_name, operation_type, instruction_type, duration);
+        rm.reserve(startCycle, g, desc, duration);
     }
 }
 
@@ -685,21 +702,21 @@ void Add(ql::gate *g, size_t startCycle)
 //
 // there is a Past attached to the output stream, that is a kind of window with a list of gates in it,
 // to which gates are added after mapping; this is called the 'main' Past.
-// while mapping, several alternatives are evaluated, each of which also has a Past attached,
-// and each of which for most of the parts starts off as a copy of the 'main' Past;
-// but it is in fact a temporary extension of this main Past
+// while mapping, several alternatives are evaluated, each of which is a temporary extension of this main Past;
+// the alternative is tried on the main Past itself, between a Checkpoint and a Rollback of it
 // 
 // Past contains gates of which the schedule might influence a future path selected for mapping binary gates
 // It maintains for each qubit from which cycle on it is free, so that swap insertion
 // can exploit this to hide its overall circuit latency overhead by increasing ILP.
 // Also it maintains the 1 to 1 (reversible) virtual to real qubit map: all gates in past
 // and beyond are mapped and have real qubits as operands.
-// While experimenting with path alternatives, a clone is made of the main past,
-// to insert swaps and evaluate the latency effects; note that inserting swaps changes the mapping.
+// While experimenting with path alternatives, the main past is checkpointed,
+// swaps are inserted and the latency effects are evaluated, and then the past is rolled back;
+// note that inserting swaps changes the mapping.
 //
 // On arrival of a quantum gate(s):
 // - [isempty(waitinglg)]
-// - if 2q nonNN clone mult. pasts, in each clone Add swap/move gates, Schedule, evaluate clones, select, Add swaps to mainPast
+// - if 2q nonNN for each alternative: Checkpoint, Add swap/move gates, Schedule, evaluate, Rollback; select, Add swaps to mainPast
 // - Add, Add, ...: add quantum gates to waitinglg, waiting to be scheduled in [!isempty(waitinglg)]
 // - Schedule: schedules all quantum gates of waitinglg into lg [isempty(waitinglg) && !isempty(lg)]
 // On arrival of a classical gate:
@@ -722,9 +739,14 @@ private:
     Virt2Real               v2r;        // state: current Virt2Real map, imported/exported to kernel
     FreeCycle               fc;         // state: FreeCycle map of this Past
     typedef ql::gate *      gate_p;
-    std::list<gate_p>       waitinglg;  // . . .  list of q gates in this Past, topological order, waiting to be scheduled in
+    typedef struct
+    {
+        gate_p                              gp;
+        const ql::instruction_descriptor_t* dp;     // platform's descriptor of gp, looked up once by Add
+    } waiting_t;
+    std::list<waiting_t>    waitinglg;  // . . .  list of q gates in this Past, topological order, waiting to be scheduled in
                                         //        waitinglg only contains gates from Add and final Schedule call
-                                        //        when evaluating alternatives, it is empty when Past is cloned; so no state
+                                        //        when evaluating alternatives, it is empty when Past is checkpointed; so no state
 public:
     std::list<gate_p>       lg;         // state: list of q gates in this Past, scheduled by their (start) cycle values
                                         //        so this is the result list of this Past, to compare with other Alters
@@ -733,10 +755,33 @@ private:
                                         //        when evaluating alternatives, outlg stays constant; so no state
     std::map<gate_p,size_t> cycle;      // state: gate to cycle map, startCycle value of each past gatecycle[gp]
                                         //        cycle[gp] can be different for each gp for each past
-                                        //        gp->cycle is not used by MapGates
-                                        //        although updated by set_cycle called from MakeAvailable/TakeAvailable
+                                        //        gp->cycle is only set by Schedule, for the gates created by this past's kernel,
+                                        //        so forks of a past evaluating alternatives concurrently don't share them
     size_t                  nswapsadded;// number of swaps (including moves) added to this past
     size_t                  nmovesadded;// number of moves added to this past
+    bool                    trackfidelity;// whether fidstate is maintained, i.e. with mapper=maxfidelity
+    ql::quick_fidelity_state_t fidstate;// state: quick_fidelity of lg, updated as gates are scheduled into lg
+
+                                        // undo journal, see Checkpoint and Rollback
+    typedef enum {
+        je_lginsert,                    // gate was inserted in lg and cycle; undo by erasing it from both
+        je_bypass,                      // gate was appended to outlg; undo by removing it from the back
+        je_flush                        // lg was moved to the back of outlg; undo by moving it back
+    } journalkind_t;
+    typedef struct {
+        journalkind_t                   kind;
+        std::list<gate_p>::iterator     it; // je_lginsert: inserted gate in lg; je_flush: first moved gate in outlg
+    } journalentry_t;
+    typedef struct {
+        size_t                          journalsize;// size of journal when the checkpoint was made
+        Virt2Real                       v2r;        // v2r at checkpoint; is O(nq) so just saved
+        FreeCycle::fcstate_t            fcstate;    // fc at checkpoint; its resource map is checkpointed itself
+        size_t                          nswapsadded;// nswapsadded at checkpoint
+        size_t                          nmovesadded;// nmovesadded at checkpoint
+        ql::quick_fidelity_state_t      fidstate;   // fidstate at checkpoint; is O(nq) so just saved
+    } checkpoint_t;
+    std::vector<journalentry_t> journal;    // changes to lg, outlg and cycle since the oldest checkpoint
+    std::vector<checkpoint_t>   checkpoints;// stack of open checkpoints; empty means no journaling
 
 public:
 
@@ -766,6 +811,113 @@ void Init(const ql::quantum_platform *p, ql::quantum_kernel *k)
     nswapsadded = 0;            // no swaps or moves added yet to this past; AddSwap adds one here
     nmovesadded = 0;            // no moves added yet to this past; AddSwap may add one here
     cycle.clear();              // no gates have cycles assigned in this past; scheduling gate updates this
+    trackfidelity = ("maxfidelity" == ql::options::get("mapper"));
+    ql::quick_fidelity_init(fidstate);  // lg is empty; scheduling gate updates this
+    journal.clear();            // no checkpoints so no journaling yet
+    checkpoints.clear();
+}
+
+// checkpoint the state of this past, so that a later Rollback can return to it;
+// checkpoints nest: each Rollback returns to the state of the last open Checkpoint.
+//
+// this replaces making a copy of the past to try an alternative on:
+// the small state of size nq (v2r, fc's free cycle vector) is saved here, while the changes to the state
+// that grows with the number of gates (lg, outlg and cycle) are logged in the journal
+// and undone by Rollback; fc's resource map logs and undoes its changes itself;
+// so trying an alternative costs O(nq + gates added) instead of O(past)
+void Checkpoint()
+{
+    MapperAssert(waitinglg.empty());    // no gates pending to be scheduled; these would not be journaled
+    checkpoint_t    cp;
+    cp.journalsize = journal.size();
+    cp.v2r = v2r;
+    fc.SaveState(cp.fcstate);
+    cp.nswapsadded = nswapsadded;
+    cp.nmovesadded = nmovesadded;
+    if (trackfidelity)
+    {
+        cp.fidstate = fidstate;
+    }
+    checkpoints.push_back(cp);
+}
+
+// return to the state of the last open checkpoint and close it
+void Rollback()
+{
+    MapperAssert(!checkpoints.empty());
+    checkpoint_t&   cp = checkpoints.back();
+    while (journal.size() > cp.journalsize)
+    {
+        journalentry_t& je = journal.back();
+        switch (je.kind)
+        {
+        case je_lginsert:
+            cycle.erase(*je.it);
+            lg.erase(je.it);
+            break;
+        case je_bypass:
+            outlg.pop_back();
+            break;
+        case je_flush:
+            MapperAssert(lg.empty());   // gates added to lg after the flush have been undone already
+            lg.splice(lg.begin(), outlg, je.it, outlg.end());
+            break;
+        }
+        journal.pop_back();
+    }
+    waitinglg.clear();
+    v2r = cp.v2r;
+    fc.RestoreState(cp.fcstate);
+    nswapsadded = cp.nswapsadded;
+    nmovesadded = cp.nmovesadded;
+    if (trackfidelity)
+    {
+        fidstate = cp.fidstate;
+    }
+    checkpoints.pop_back();
+}
+
+// log a change to lg, outlg or cycle when a checkpoint is open
+void Journal(journalkind_t kind, std::list<gate_p>::iterator it)
+{
+    if (!checkpoints.empty())
+    {
+        journalentry_t  je;
+        je.kind = kind;
+        je.it = it;
+        journal.push_back(je);
+    }
+}
+
+// make this past a copy of the given one, to evaluate alternatives on concurrently with other copies;
+// gates are created in the given kernel, so that concurrent evaluations don't share its circuit;
+// the copy is of the current state and starts without checkpoints, since the journal refers to from's lists
+void Fork(const Past& from, ql::quantum_kernel *k)
+{
+    *this = from;
+    kernelp = k;
+    outlg.clear();              // isn't inspected when evaluating alternatives
+    journal.clear();
+    checkpoints.clear();
+}
+
+// create gates in the given kernel from now on
+void SetKernel(ql::quantum_kernel *k)
+{
+    kernelp = k;
+}
+
+// estimate of the memory occupied by a fork of this past (so without outlg), to compare against option mapbeammemory
+size_t Bytes() const
+{
+    const size_t    listnode = 2 * sizeof(void*);   // overhead per element of a std::list
+    const size_t    mapnode = 4 * sizeof(void*);    // overhead per element of a std::map
+    return sizeof(Past) + fc.Bytes() + 2 * nq * sizeof(size_t)
+        + waitinglg.size() * (sizeof(waiting_t) + listnode)
+        + lg.size() * (sizeof(gate_p) + listnode)
+        + cycle.size() * (sizeof(std::pair<gate_p,size_t>) + mapnode)
+        + journal.capacity() * sizeof(journalentry_t)
+        + checkpoints.size() * (sizeof(checkpoint_t) + 2 * nq * sizeof(size_t) + fc.Bytes());
 }
 
 // import Past's v2r from v2r_value
@@ -807,47 +959,49 @@ void Print(std::string s)
 // the FreeCycle map reflects for each qubit the first free cycle
 // all new gates, now in waitinglist, get such a cycle assigned below, increased gradually, until definitive
 void Schedule()
-        // the copy includes the resource manager.
 {
     // DOUT("Schedule ...");
 
     while (!waitinglg.empty())
     {
         size_t      startCycle = MAX_CYCLE;
-        gate_p      gp;
+        std::list<waiting_t>::iterator  wit;
 
         // find the gate with the minimum startCycle
         //
         // IMPORTANT: this assumes that the waitinglg gates list is in topological order,
         // which is ok because the pair of swap lists use distict qubits and
         // the gates of each are added to the back of the list in the order of execution.
-        // Using tryfc.Add, the tryfc (try FreeCycle map) reflects the earliest startCycle per qubit,
+        // Using fc.Add, the fc (FreeCycle map) reflects the earliest startCycle per qubit,
         // and so dependences are respected, so we can find the gate that can start first ...
-        // Note that tryfc includes the free cycle vector AND the resource map,
-        // so using tryfc.StartCycle/tryfc.Add we get a realistic ASAP rc schedule.
-        // We use a copy of fc and not fc itself, since the latter reflects the really scheduled gates
-        // and that shouldn't be changed.
+        // Note that fc includes the free cycle vector AND the resource map,
+        // so using fc.StartCycle/fc.Add we get a realistic ASAP rc schedule.
+        // We try on fc itself between a SaveState and RestoreState, since fc reflects the really scheduled gates
+        // and that shouldn't be changed; this is cheaper than trying on a copy of fc.
         //
         // This search is really a hack to avoid
         // the construction of a dependence graph and a set of schedulable gates
-        FreeCycle   tryfc = fc;
-        for (auto & trygp : waitinglg)
+        FreeCycle::fcstate_t    fcstate;
+        fc.SaveState(fcstate);
+        for (auto it = waitinglg.begin(); it != waitinglg.end(); it++)
         {
-            size_t tryStartCycle = tryfc.StartCycle(trygp);
-            tryfc.Add(trygp, tryStartCycle);
+            size_t tryStartCycle = fc.StartCycle(it->gp, *it->dp);
+            fc.Add(it->gp, tryStartCycle, *it->dp);
 
             if (tryStartCycle < startCycle)
             {
                 startCycle = tryStartCycle;
-                gp = trygp;
+                wit = it;
             }
         }
+        fc.RestoreState(fcstate);
+        gate_p      gp = wit->gp;
 
         // add this gate to the maps, scheduling the gate (doing the cycle assignment)
         // DOUT("... add " << gp->qasm() << " startcycle=" << startCycle << " cycles=" << ((gp->duration+ct-1)/ct) );
-        fc.Add(gp, startCycle);
+        fc.Add(gp, startCycle, *wit->dp);
         cycle[gp] = startCycle; // cycle[gp] is private to this past but gp->cycle is private to gp
-        gp->cycle = startCycle; // so gp->cycle gets assigned for each alter' Past and finally definitively for mainPast
+        gp->cycle = startCycle; // gp was created by this past's kernel (see new_gate), so no other past or thread uses it
         // DOUT("... set " << gp->qasm() << " at cycle " << startCycle);
     
         // insert gate gp in lg, the list of gates, in cycle[gp] order, and inside this order, as late as possible
@@ -863,7 +1017,7 @@ void Schedule()
                 // rigp.base points after the element that rigp is pointing at
                 // which is lucky because insert only inserts before the given element
                 // the end effect is inserting after rigp
-                lg.insert(rigp.base(), gp);
+                Journal(je_lginsert, lg.insert(rigp.base(), gp));
                 break;
             }
         }
@@ -871,10 +1025,17 @@ void Schedule()
         if (rigp == lg.rend())
         {
             lg.push_front(gp);
+            Journal(je_lginsert, lg.begin());
+        }
+
+        // gp starts after the gates in lg on the same qubits, so it can be added to the fidelity state of lg
+        if (trackfidelity)
+        {
+            ql::quick_fidelity_add(fidstate, gp);
         }
     
         // having added it to the main list, remove it from the waiting list
-        waitinglg.remove(gp);
+        waitinglg.erase(wit);
     }
 
     // DPRINT("Schedule:");
@@ -883,30 +1044,35 @@ void Schedule()
 // compute costs in cycle extension of optionally scheduling initcirc before the inevitable circ
 int InsertionCost(ql::circuit& initcirc, ql::circuit& circ)
 {
-     // first fake-schedule initcirc followed by circ in a private freecyclemap
+     // fake-schedule in fc between a SaveState and RestoreState, so that fc is unchanged afterwards
+
+     // first fake-schedule initcirc followed by circ
      size_t initmax;
-     FreeCycle   tryfcinit = fc;
+     FreeCycle::fcstate_t    fcstate;
+     fc.SaveState(fcstate);
      for (auto & trygp : initcirc)
      {
-         size_t tryStartCycle = tryfcinit.StartCycleNoRc(trygp);
-         tryfcinit.AddNoRc(trygp, tryStartCycle);
+         size_t tryStartCycle = fc.StartCycleNoRc(trygp);
+         fc.AddNoRc(trygp, tryStartCycle);
      }
      for (auto & trygp : circ)
      {
-         size_t tryStartCycle = tryfcinit.StartCycleNoRc(trygp);
-         tryfcinit.AddNoRc(trygp, tryStartCycle);
+         size_t tryStartCycle = fc.StartCycleNoRc(trygp);
+         fc.AddNoRc(trygp, tryStartCycle);
      }
-     initmax = tryfcinit.Max(); // this reflects the depth afterwards
+     initmax = fc.Max();        // this reflects the depth afterwards
+     fc.RestoreState(fcstate);
 
-     // then fake-schedule circ alone in a private freecyclemap
+     // then fake-schedule circ alone
      size_t max;
-     FreeCycle   tryfc = fc;
+     fc.SaveState(fcstate);
      for (auto & trygp : circ)
      {
-         size_t tryStartCycle = tryfc.StartCycleNoRc(trygp);
-         tryfc.AddNoRc(trygp, tryStartCycle);
+         size_t tryStartCycle = fc.StartCycleNoRc(trygp);
+         fc.AddNoRc(trygp, tryStartCycle);
      }
-     max = tryfc.Max();         // this reflects the depth afterwards
+     max = fc.Max();            // this reflects the depth afterwards
+     fc.RestoreState(fcstate);
 
      DOUT("... scheduling init+circ => depth " << initmax << ", scheduling circ => depth " << max << ", init insertion cost " << (initmax-max));
      MapperAssert(initmax >= max);
@@ -915,10 +1081,11 @@ int InsertionCost(ql::circuit& initcirc, ql::circuit& circ)
 }
 
 // add the mapped gate to the current past
-// means adding it to the current past's waiting list, waiting for it to be scheduled later
+// means adding it to the current past's waiting list, waiting for it to be scheduled later;
+// the gate's descriptor is looked up here once, instead of in each FreeCycle::StartCycle/Add that tries it
 void Add(gate_p gp)
 {
-    waitinglg.push_back(gp);
+    waitinglg.push_back({gp, &platformp->get_descriptor(gp->name)});
 }
 
 // create a new gate with given name and qubits
@@ -929,7 +1096,7 @@ void Add(gate_p gp)
 // and we want the gate (or its decomposed sequence) here to be added to circ,
 // the kludge is implemented to make sure that kernel.c (the current kernel's mapper input/output circuit)
 // is available for this:
-// in class Future, kernel.c is copied into the dependence graph or copied to a local circuit; and
+// in class Future, kernel.c is copied into the dependence graph or moved to a circuit owned by the future; and
 // in Mapper::MapCircuit, a temporary local output circuit is used, which is written to kernel.c only at the very end
 bool new_gate(ql::circuit& circ, std::string gname, std::vector<size_t> qubits)
 {
@@ -1267,6 +1434,14 @@ size_t MaxFreeCycle()
     return fc.Max();
 }
 
+// quick_fidelity of lg, with mapper=maxfidelity;
+// is maintained while gates are scheduled, so this is O(nq) instead of O(lg)
+double QuickFidelity()
+{
+    MapperAssert(trackfidelity);
+    return ql::quick_fidelity_result(fidstate, lg.empty() ? NULL : lg.back());
+}
+
 // nonq and q gates follow separate flows through Past:
 // - q gates are put in waitinglg when added and then scheduled; and then ordered by cycle into lg
 //      in lg they are waiting to be inspected and scheduled, until [too many are there,] a nonq comes or end-of-circuit
@@ -1274,11 +1449,16 @@ size_t MaxFreeCycle()
 // all gates in outlg are out of view for scheduling/mapping optimization and can be taken out to elsewhere
 void FlushAll()
 {
-    for( auto & gp : lg )
+    if (lg.empty())
+    {
+        return;
+    }
+    Journal(je_flush, lg.begin());
+    outlg.splice(outlg.end(), lg);  // so effectively, lg's content was moved to outlg and lg is empty
+    if (trackfidelity)
     {
-        outlg.push_back(gp);
+        ql::quick_fidelity_init(fidstate);
     }
-    lg.clear();         // so effectively, lg's content was moved to outlg
 
     // fc.Init(platformp); // needed?
     // cycle.clear();      // needed?
@@ -1294,11 +1474,13 @@ void ByPass(ql::gate* gp)
         FlushAll();
     }
     outlg.push_back(gp);
+    Journal(je_bypass, std::prev(outlg.end()));
 }
 
 // mainPast flushes outlg to parameter oc
 void Out(ql::circuit& oc)
 {
+    MapperAssert(checkpoints.empty());
     for( auto & gp : outlg )
     {
         oc.push_back(gp);
@@ -1320,7 +1502,7 @@ void Out(ql::circuit& oc)
 // Actually, the Alter goes through several stages:
 // - first, for the given 2-qubit gate that is stored in targetgp,
 //   while finding a path from its source to its target, the current path is kept in total;
-//   fromSource, fromTarget, past and score are not used; past is a clone of the main past
+//   fromSource, fromTarget and score are not used
 // - paths are found starting from the source node, and aiming to reach the target node,
 //   each time adding one additional hop to the path
 //   fromSource, fromTarget, and score are still empty and not used
@@ -1335,9 +1517,9 @@ void Out(ql::circuit& oc)
 //   a partial path stores its starting and end nodes (so contains 1 hop less than its length);
 //   the partial path of the target operand is reversed, so starts at the target qubit
 // - then we add swaps to past following the recipee in fromSource and fromTarget; this extends past;
-//   also we compute score as the latency extension caused by these swaps
+//   also we compute score as the latency extension caused by these swaps; then past is rolled back
 //
-// At the end, we have a list of Alters, each with a private Past, and a private latency extension.
+// At the end, we have a list of Alters, each with a private latency extension.
 // The partial paths represent lists of swaps to be inserted.
 // The initial two-qubit gate gets the qubits at the ends of the partial paths as operands.
 // The main selection criterium from the Alters is to select the one with the minimum latency extension.
@@ -1355,7 +1537,6 @@ public:
     std::vector<size_t>     fromSource; // partial path after split, starting at source
     std::vector<size_t>     fromTarget; // partial path after split, starting at target, backward
 
-    Past                    past;       // cloned main past, extended with swaps from this path
     double                  score;      // e.g. latency extension caused by the path
     bool                    didscore;   // initially false, true after assignment to score
 
@@ -1377,7 +1558,6 @@ void Init(const ql::quantum_platform* p, ql::quantum_kernel* k)
     nq = platformp->qubit_number;
     ct = platformp->cycle_time;
     // total, fromSource and fromTarget start as empty vectors
-    past.Init(platformp, kernelp);      // initializes past to empty
     didscore = false;                   // will not print score for now
 }
 
@@ -1439,7 +1619,6 @@ void Print(std::string s)
     {
         std::cout << ", score=" << score;
     }
-    // past.Print("past in Alter");
     std::cout << std::endl;
 }
 
@@ -1493,12 +1672,6 @@ void Print(std::string s, std::list<Alter> & la)
     }
 }
 
-// add a node to the path in front, extending its length with one
-void Add2Front(size_t q)
-{
-    total.insert(total.begin(), q); // hopelessly inefficient
-}
-
 // add to a max of maxnumbertoadd swap gates for the current path to the given past
 // this past can be a path-local one or the main past
 // after having added them, schedule the result into that past
@@ -1559,54 +1732,56 @@ void AddSwaps(Past & past, std::string mapselectswapsopt)
     past.Schedule();
 }
 
-// compute cycle extension of the current alternative in prevPast relative to the given base past
+// compute cycle extension of the current alternative in currPast relative to the given base past
 //
 // Extend can be called in a deep exploration where pasts have been extended
 // each one on top of a previous one, starting from the base past;
 // the currPast here is the last extended one, i.e. on top of which this extension should be done;
-// the basePast is the ultimate base past relative to which the total extension is to be computed.
+// the base past is the ultimate base past relative to which the total extension is to be computed;
+// since that base past has been extended in place, only its MaxFreeCycle is passed, in baseMaxFreeCycle.
 //
-// Do this by adding the swaps described by this alternative
-// to an alternative-local copy of the current past;
-// keep this resulting past in the current alternative (for later use);
+// Do this by adding the swaps described by this alternative to currPast after checkpointing it;
 // compute the total extension of all pasts relative to the base past
-// and store this extension in the alternative's score for later use
-void Extend(Past currPast, Past basePast)
+// and store this extension in the alternative's score for later use;
+// then roll currPast back so that it is unchanged on return
+void Extend(Past& currPast, size_t baseMaxFreeCycle)
 {
-    // DOUT("... clone past, add swaps, compute overall score and keep it all in current alternative");
-    past = currPast;   // explicitly clone currPast to an alternative-local copy of it, Alter.past
-    // DOUT("... adding swaps to alternative-local past ...");
-    AddSwaps(past, "all");
-    // DOUT("... done adding/scheduling swaps to alternative-local past");
+    // DOUT("... checkpoint past, add swaps, compute overall score and rollback past");
+    currPast.Checkpoint();
+    AddSwaps(currPast, "all");
+    // DOUT("... done adding/scheduling swaps to past");
 
     auto mapperopt = ql::options::get("mapper");
     if ("maxfidelity" == mapperopt)
     {
-        score = ql::quick_fidelity(past.lg);
+        score = currPast.QuickFidelity();
     }
     else
     {
-        score = past.MaxFreeCycle() - basePast.MaxFreeCycle();
+        score = currPast.MaxFreeCycle() - baseMaxFreeCycle;
     }
     didscore = true;
+    currPast.Rollback();
 }
 
 // split the path
 // starting from the representation in the total attribute,
 // generate all split path variations where each path is split once at any hop in it
 // the intention is that the mapped two-qubit gate can be placed at the position of that hop
-// all result paths are added/appended to the given result list
+// the result paths are added/appended to the given result list, at most maxsplits of them;
+// return the number of result paths added
 //
 // distance=5   means length=6  means 4 swaps + 1 CZ gate, e.g.
 // index in total:      0           1           2           length-3        length-2        length-1
 // qubit:               2   ->      5   ->      7   ->      3       ->      1       CZ      4
-void Split(std::list<Alter> & resla)
+size_t Split(std::list<Alter> & resla, size_t maxsplits)
 {
     // DOUT("Split ...");
 
     size_t length = total.size();
+    size_t nsplits = 0;
     MapperAssert (length >= 2);   // distance >= 1 so path at least: source -> target
-    for (size_t rightopi = length-1; rightopi >= 1; rightopi--)
+    for (size_t rightopi = length-1; rightopi >= 1 && nsplits < maxsplits; rightopi--)
     {
         size_t leftopi = rightopi - 1;
         MapperAssert (leftopi >= 0);
@@ -1642,9 +1817,11 @@ void Split(std::list<Alter> & resla)
 
         // na.DPRINT("... copy of alter after split");
         resla.push_back(na);
+        nsplits++;
         // DOUT("... added to result list");
         // DPRINT("... current alter after split");
     }
+    return nsplits;
 }
 
 };  // end class Alter
@@ -1667,8 +1844,9 @@ void Split(std::list<Alter> & resla)
 // Grid public members (apart from nq):
 //  form:               how presence of neighbors relates to x/y coordinates of qubits
 //  Distance(qi,qj):    distance in physical connection hops from real qubit qi to real qubit qj;
-//                      - computing it relies on nbs (and Floyd-Warshall)
+//                      - computing it relies on nbs (and breadth-first search from each qubit)
 //                      - in a fully assigned regular topology it could be defined by a formula (not supported)
+//  ShortestPathDag(qj): per real qubit qi, the neighbors of qi that continue a shortest path from qi to qj
 //  nbs[qi]:            list of neighbor real qubits of real qubit qi
 //                      - nbs can be derived from topology.edges or
 //                      - nbs can be computed for a fully assigned regular topology (not supported)
@@ -1709,7 +1887,29 @@ public:
     std::map<size_t,neighbors_t> nbs;   // nbs[i] is list of neighbor qubits of qubit i
     std::map<size_t,int> x;             // x[i] is x coordinate of qubit i
     std::map<size_t,int> y;             // y[i] is y coordinate of qubit i
-    std::vector<std::vector<size_t>>  dist; // dist[i][j] is computed distance between qubits i and j;
+
+    // distance table of a topology, nq*nq and row-major: entry [i*nq+j] is for qubits i and j;
+    // it is shared by all Grids with the same topology (see ComputeDist) and is constant once computed;
+    // entries are 16 bits to keep the table of large platforms in cache, with distunreached for MAX_CYCLE
+    typedef uint16_t    distentry_t;
+    static const distentry_t distunreached = std::numeric_limits<distentry_t>::max();
+    typedef struct
+    {
+        std::vector<distentry_t> dist;      // computed distance between qubits i and j; distunreached when unreachable
+    } disttables_t;
+    std::shared_ptr<const disttables_t> tablesp;    // table of this grid's topology
+    const distentry_t*  dist;           // tablesp->dist.data(), for single-load access
+
+    // shortest-path DAG towards a target qubit tgt, in compressed rows:
+    // succ[offset[qi]..offset[qi+1]-1] are the neighbors of qi that continue a shortest path from qi to tgt,
+    // in the order in which path generation visits them (see ShortestPathDag)
+    typedef struct
+    {
+        std::vector<size_t> offset;     // nq+1 entries
+        std::vector<size_t> succ;
+    } pathdag_t;
+    std::vector<std::shared_ptr<const pathdag_t>> dags; // dags[tgt] is DAG towards tgt, built on first use
+    std::mutex      dagsmutex;          // protects dags, and x/y/nbs while a DAG is built
 
 // Grid initializer
 // initialize mapper internal grid maps from configuration
@@ -1751,6 +1951,8 @@ void Init(const ql::quantum_platform* p)
     InitNbs();
     AngleSortNbs();
     ComputeDist();
+    dags.clear();
+    dags.resize(nq);
     DPRINTGrid();
 }
 
@@ -1758,10 +1960,11 @@ void Init(const ql::quantum_platform* p)
 // formulae for convex (hole free) topologies with underlying grid and with bidirectional edges:
 //      gf_cross:   std::max( std::abs( x[to_realqi] - x[from_realqi] ), std::abs( y[to_realqi] - y[from_realqi] ))
 //      gf_plus:    std::abs( x[to_realqi] - x[from_realqi] ) + std::abs( y[to_realqi] - y[from_realqi] )
-// when the neighbor relation is defined (topology.edges in config file), Floyd-Warshall is used, which currently is always
+// when the neighbor relation is defined (topology.edges in config file), it is computed by ComputeDist, which currently is always
 size_t Distance(size_t from_realqi, size_t to_realqi)
 {
-    return dist[from_realqi][to_realqi];
+    distentry_t d = dist[from_realqi*nq + to_realqi];
+    return (d == distunreached ? MAX_CYCLE : d);
 }
 
 // return clockwise angle around (cx,cy) of (x,y) wrt vertical y axis with angle 0 at 12:00, 0<=angle<2*pi
@@ -1832,34 +2035,112 @@ void Normalize( size_t src, neighbors_t& nbl )
     // for (auto dn : nbl) { std::cout << dn << " "; } std::cout << std::endl;
 }
 
-// Floyd-Warshall dist[i][j] = shortest distances between all nq qubits i and j
-void ComputeDist()
+// hash of the topology as far as it determines the distance tables: nq and the (ordered) neighbor lists
+size_t TopologyHash()
 {
-    // initialize all distances to maximum value, to neighbors to 1, to itself to 0
-    dist.resize(nq); for (size_t i=0; i<nq; i++) dist[i].resize(nq, MAX_CYCLE);
+    std::hash<size_t>   h;
+    size_t              seed = h(nq);
     for (size_t i=0; i<nq; i++)
     {
-        dist[i][i] = 0;
-        for (size_t j: nbs[i])
+        seed ^= h(i) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+        for (size_t n : nbs[i])
+        {
+            seed ^= h(n) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+        }
+    }
+    return seed;
+}
+
+// compute the distance table of nq qubits connected by nbs
+// by a breadth-first search from each qubit, which is O(nq*edges)
+void ComputeTables(disttables_t& t)
+{
+    if (nq >= distunreached)
+    {
+        FATAL("Mapper: number of qubits " << nq << " exceeds the maximum of " << distunreached-1 << " supported by the distance tables");
+    }
+    t.dist.assign(nq*nq, distentry_t(distunreached));
+    std::vector<size_t> queue(nq);
+    for (size_t src=0; src<nq; src++)
+    {
+        distentry_t* d = &t.dist[src*nq];
+        size_t  head = 0;
+        size_t  tail = 0;
+        d[src] = 0;
+        queue[tail++] = src;
+        while (head < tail)
         {
-            dist[i][j] = 1;
+            size_t qi = queue[head++];
+            for (size_t n : nbs[qi])
+            {
+                if (d[n] == distunreached)
+                {
+                    d[n] = d[qi] + 1;
+                    queue[tail++] = n;
+                }
+            }
         }
     }
+}
+
+// dist[i*nq+j] = shortest distances between all nq qubits i and j;
+// the table is looked up in a cache of the topologies of the live Grids, and computed and added when not found,
+// so that repeated initializations on the same platform don't recompute them;
+// the cache doesn't own the tables: each goes with the last Grid using it, and its entry at the next lookup
+void ComputeDist()
+{
+    typedef struct
+    {
+        size_t                          nq;
+        std::map<size_t,neighbors_t>    nbs;
+        std::weak_ptr<const disttables_t> tablesp;
+    } cacheentry_t;
+    static std::mutex                               cachemutex;
+    static std::multimap<size_t,cacheentry_t>       cache;  // topology hash -> entries with that hash
 
-    // find shorter distances by gradually including more qubits (k) in path
-    for (size_t k=0; k<nq; k++)
+    size_t topohash = TopologyHash();
+    tablesp = nullptr;
     {
-        for (size_t i=0; i<nq; i++)
+        std::lock_guard<std::mutex> lock(cachemutex);
+        for (auto it = cache.begin(); it != cache.end(); )
+        {
+            if (it->second.tablesp.expired())
+            {
+                it = cache.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+        auto range = cache.equal_range(topohash);
+        for (auto it = range.first; it != range.second; it++)
         {
-            for (size_t j=0; j<nq; j++)
+            if (it->second.nq == nq && it->second.nbs == nbs)
             {
-               if (dist[i][j] > dist[i][k] + dist[k][j])
-               {
-                   dist[i][j] = dist[i][k] + dist[k][j];
-               }
+                tablesp = it->second.tablesp.lock();
+                if (tablesp != nullptr)
+                {
+                    break;
+                }
             }
         }
     }
+    if (tablesp == nullptr)
+    {
+        DOUT("Grid::ComputeDist: computing tables for topology with hash=" << topohash);
+        auto tp = std::make_shared<disttables_t>();
+        ComputeTables(*tp);
+        tablesp = tp;
+        std::lock_guard<std::mutex> lock(cachemutex);
+        cache.insert( std::make_pair(topohash, cacheentry_t{nq, nbs, tablesp}) );
+    }
+    else
+    {
+        DOUT("Grid::ComputeDist: reusing tables for topology with hash=" << topohash);
+    }
+    dist = tablesp->dist.data();
+
 #ifdef debug
     for (size_t i=0; i<nq; i++)
     {
@@ -1867,11 +2148,11 @@ void ComputeDist()
         {
             if (form == gf_cross)
             {
-                MapperAssert (dist[i][j] == (std::max( std::abs( x[i] - x[j] ), std::abs( y[i] - y[j] ))) );
+                MapperAssert (Distance(i,j) == (std::max( std::abs( x[i] - x[j] ), std::abs( y[i] - y[j] ))) );
             }
             else if (form == gf_plus)
             {
-                MapperAssert (dist[i][j] == (std::abs( x[i] - x[j] ) + std::abs( y[i] - y[j] )) );
+                MapperAssert (Distance(i,j) == (std::abs( x[i] - x[j] ) + std::abs( y[i] - y[j] )) );
             }
 
         }
@@ -1879,6 +2160,43 @@ void ComputeDist()
 #endif
 }
 
+// return the shortest-path DAG towards tgt;
+// this memoizes the successor computation of path generation, which otherwise is redone at each hop of each path;
+// the successors of qi are its neighbors closer to tgt, in nbs order and then normalized (see Normalize);
+// the DAG is built on first use for tgt, and is shared by concurrent callers after that
+std::shared_ptr<const pathdag_t> ShortestPathDag(size_t tgt)
+{
+    std::lock_guard<std::mutex> lock(dagsmutex);
+    if (dags[tgt] == nullptr)
+    {
+        auto dagp = std::make_shared<pathdag_t>();
+        dagp->offset.resize(nq+1);
+        for (size_t qi=0; qi<nq; qi++)
+        {
+            dagp->offset[qi] = dagp->succ.size();
+            size_t d = Distance(qi, tgt);
+            if (qi == tgt || d == MAX_CYCLE)
+            {
+                continue;
+            }
+            neighbors_t nbl;
+            for (size_t n : nbs[qi])
+            {
+                if (Distance(n, tgt) < d)
+                {
+                    nbl.push_back(n);
+                }
+            }
+            // rotate nbl such that largest difference between angles of adjacent elements is beyond back()
+            Normalize(qi, nbl);
+            dagp->succ.insert(dagp->succ.end(), nbl.begin(), nbl.end());
+        }
+        dagp->offset[nq] = dagp->succ.size();
+        dags[tgt] = dagp;
+    }
+    return dags[tgt];
+}
+
 void DPRINTGrid()
 {
     if ( ql::utils::logger::LOG_LEVEL >= ql::utils::logger::log_level_t::LOG_DEBUG )
@@ -2003,6 +2321,7 @@ void AngleSortNbs()
 
 #ifdef INITIALPLACE
 using namespace lemon;
+#endif // INITIALPLACE
 // =========================================================================================
 // InitialPlace: initial placement solved as an MIP, mixed integer linear program
 // the initial placement is modelled as a Quadratic Assignment Problem
@@ -2044,12 +2363,16 @@ using namespace lemon;
 // 1. option initialplace2qhorizon: one of: 0,10,20,30,40,50,60,70,80,90,100
 // The initialplace algorithm considers only this number of initial two-qubit gates to determine a mapping.
 // When 0 is specified as option value, there is no limit.
-// 2. option initialplace: an option steerable timeout mechanism around it is implemented, using threads:
-// The solver runs in a subthread which can succeed or be timed out by the main thread waiting for it.
-// When timed out, it can stop the compiler by raising an exception or continue mapping as if it were not called.
-// When INITIALPLACE is not defined, the compiler doesn't contain initial placement support and ignores calls to it;
-// then all this: lemon/mip, glpk, thread support is avoided making OpenQL much easier build and run.
-// Otherwise, depending on the initialplace option value, initial placement is attempted before the heuristic.
+// 2. option initialplace: an option steerable timeout is passed to the solver as GLPK's time limit (tm_lim).
+// When the solver times out, it can stop the compiler by raising an exception or continue mapping
+// as if it were not called.
+// 3. option initialplaceportfolio: when yes, a heuristic placer (greedy construction followed by
+// simulated annealing) runs in a subthread in parallel with the solver;
+// when the solver doesn't find an optimal placement before the timeout, the heuristic one is taken.
+// When INITIALPLACE is not defined, the compiler doesn't contain the MIP solver: lemon/mip and glpk are avoided,
+// making OpenQL much easier to build and run; then initial placement only is done with initialplaceportfolio,
+// by the heuristic placer, and otherwise calls to it are ignored.
+// Depending on the initialplace option value, initial placement is attempted before the heuristic.
 // Options values of initialplace:
 //  no      don't run initial placement ('ip')
 //  yes     run ip until the solver is ready
@@ -2086,6 +2409,8 @@ private:
                                         // remaining attributes are computed per circuit
     size_t                  nfac;       // number of facilities, actually used virtual qubits; index variables i and j
                                         // nfac <= nlocs: e.g. nlocs == 7, but only v2 and v5 are used; nfac then is 2
+    std::vector<size_t>     v2i;        // v2i[virtual qubit index v] -> index of facility i
+    std::vector<std::vector<size_t>> refcount;  // refcount[i][j] = count of two-qubit gates between facilities i and j
 
 public:
 
@@ -2114,12 +2439,12 @@ void Init(Grid* g, const ql::quantum_platform *p)
     DOUT("Init: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
 }
 
-// find an initial placement of the virtual qubits for the given circuit
-// the resulting placement is put in the provided virt2real map
-// result indicates one of the result indicators (ipr_t, see above)
-void PlaceBody( ql::circuit& circ, Virt2Real& v2r, ipr_t &result, double& iptimetaken)
+// analyze the circuit to compute nfac, v2i and refcount, the constants of the placement problem;
+// when no placement needs to be computed, return false with result set to ipr_any or ipr_current;
+// otherwise return true
+bool PlaceSetup( ql::circuit& circ, Virt2Real& v2r, ipr_t &result, double& iptimetaken)
 {
-    DOUT("InitialPlace.PlaceBody ...");
+    DOUT("InitialPlace.PlaceSetup ...");
 
     // check validity of circuit
     for ( auto& gp : circ )
@@ -2144,8 +2469,7 @@ void PlaceBody( ql::circuit& circ, Virt2Real& v2r, ipr_t &result, double& iptime
     DOUT("... compute ipusecount by scanning circuit");
     std::vector<size_t>  ipusecount;// ipusecount[v] = count of use of virtual qubit v in current circuit
     ipusecount.resize(nvq,0);       // initially all 0
-    std::vector<size_t> v2i;        // v2i[virtual qubit index v] -> index of facility i
-    v2i.resize(nvq,UNDEFINED_QUBIT);// virtual qubit v not used by circuit as gate operand
+    v2i.assign(nvq,UNDEFINED_QUBIT);// virtual qubit v not used by circuit as gate operand
 
     int  twoqubitcount = 0;
     for ( auto& gp : circ )
@@ -2179,8 +2503,7 @@ void PlaceBody( ql::circuit& circ, Virt2Real& v2r, ipr_t &result, double& iptime
     // anymap = there are no two-qubit gates so any map will do
     // currmap = in the current map, all two-qubit gates are NN so current map will do
     DOUT("... compute refcount by scanning circuit");
-    std::vector<std::vector<size_t>>  refcount;
-    refcount.resize(nfac); for (size_t i=0; i<nfac; i++) refcount[i].resize(nfac,0);
+    refcount.assign(nfac, std::vector<size_t>(nfac,0));
     bool anymap = true;    // true when all refcounts are 0
     bool currmap = true;   // true when in current map all two-qubit gates are NN
     
@@ -2213,24 +2536,75 @@ void PlaceBody( ql::circuit& circ, Virt2Real& v2r, ipr_t &result, double& iptime
     if (anymap)
     {
         DOUT("InitialPlace: no two-qubit gates found, so no constraints, and any mapping is ok");
-        DOUT("InitialPlace.PlaceBody [ANY MAPPING IS OK]");
+        DOUT("InitialPlace.PlaceSetup [ANY MAPPING IS OK]");
         result = ipr_any;
         iptimetaken = 0.0;
-        return;
+        return false;
     }
     if (currmap)
     {
         DOUT("InitialPlace: in current map, all two-qubit gates are nearest neighbor, so current map is ok");
-        DOUT("InitialPlace.PlaceBody [CURRENT MAPPING IS OK]");
+        DOUT("InitialPlace.PlaceSetup [CURRENT MAPPING IS OK]");
         result = ipr_current;
         iptimetaken = 0.0;
-        return;
+        return false;
     }
+    return true;
+}
 
-    // compute iptimetaken, start interval timer here
-    using namespace std::chrono;
-    high_resolution_clock::time_point t1 = high_resolution_clock::now();
+#ifdef INITIALPLACE
+// solve the MIP in lp as lemon's GlpkMip::solve does, but stopping after waitseconds;
+// lemon doesn't provide GLPK's time limit (tm_lim), so GLPK is called directly on lemon's problem;
+// return whether solving succeeded, and set timedout when it was stopped by the time limit
+static bool SolveGlpk(glp_prob* lp, int waitseconds, bool& timedout)
+{
+    auto    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(waitseconds);
+
+    glp_smcp smcp;
+    glp_init_smcp(&smcp);
+    smcp.msg_lev = GLP_MSG_OFF;
+    smcp.meth = GLP_DUAL;
+    smcp.tm_lim = waitseconds * 1000;
+    int ret = glp_simplex(lp, &smcp);
+    if (ret == GLP_EBADB || ret == GLP_ESING || ret == GLP_ECOND)
+    {
+        // the basis is not valid; try again with a new one
+        glp_term_out(GLP_OFF);
+        glp_adv_basis(lp, 0);
+        glp_term_out(GLP_ON);
+        ret = glp_simplex(lp, &smcp);
+    }
+    timedout = (ret == GLP_ETMLIM);
+    if (ret != 0)
+    {
+        return false;
+    }
+    if (glp_get_status(lp) != GLP_OPT)
+    {
+        return true;        // no optimal relaxation so no optimal placement, as shown by the problem type
+    }
+
+    auto    left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    if (left <= 0)
+    {
+        timedout = true;
+        return false;
+    }
+    glp_iocp iocp;
+    glp_init_iocp(&iocp);
+    iocp.msg_lev = GLP_MSG_OFF;
+    iocp.tm_lim = int(left);
+    ret = glp_intopt(lp, &iocp);
+    timedout = (ret == GLP_ETMLIM);
+    return ret == 0;
+}
 
+// solve the placement problem exactly by the MIP model described above, using nfac, v2i and refcount;
+// when an optimal solution was found, return true with loc[i] the location of facility i;
+// solving stops after waitseconds (0 is no limit), and then timedout is set
+bool PlaceMip(std::vector<size_t>& loc, int waitseconds, bool& timedout)
+{
+    DOUT("InitialPlace.PlaceMip ...");
     // precompute costmax by applying formula
     // costmax[i][k] = sum j: sum l: refcount[i][j] * distance(k,l) for facility i in location k
     DOUT("... precompute costmax by combining refcount and distances");
@@ -2391,90 +2765,210 @@ void PlaceBody( ql::circuit& circ, Virt2Real& v2r, ipr_t &result, double& iptime
         }
     }
     mip.obj(objective);
-    // DOUT("MINIMIZE " << objs);
 
-    DOUT("... v2r before solving, nvq=" << nvq);
-    for (size_t v=0; v<nvq; v++)
-    {
-        DOUT("... about to print v2r[" << v << "]= ...");
-        DOUT("....." << v2r[v]);
-    }
-    DOUT("..1 nvq=" << nvq);
-    
     // solve the problem
     WOUT("... computing initial placement using MIP, this may take a while ...");
     DOUT("InitialPlace: solving the problem, this may take a while ...");
-    DOUT("..2 nvq=" << nvq);
-    Mip::SolveExitStatus s;
-    DOUT("Just before solve: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
-    DOUT("Just before solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size() << " ipusecount.size()=" << ipusecount.size());
-    DOUT("..2b nvq=" << nvq);
+    bool solved;
+    timedout = false;
+    if (waitseconds == 0)
     {
-        s = mip.solve();
+        solved = (mip.solve() == Mip::SOLVED);
+    }
+    else
+    {
+        solved = SolveGlpk(mip.lpx(), waitseconds, timedout);
     }
-    DOUT("..3 nvq=" << nvq);
-    DOUT("Just after solve: platformp=" << platformp << " nlocs=" << nlocs << " nvq=" << nvq << " gridp=" << gridp);
-    DOUT("Just after solve: objs=" << objs << " x.size()=" << x.size() << " w.size()=" << w.size() << " refcount.size()=" << refcount.size() << " v2i.size()=" << v2i.size() << " ipusecount.size()=" << ipusecount.size());
-    MapperAssert(nvq == nlocs);         // consistency check, mainly to let it crash
-
-    // computing iptimetaken, stop interval timer
-    DOUT("..4 nvq=" << nvq);
-    high_resolution_clock::time_point t2 = high_resolution_clock::now();
-    duration<double> time_span = t2 - t1;
-    iptimetaken = time_span.count();
-    DOUT("..5 nvq=" << nvq);
 
     // DOUT("... determine result of solving");
     Mip::ProblemType pt = mip.type();
-    DOUT("..6 nvq=" << nvq);
-    if (s != Mip::SOLVED || pt != Mip::OPTIMAL)
+    if (!solved || pt != Mip::OPTIMAL)
     {
-        DOUT("... InitialPlace: no (optimal) solution found; solve returned:"<< s << " type returned:" << pt);
-        result = ipr_failed;
-        DOUT("InitialPlace.PlaceBody [FAILED, DID NOT FIND MAPPING]");
-        return;
+        DOUT("... InitialPlace: no (optimal) solution found; solved:"<< solved << " timedout:" << timedout << " type returned:" << pt);
+        DOUT("InitialPlace.PlaceMip [FAILED, DID NOT FIND MAPPING]");
+        return false;
     }
-    DOUT("..7 nvq=" << nvq);
-
-    // return new mapping as result in v2r
 
     // get the results: x[i][k] == 1 iff facility i is in location k (i.e. real qubit index k)
-    // use v2i to translate facilities back to original virtual qubit indices
-    // and fill v2r with the found locations for the used virtual qubits;
-    // the unused mapped virtual qubits are mapped to an arbitrary permutation of the remaining locations;
-    // the latter must be updated to generate swaps when mapping multiple kernels
-    DOUT("..8 nvq=" << nvq);
-    DOUT("... interpret result and copy to Virt2Real, nvq=" << nvq);
-    for (size_t v=0; v<nvq; v++)
-    {
-        DOUT("... about to set v2r to undefined for v " << v);
-        v2r[v] = UNDEFINED_QUBIT;      // i.e. undefined, i.e. v is not an index of a used virtual qubit
-    }
+    loc.assign(nfac, UNDEFINED_QUBIT);
     for ( size_t i=0; i<nfac; i++ )
     {
-        size_t v;   // found virtual qubit index v represented by facility i
-        // use v2i backward to find virtual qubit v represented by facility i
-        DOUT("... about to inspect v2i to get solution and set it in v2r for facility " << i);
-        for (v=0; v<nvq; v++)
+        size_t k;   // location to which facility i was allocated
+        for (k=0; k<nlocs; k++ )
         {
-            if (v2i[v] == i)
+            if (mip.sol(x[i][k]) == 1)
             {
+                loc[i] = k;
                 break;
             }
         }
-        MapperAssert(v < nvq);  // for each facility there must be a virtual qubit
-        size_t k;   // location to which facility i being virtual qubit index v was allocated
-        for (k=0; k<nlocs; k++ )
+        MapperAssert(k < nlocs);  // each facility i by definition represents a used qubit so must have got a location
+    }
+    DOUT("InitialPlace.PlaceMip [SUCCESS, FOUND MAPPING]");
+    return true;
+}
+#endif // INITIALPLACE
+
+// cost of a placement loc as in the MIP objective: sum i: sum j: refcount[i][j] * distance(loc[i],loc[j])
+size_t PlaceCost(const std::vector<size_t>& loc)
+{
+    size_t  cost = 0;
+    for ( size_t i=0; i<nfac; i++ )
+    {
+        for ( size_t j=0; j<nfac; j++ )
         {
-            if (mip.sol(x[i][k]) == 1)
+            cost += refcount[i][j] * gridp->Distance(loc[i],loc[j]);
+        }
+    }
+    return cost;
+}
+
+// cost contribution of facility i in location k, with the other facilities j in loc[j]; facility e is excluded
+size_t PlaceCost(size_t i, size_t k, size_t e, const std::vector<size_t>& loc)
+{
+    size_t  cost = 0;
+    for ( size_t j=0; j<nfac; j++ )
+    {
+        if (j != i && j != e)
+        {
+            cost += refcount[i][j] * gridp->Distance(k,loc[j]) + refcount[j][i] * gridp->Distance(loc[j],k);
+        }
+    }
+    return cost;
+}
+
+// find a placement heuristically, using nfac, v2i and refcount; the result is put in loc
+// first construct one greedily: facilities are placed in order of decreasing two-qubit gate count,
+// each in the free location that is cheapest with respect to the facilities placed so far;
+// then improve it by simulated annealing over moves of a facility to another location,
+// swapping with the facility that is there, if any;
+// annealing stops after a fixed number of moves or when cancel becomes true; the best placement seen is returned
+void PlaceHeuristic(std::vector<size_t>& loc, const std::atomic<bool>& cancel)
+{
+    DOUT("InitialPlace.PlaceHeuristic ...");
+
+    // greedy construction
+    std::vector<size_t> order(nfac);
+    std::vector<size_t> weight(nfac, 0);
+    for ( size_t i=0; i<nfac; i++ )
+    {
+        order[i] = i;
+        for ( size_t j=0; j<nfac; j++ )
+        {
+            weight[i] += refcount[i][j] + refcount[j][i];
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&weight](size_t i, size_t j) { return weight[i] > weight[j]; });
+
+    std::vector<size_t> fac(nlocs, UNDEFINED_QUBIT);   // fac[k] is facility in location k
+    loc.assign(nfac, UNDEFINED_QUBIT);
+    for (auto i : order)
+    {
+        size_t  bestk = UNDEFINED_QUBIT;
+        size_t  bestcost = MAX_CYCLE;
+        for ( size_t k=0; k<nlocs; k++ )
+        {
+            if (fac[k] != UNDEFINED_QUBIT)
             {
-                v2r[v] = k;
-                // v2r.rs[] is not updated because no gates were really mapped yet
-                break;
+                continue;
+            }
+            size_t  cost = 0;
+            for ( size_t j=0; j<nfac; j++ )
+            {
+                if (loc[j] != UNDEFINED_QUBIT)
+                {
+                    cost += refcount[i][j] * gridp->Distance(k,loc[j]) + refcount[j][i] * gridp->Distance(loc[j],k);
+                }
+            }
+            if (cost < bestcost)
+            {
+                bestcost = cost;
+                bestk = k;
             }
         }
-        MapperAssert(k < nlocs);  // each facility i by definition represents a used qubit so must have got a location
-        DOUT("... end loop body over nfac");
+        MapperAssert(bestk != UNDEFINED_QUBIT);     // nfac <= nlocs
+        loc[i] = bestk;
+        fac[bestk] = i;
+    }
+    size_t  cost = PlaceCost(loc);
+    std::vector<size_t> bestloc = loc;
+    size_t  bestcost = cost;
+    DOUT("... greedy placement has cost=" << cost);
+
+    // simulated annealing; at the initial temperature, a move that costs one hop for one gate is often accepted
+    std::mt19937    rgen(1);        // deterministic, so that the result doesn't depend on the run
+    std::uniform_int_distribution<size_t>   randfac(0, nfac-1);
+    std::uniform_int_distribution<size_t>   randloc(0, nlocs-1);
+    std::uniform_real_distribution<double>  randprob(0.0, 1.0);
+    size_t  nmoves = 1000 * nfac * nlocs;
+    double  temperature = 1.0;
+    double  cooling = std::pow(0.001, 1.0/nmoves);    // temperature drops to 0.001 at the last move
+    for (size_t m = 0; m < nmoves && bestcost != 0; m++)
+    {
+        if (m % 1024 == 0 && cancel)
+        {
+            DOUT("... annealing cancelled after " << m << " moves");
+            break;
+        }
+        temperature *= cooling;
+
+        size_t  i = randfac(rgen);
+        size_t  newk = randloc(rgen);
+        size_t  oldk = loc[i];
+        if (newk == oldk)
+        {
+            continue;
+        }
+        size_t  j = fac[newk];      // facility to be swapped with i, or UNDEFINED_QUBIT
+
+        // cost delta of the move; in a swap, the mutual cost of i and j is computed separately
+        long    delta = long(PlaceCost(i, newk, j, loc)) - long(PlaceCost(i, oldk, j, loc));
+        if (j != UNDEFINED_QUBIT)
+        {
+            delta += long(PlaceCost(j, oldk, i, loc)) - long(PlaceCost(j, newk, i, loc));
+            delta += long(refcount[i][j] * gridp->Distance(newk,oldk) + refcount[j][i] * gridp->Distance(oldk,newk))
+                   - long(refcount[i][j] * gridp->Distance(oldk,newk) + refcount[j][i] * gridp->Distance(newk,oldk));
+        }
+        if (delta > 0 && randprob(rgen) >= std::exp(-delta/temperature))
+        {
+            continue;
+        }
+
+        loc[i] = newk;
+        fac[newk] = i;
+        fac[oldk] = j;
+        if (j != UNDEFINED_QUBIT)
+        {
+            loc[j] = oldk;
+        }
+        cost += delta;
+        if (cost < bestcost)
+        {
+            bestcost = cost;
+            bestloc = loc;
+        }
+    }
+    loc = bestloc;
+    DOUT("InitialPlace.PlaceHeuristic [DONE] cost=" << bestcost);
+}
+
+// put the placement loc of the facilities into v2r, using v2i to translate facilities back to virtual qubits;
+// the unused mapped virtual qubits are mapped to an arbitrary permutation of the remaining locations;
+// the latter must be updated to generate swaps when mapping multiple kernels
+void PlaceResult(const std::vector<size_t>& loc, Virt2Real& v2r)
+{
+    DOUT("... interpret result and copy to Virt2Real, nvq=" << nvq);
+    for (size_t v=0; v<nvq; v++)
+    {
+        v2r[v] = UNDEFINED_QUBIT;      // i.e. undefined, i.e. v is not an index of a used virtual qubit
+    }
+    for (size_t v=0; v<nvq; v++)
+    {
+        if (v2i[v] != UNDEFINED_QUBIT)
+        {
+            v2r[v] = loc[v2i[v]];
+            // v2r.rs[] is not updated because no gates were really mapped yet
+        }
     }
 
     auto mapinitone2oneopt = ql::options::get("mapinitone2one");
@@ -2511,32 +3005,29 @@ void PlaceBody( ql::circuit& circ, Virt2Real& v2r, ipr_t &result, double& iptime
                 MapperAssert(k < nlocs);  // when a virtual qubit is not used, there must be a location that is not used
                 v2r[v] = k;
             }
-            DOUT("... end loop body over nvq when mapinitone2oneopt");
         }
     }
     v2r.DPRINT("... final result Virt2Real map of InitialPlace");
-    result = ipr_newmap;
-    DOUT("InitialPlace.PlaceBody [SUCCESS, FOUND MAPPING]");
 }
 
-// the above PlaceBody is a regular function using circ, and updating v2r and result before it returns;
-// it implements Initial Placement as if the call to Place in the mapper called PlaceBody directly;
-// because it may take a while to return, a new Place and a PlaceWrapper are put in between;
-// the idea is to run PlaceBody in a detached thread, that, when ready, signals the main thread;
-// the main thread waits for this signal with a timeout value;
-// all this is done in a try block where the catch is called on this timeout;
-// why exceptions are used, is not clear, so it was replaced by PlaceWrapper returning "timedout" or not
-// and this works as well ...
-bool PlaceWrapper( ql::circuit& circ, Virt2Real& v2r, ipr_t& result, double& iptimetaken, std::string& initialplaceopt)
+// find an initial placement of the virtual qubits for the given circuit
+// put a timelimit on its execution specified by the initialplace option
+// the resulting placement is put in the provided virt2real map, which is unchanged when none was found;
+// result indicates one of the result indicators (ipr_t, see above);
+// with option initialplaceportfolio, a heuristic placement is computed in parallel with the MIP one
+// and it is taken when the MIP doesn't find an optimal one in time; only when neither provides a placement,
+// a timeout is reported, and then the x variants of the initialplace option stop the compiler;
+// without the MIP solver (INITIALPLACE not defined), only the heuristic placement is computed;
+// details of how this is accomplished, can be found above
+void Place( ql::circuit& circ, Virt2Real& v2r, ipr_t& result, double& iptimetaken, std::string& initialplaceopt)
 {
-    DOUT("InitialPlace.PlaceWrapper called");
-    std::mutex  m;
-    std::condition_variable cv;
+    DOUT("InitialPlace.Place ...");
 
     // prepare timeout
-    int      waitseconds;
+    int      waitseconds = 0;       // no time limit
     bool     andthrowexception = false;
-    if ("1s" == initialplaceopt)        { waitseconds = 1; }
+    if ("yes" == initialplaceopt)       { waitseconds = 0; }
+    else if ("1s" == initialplaceopt)   { waitseconds = 1; }
     else if ("1sx" == initialplaceopt)  { waitseconds = 1; andthrowexception = true; }
     else if ("10s" == initialplaceopt)  { waitseconds = 10; }
     else if ("10sx" == initialplaceopt) { waitseconds = 10; andthrowexception = true; }
@@ -2550,83 +3041,94 @@ bool PlaceWrapper( ql::circuit& circ, Virt2Real& v2r, ipr_t& result, double& ipt
     {
         FATAL("Unknown value of option 'initialplace'='" << initialplaceopt << "'.");
     }
-    iptimetaken = waitseconds;    // pessimistic, in case of timeout, otherwise it is corrected
+    bool portfolio = ("yes" == ql::options::get("initialplaceportfolio"));
 
-    // v2r and result are allocated on stack of main thread by some ancestor so be careful with threading
-    std::thread t([&cv, this, &circ, &v2r, &result, &iptimetaken]()
-        {
-            DOUT("InitialPlace.PlaceWrapper subthread about to call PlaceBody");
-            PlaceBody(circ, v2r, result, iptimetaken);
-            DOUT("InitialPlace.PlaceBody returned in subthread; about to signal the main thread");
-            cv.notify_one();        // by this, the main thread awakes from cv.wait_for without timeout
-            DOUT("InitialPlace.PlaceWrapper subthread after signaling the main thread, and is about to die");
-        }
-    );
-    DOUT("InitialPlace.PlaceWrapper main code created thread; about to call detach on it");
-    t.detach();
-    DOUT("InitialPlace.PlaceWrapper main code detached thread");
+    if (!PlaceSetup(circ, v2r, result, iptimetaken))
     {
-        std::chrono::seconds maxwaittime(waitseconds);
-        std::unique_lock<std::mutex> l(m);
-        DOUT("InitialPlace.PlaceWrapper main code starts waiting with timeout of " << waitseconds << " seconds");
-        if (cv.wait_for(l, maxwaittime) == std::cv_status::timeout)
-        {
-            DOUT("InitialPlace.PlaceWrapper main code awoke from waiting with timeout");
-            if (andthrowexception)
-            {
-                DOUT("InitialPlace: timed out and stops compilation [TIMED OUT, STOP COMPILATION]");
-                FATAL("Initial placement timed out and stops compilation [TIMED OUT, STOP COMPILATION]");
-            }
-            DOUT("InitialPlace.PlaceWrapper about to return timedout==true");
-            return true;
-        }
-        DOUT("InitialPlace.PlaceWrapper main code awoke from waiting without timeout, from signal sent by InitialPlace.PlaceWrapper subthread just before its death");
+        DOUT("InitialPlace.Place [done, no placement needed], result=" << result);
+        return;
     }
 
-    DOUT("InitialPlace.PlaceWrapper about to return timedout==false");
-    return false;
-}
-
-// find an initial placement of the virtual qubits for the given circuit as in Place
-// put a timelimit on its execution specified by the initialplace option
-// when it expires, result is set to ipr_timedout;
-// details of how this is accomplished, can be found above;
-// v2r is updated by PlaceBody/PlaceWrapper when it has found a mapping
-void Place( ql::circuit& circ, Virt2Real& v2r, ipr_t& result, double& iptimetaken, std::string& initialplaceopt)
-{
-    Virt2Real   v2r_orig = v2r;
+    // compute iptimetaken, start interval timer here
+    using namespace std::chrono;
+    high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
-    DOUT("InitialPlace.Place ...");
-    if ("yes" == initialplaceopt)
-    {
-        // do initial placement without time limit
-        DOUT("InitialPlace.Place calling PlaceBody without time limit");
-        PlaceBody(circ, v2r, result, iptimetaken);
-        // v2r reflects new mapping, if any found, otherwise unchanged
-        DOUT("InitialPlace.Place [done, no time limit], result=" << result << " iptimetaken=" << iptimetaken << " seconds");
+    std::vector<size_t> loc;        // loc[i] is location of facility i
+    bool found = false;
+    bool timedout = false;
+#ifdef INITIALPLACE
+    if (portfolio)
+    {
+        // the heuristic placer runs in a subthread; it is cancelled when the MIP finds an optimal placement,
+        // and otherwise joined to take its placement
+        std::atomic<bool>   cancel(false);
+        std::vector<size_t> heurloc;
+        std::thread heurthread([&]() { PlaceHeuristic(heurloc, cancel); });
+        try
+        {
+            found = PlaceMip(loc, waitseconds, timedout);
+        }
+        catch (...)
+        {
+            cancel = true;
+            heurthread.join();
+            throw;
+        }
+        cancel = found;
+        heurthread.join();
+        if (found)
+        {
+            DOUT("InitialPlace.Place: taking MIP placement, cost=" << PlaceCost(loc));
+        }
+        else
+        {
+            DOUT("InitialPlace.Place: taking heuristic placement, cost=" << PlaceCost(heurloc));
+            loc = heurloc;
+            found = true;
+        }
     }
     else
     {
-        bool timedout;
-        timedout = PlaceWrapper(circ, v2r, result, iptimetaken, initialplaceopt);
-    
-        if (timedout)
-        {
-            result = ipr_timedout;
-            DOUT("InitialPlace.Place [done, TIMED OUT, NO MAPPING FOUND], result=" << result << " iptimetaken=" << iptimetaken << " seconds");
+        DOUT("InitialPlace.Place calling PlaceMip with time limit of " << waitseconds << " seconds (0 is none)");
+        found = PlaceMip(loc, waitseconds, timedout);
+    }
+#else // ifdef INITIALPLACE
+    MapperAssert(portfolio);        // without the MIP solver, only the heuristic placer is called
+    DOUT("InitialPlace.Place calling PlaceHeuristic; the time limit of " << waitseconds << " seconds is for the MIP solver only");
+    std::atomic<bool>   cancel(false);
+    PlaceHeuristic(loc, cancel);
+    found = true;
+#endif // ifdef INITIALPLACE
 
-            v2r = v2r_orig; // v2r may have got corrupted when timed out during v2r updating
-        }
-        else
+    // computing iptimetaken, stop interval timer
+    high_resolution_clock::time_point t2 = high_resolution_clock::now();
+    duration<double> time_span = t2 - t1;
+    iptimetaken = time_span.count();
+
+    if (found)
+    {
+        PlaceResult(loc, v2r);
+        result = ipr_newmap;
+        DOUT("InitialPlace.Place [done, FOUND MAPPING], result=" << result << " iptimetaken=" << iptimetaken << " seconds");
+    }
+    else if (timedout)
+    {
+        result = ipr_timedout;
+        DOUT("InitialPlace.Place [done, TIMED OUT, NO MAPPING FOUND], result=" << result << " iptimetaken=" << iptimetaken << " seconds");
+        if (andthrowexception)
         {
-            // v2r reflects new mapping, if any found, otherwise unchanged
-            DOUT("InitialPlace.Place [done, not timed out], result=" << result << " iptimetaken=" << iptimetaken << " seconds");
+            DOUT("InitialPlace: timed out and stops compilation [TIMED OUT, STOP COMPILATION]");
+            FATAL("Initial placement timed out and stops compilation [TIMED OUT, STOP COMPILATION]");
         }
     }
+    else
+    {
+        result = ipr_failed;
+        DOUT("InitialPlace.Place [done, FAILED, DID NOT FIND MAPPING], result=" << result << " iptimetaken=" << iptimetaken << " seconds");
+    }
 }
     
 };  // end class InitialPlace
-#endif // INITIALPLACE
 
 // =========================================================================================
 // Future: input window for mapper
@@ -2644,12 +3146,16 @@ void Place( ql::circuit& circ, Virt2Real& v2r, ipr_t& result, double& iptimetake
 // The gates in the list have attributes like criticality, which can be exploited by the mapper.
 // The dependence graph and the availability list operations are provided by the Scheduler class.
 //
-// The future is a window because in principle it could be implemented incrementally,
-// i.e. that the dependence graph would be extended when an attribute gets below a threshold,
-// e.g. when successors of a gate are interrogated for a particular attribute.
-// A problem might be that criticality requires having seen the end of the circuit,
-// but the space overhead of this attribute is much less than that of a full dependence graph.
-// The implementation below is not incremental: it creates the dep graph for a circuit completely.
+// The future is a window because it can be implemented incrementally,
+// i.e. that the dependence graph is extended when the number of gates in it gets below a threshold.
+// By default (option maplookaheadwindow is 0), the dep graph is created for a circuit completely.
+// Otherwise, the dependence graph contains at most maplookaheadwindow gates that have not been mapped yet:
+// when half of those have been mapped, these are erased from the graph and it is refilled from the input circuit;
+// this bounds the mapper's memory for very long circuits by the window size instead of by the circuit length.
+// A problem is that criticality requires having seen the end of the circuit;
+// in the window, criticality is computed relative to the last gates in it, so the result may differ.
+// The window is only refilled in the main line of mapping, not while looking ahead in alternatives,
+// so lookahead is bounded by the window as well.
 //
 // The implementation below just selects the most critical gate from the availability list
 // as next candidate to map, the idea being that any collateral damage of mapping this gate
@@ -2658,18 +3164,39 @@ void Place( ql::circuit& circ, Virt2Real& v2r, ipr_t& result, double& iptimetake
 // Later implementations may become more sophisticated.
 //
 // With option maplookaheadopt=="no", the future window's dependence graph (scheduled and avlist) are not used.
-// Instead a copy of the input circuit (input_gatepv) is created and iterated over (input_gatepp).
+// Instead the input circuit (*input_circp) is iterated over (input_gatepp).
+//
+// With the window and with maplookaheadopt=="no", the gates of kernel.c are moved to *input_circp instead of copied;
+// it is shared by the forks of the future, so that their iterators into it stay valid.
 
 class Future
 {
 public:
     const ql::quantum_platform            *platformp;
-    Scheduler                       *schedp;        // a pointer, since dependence graph doesn't change
-    ql::circuit                     input_gatepv;   // input circuit when not using scheduler based avlist
+    Scheduler                       *schedp;        // a pointer, since dependence graph doesn't change;
+                                                    // shared by the forks of this future, that may be used concurrently,
+                                                    // so apart from SetCircuit and Refill, only its const members are used
+    std::shared_ptr<ql::circuit>    input_circp;    // input circuit with window or when not using scheduler based avlist
 
     std::map<ql::gate*,bool>        scheduled;      // state: has gate been scheduled, here: done from future?
-    std::list<ListDigraph::Node>    avlist;         // state: which nodes/gates are available for mapping now?
-    ql::circuit::iterator           input_gatepp;   // state: alternative iterator in input_gatepv
+    avlist_t                        avlist;         // state: which nodes/gates are available for mapping now?
+    ql::circuit::iterator           input_gatepp;   // state: alternative iterator in *input_circp
+
+                                                    // undo journal, see Checkpoint and Rollback
+    typedef struct {
+        size_t                          journalsize;    // size of journal when the checkpoint was made
+        avlist_t                        avlist;         // avlist at checkpoint; is small so just saved
+        ql::circuit::iterator           input_gatepp;   // input_gatepp at checkpoint
+    } checkpoint_t;
+    std::vector<ql::gate*>          journal;        // gates done since the oldest checkpoint
+    std::vector<checkpoint_t>       checkpoints;    // stack of open checkpoints; empty means no journaling
+
+                                                    // window of the dependence graph, see Refill
+    size_t                          window;         // max number of gates in graph not yet done; 0 is no max
+    size_t                          windowsize;     // number of gates in graph not yet done
+    std::vector<ql::gate*>          windowgates;    // gates in graph, in *input_circp order
+    ql::circuit::iterator           windownext;     // next gate in *input_circp to add to graph
+    std::vector<ql::gate*>          windowdone;     // gates in graph that are done, to be left out of it
 
 // just program wide initialization
 void Init( const ql::quantum_platform *p)
@@ -2689,11 +3216,31 @@ void SetCircuit(ql::quantum_kernel& kernel, Scheduler& sched, size_t nq, size_t
     std::string maplookaheadopt = ql::options::get("maplookahead");
     if ("no" == maplookaheadopt)
     {
-        input_gatepv = kernel.c;                                // copy to free original circuit to allow outputing to
-        input_gatepp = input_gatepv.begin();                    // iterator set to start of input circuit copy
+        input_circp = std::make_shared<ql::circuit>(std::move(kernel.c));   // frees original circuit to allow outputing to
+        kernel.c.clear();
+        input_gatepp = input_circp->begin();                    // iterator set to start of input circuit
+    }
+    else if (0 != atoi(ql::options::get("maplookaheadwindow").c_str()))
+    {
+        window = atoi(ql::options::get("maplookaheadwindow").c_str());
+        input_circp = std::make_shared<ql::circuit>(std::move(kernel.c));   // frees original circuit to allow outputing to
+        kernel.c.clear();
+        windowgates.clear();
+        windownext = input_circp->begin();
+        windowsize = 0;
+        windowdone.clear();
+        scheduled.clear();
+        schedp->init_begin(*input_circp, *platformp, nq, nc);   // graph only contains s, gates are added by Refill
+        scheduled[schedp->instruction[schedp->s]] = false;
+        avlist.clear();
+        avlist.insert(schedp->s, 0);                            // ranked by Refill
+        journal.clear();
+        checkpoints.clear();
+        Refill();
     }
     else
     {
+        window = 0;
         schedp->init(kernel.c, *platformp, nq, nc);             // fills schedp->graph (dependence graph) from all of circuit
                                                                 // and so also the original circuit can be output to after this
         for( auto & gp : kernel.c )
@@ -2702,9 +3249,11 @@ void SetCircuit(ql::quantum_kernel& kernel, Scheduler& sched, size_t nq, size_t
         }
         scheduled[schedp->instruction[schedp->s]] = false;      // also the dummy nodes not
         scheduled[schedp->instruction[schedp->t]] = false;
-        avlist.clear();
-        avlist.push_back(schedp->s);
         schedp->set_remaining(ql::forward_scheduling);          // to know criticality
+        avlist.clear();
+        avlist.insert(schedp->s, schedp->rank[schedp->s]);
+        journal.clear();
+        checkpoints.clear();
 
         if (ql::options::get("print_dot_graphs") == "yes")
         {
@@ -2721,6 +3270,124 @@ void SetCircuit(ql::quantum_kernel& kernel, Scheduler& sched, size_t nq, size_t
     DOUT("Future::SetCircuit [DONE]");
 }
 
+// rebuild the dependence graph without the gates in windowdone,
+// extended from *input_circp up to window gates that are not done;
+// when all of *input_circp has been added, close the graph by adding t;
+// then recompute the criticality of the gates in the graph and reorder avlist accordingly;
+// this must not be called with open checkpoints, since Rollback cannot undo it
+//
+// the done gates are those that the gates not done depend on, so leaving them out
+// only leaves out dependences that are fulfilled, and the gates not done keep their dependences
+// (and in the same order) on each other as when constructing the graph from the whole circuit
+void Refill()
+{
+    MapperAssert(checkpoints.empty());
+    DOUT("Future::Refill: leaving out " << windowdone.size() << " done gates, extending window of " << windowsize << " gates");
+    bool withs = (schedp->s != INVALID_NODE && !scheduled[schedp->instruction[schedp->s]]);
+    for (auto gp : windowdone)
+    {
+        scheduled.erase(gp);
+    }
+    windowdone.clear();
+    windowgates.erase(std::remove_if(windowgates.begin(), windowgates.end(),
+        [this](ql::gate* gp) { return scheduled.count(gp) == 0; }), windowgates.end());
+
+    while (windowsize < window && windownext != input_circp->end())
+    {
+        ql::gate*   gp = *windownext;
+        scheduled[gp] = false;
+        windowgates.push_back(gp);
+        windowsize++;
+        windownext++;
+    }
+
+    // the nodes are renumbered, so keep the order of avlist by its gates
+    std::vector<ql::gate*>  avgates;
+    for (auto & kn : avlist.nodes)
+    {
+        avgates.push_back(schedp->instruction[kn.second]);
+    }
+
+    schedp->restart(withs);
+    for (auto gp : windowgates)
+    {
+        schedp->add_gate(gp);
+    }
+    bool witht = (windownext == input_circp->end());
+    schedp->init_end(witht);
+    if (witht)
+    {
+        scheduled[schedp->instruction[schedp->t]] = false;
+    }
+    schedp->set_remaining_window(windowgates);
+
+    // keep avlist ordered on criticality after its recomputation;
+    // the order among gates of equal criticality is kept
+    avlist.clear();
+    for (auto gp : avgates)
+    {
+        DepGraph::Node  n = schedp->node.at(gp);
+        avlist.insert(n, schedp->rank[n]);
+    }
+
+    // gates added of which all predecessors were done, have become available
+    for (DepGraph::Node n = 0; n < DepGraph::Node(schedp->graph.size()); n++)
+    {
+        if (schedp->graph.preds(n).empty())
+        {
+            schedp->MakeAvailableNoCycle(n, avlist);
+        }
+    }
+}
+
+// checkpoint the state of this future, so that a later Rollback can return to it;
+// checkpoints nest: each Rollback returns to the state of the last open Checkpoint.
+// this replaces making a copy of the future, which would copy the scheduled map of the whole circuit
+void Checkpoint()
+{
+    checkpoint_t    cp;
+    cp.journalsize = journal.size();
+    cp.avlist = avlist;
+    cp.input_gatepp = input_gatepp;
+    checkpoints.push_back(cp);
+}
+
+// return to the state of the last open checkpoint and close it
+void Rollback()
+{
+    MapperAssert(!checkpoints.empty());
+    checkpoint_t&   cp = checkpoints.back();
+    while (journal.size() > cp.journalsize)
+    {
+        scheduled[journal.back()] = false;
+        journal.pop_back();
+    }
+    avlist.swap(cp.avlist);
+    input_gatepp = cp.input_gatepp;
+    checkpoints.pop_back();
+}
+
+// make this future a copy of the given one, of its current state and without checkpoints;
+// the copy shares the input circuit and the dependence graph, so it must be checkpointed before gates are done on it,
+// which then are journaled instead of refilling the window of the graph
+void Fork(const Future& from)
+{
+    *this = from;
+    journal.clear();
+    checkpoints.clear();
+}
+
+// estimate of the memory occupied by this future, to compare against option mapbeammemory
+size_t Bytes() const
+{
+    const size_t    mapnode = 4 * sizeof(void*);    // overhead per element of a std::map
+    size_t          avlistbytes = avlist.size() * (2 * sizeof(avlist_t::key_t) + sizeof(DepGraph::Node) + 2 * mapnode);
+    return sizeof(Future) + avlistbytes
+        + scheduled.size() * (sizeof(std::pair<ql::gate*,bool>) + mapnode)
+        + (windowgates.capacity() + windowdone.capacity() + journal.capacity()) * sizeof(ql::gate*)
+        + checkpoints.size() * (sizeof(checkpoint_t) + avlistbytes);
+}
+
 // Get from avlist all gates that are non-quantum into nonqlg
 // Non-quantum gates include: classical, and dummy (SOURCE/SINK)
 // Return whether some non-quantum gate was found
@@ -2731,7 +3398,7 @@ bool GetNonQuantumGates(std::list<ql::gate*>& nonqlg)
     if ("no" == maplookaheadopt)
     {
         ql::gate*   gp = *input_gatepp;
-        if (input_gatepp != input_gatepv.end())
+        if (input_gatepp != input_circp->end())
         {
             if (gp->type() == ql::__classical_gate__
                 || gp->type() == ql::__dummy_gate__
@@ -2743,9 +3410,9 @@ bool GetNonQuantumGates(std::list<ql::gate*>& nonqlg)
     }
     else
     {
-        for ( auto n : avlist)
+        for ( auto & kn : avlist.nodes)
         {
-            ql::gate*  gp = schedp->instruction[n];
+            ql::gate*  gp = schedp->instruction[kn.second];
             if (gp->type() == ql::__classical_gate__
                 || gp->type() == ql::__dummy_gate__
                 )
@@ -2765,7 +3432,7 @@ bool GetGates(std::list<ql::gate*>& qlg)
     std::string maplookaheadopt = ql::options::get("maplookahead");
     if ("no" == maplookaheadopt)
     {
-        if (input_gatepp != input_gatepv.end())
+        if (input_gatepp != input_circp->end())
         {
             ql::gate*  gp = *input_gatepp;
             if (gp->operands.size() > 2)
@@ -2777,9 +3444,9 @@ bool GetGates(std::list<ql::gate*>& qlg)
     }
     else
     {
-        for ( auto n : avlist)
+        for ( auto & kn : avlist.nodes)
         {
-            ql::gate*  gp = schedp->instruction[n];
+            ql::gate*  gp = schedp->instruction[kn.second];
             if (gp->operands.size() > 2)
             {
                 FATAL(" gate: " << gp->qasm() << " has more than 2 operand qubits; please decompose such gates first before mapping.");
@@ -2801,7 +3468,23 @@ void DoneGate(ql::gate* gp)
     }
     else
     {
-        schedp->TakeAvailable(schedp->node[gp], avlist, scheduled, ql::forward_scheduling);
+        schedp->TakeAvailableNoCycle(schedp->node.at(gp), avlist, scheduled);
+        if (!checkpoints.empty())
+        {
+            journal.push_back(gp);
+        }
+        else if (window != 0)
+        {
+            windowdone.push_back(gp);
+            if (gp->type() != ql::__dummy_gate__)
+            {
+                windowsize--;
+            }
+            if (windowsize <= window/2 && windownext != input_circp->end())
+            {
+                Refill();
+            }
+        }
     }
 }
 
@@ -2887,6 +3570,21 @@ ql::gate* MostCriticalIn(std::list<ql::gate*>& lag)
 //       - otherwise, a separate intermediate kernel for the transition code must be created, and added
 // THE ABOVE INTER-KERNEL MAPPING IS NOT IMPLEMENTED.
 
+// statistics of mapping a kernel, for reporting and tuning the mapper options;
+// Mapper::Map resets them, Mapper::Bundler adds its time, and cc_light_eqasm_compiler::map reports them
+typedef struct
+{
+    size_t              nalters;        // number of alternatives generated by GenAlters
+    size_t              ncheckpoints;   // number of Past checkpoints made to evaluate alternatives on
+    size_t              npastforks;     // number of Past copies made to evaluate alternatives in parallel
+    size_t              nmapmappable;   // number of iterations of MapMappableGates
+    std::vector<size_t> levels;         // levels[l]: number of SelectAlter calls (beam levels) at recursion level l
+    double              initialplacetime;   // seconds spent in InitialPlace
+    double              genalterstime;  // seconds spent in GenAlters called by MapGates
+    double              selectaltertime;// seconds spent in [Beam]SelectAlter called by MapGates, recursion included
+    double              bundlertime;    // seconds spent in Bundler
+} mapstats_t;
+
 // The Mapper's main entry is Map which manages the input and output streams of QASM instructions,
 // and does the logic between (global) initial placement mapper and the (more local) heuristic mapper.
 // It selects the quantum gates from it, and maps these in the context of what was mapped before (the Past).
@@ -2909,6 +3607,40 @@ private:
                                     // Initialized by Mapper.Map
     std::mt19937    gen;            // Standard mersenne_twister_engine, not yet seeded
 
+                                    // Initialized by Mapper::Init and MapCircuit
+    std::unique_ptr<ql::thread_pool> poolp;     // workers evaluating alternatives, see SelectAlter
+    std::vector<ql::quantum_kernel> workerkernels;  // private kernel per worker to create gates in
+
+                                    // Initialized by MapCircuit, used by BeamSelectAlter
+    bool            hasbudget;      // whether option mapbeamtime limits the time of mapping the current kernel
+    std::chrono::steady_clock::time_point deadline; // when that time is up
+
+    // partial mapping in the beam of BeamSelectAlter:
+    // the alternatives committed one after the other starting from the base past and future,
+    // each followed by mapping the gates that then don't need routing;
+    // an entry that is expanded holds the past and future resulting from its path, forked from its parent's,
+    // so that expanding it only commits the alternatives that follow on top of these
+    typedef struct
+    {
+        Alter               first;  // first alternative of the path, the one selected when this entry is best
+        Alter               last;   // last alternative of the path, committed on top of the parent's state
+        size_t              parent; // index of the entry in the previous beam that this entry extends
+        bool                isroot; // whether the path is empty; its state is the base past and future
+        std::shared_ptr<Past>   pastp;  // past after the path; only held when the entry is expanded
+        std::shared_ptr<Future> futurep;// future after the path, as pastp
+        std::list<ql::gate*>    lg;     // non-NN 2q gates remaining after the path, as pastp
+        double              score;  // resulting extension of the past relative to the base past
+        bool                done;   // whether no gates remained to be mapped after path
+        size_t              bytes;  // memory this entry occupies with its state, see BeamEntryBytes
+    } beamentry_t;
+
+                                    // Reset by Map, counted concurrently by the workers and copied to stats
+    std::atomic<size_t> statnalters;
+    std::atomic<size_t> statncheckpoints;
+    std::atomic<size_t> statnpastforks;
+    std::atomic<size_t> statnmapmappable;
+    std::mutex          statmutex;  // protects stats.levels
+
 public:
                                     // Passed back by Mapper::Map to caller for reporting
     size_t          nswapsadded;    // number of swaps added (including moves)
@@ -2919,6 +3651,7 @@ public:
     std::vector<int>    rs_ip;      // rs[real qubit index] -> {nostate|wasinited|hasstate}
     std::vector<size_t> v2r_out;    // v2r[virtual qubit index] -> real qubit index | UNDEFINED_QUBIT
     std::vector<int>    rs_out;     // rs[real qubit index] -> {nostate|wasinited|hasstate}
+    mapstats_t          stats;      // counters and timers, see mapstats_t
 
 
 // Mapper constructor is default synthesized
@@ -2926,8 +3659,7 @@ public:
 private:
 
 // initial path finder
-// generate paths with source src and target tgt as a list of path into resla;
-// this result list resla is allocated by caller and is empty on the call;
+// generate paths with source src and target tgt, and the alternatives derived from them;
 // which indicates which paths are generated; see below the enum whichpaths;
 // on top of this, the other mapper options apply
 typedef
@@ -2938,122 +3670,107 @@ enum {
     wp_leftright_shortest       // both the left and right shortest
 } whichpaths_t;
 
-// Find shortest paths between src and tgt in the grid, bounded by a particular strategy (which)
-void GenShortestPaths(ql::gate* gp, size_t src, size_t tgt, std::list<Alter> & resla, whichpaths_t which)
+// Find shortest paths from src to tgt in the grid, bounded by a particular strategy (which),
+// by a depth-first walk over the shortest-path DAG towards tgt;
+// path holds the path from the original source up to but excluding src;
+// each complete path is split at each of its hops (see Alter::Split) and the result appended to resla;
+// stop when maxalters alternatives have been generated, counted in nalters
+void GenShortestPaths(ql::gate* gp, const Grid::pathdag_t& dag, size_t src, size_t tgt, whichpaths_t which,
+        std::vector<size_t>& path, std::list<Alter>& resla, size_t& nalters, size_t maxalters)
 {
-    std::list<Alter> genla;    // list that will get the result of a recursive Gen call
-
     // DOUT("GenShortestPaths: " << "src=" << src << " tgt=" << tgt << " which=" << which);
-    MapperAssert (resla.empty());
+    path.push_back(src);
 
     if (src == tgt) {
         // found target
-        // create a virgin Alter and initialize it to become an empty path
-        // add src to this path (so that it becomes a distance 0 path with one qubit, src)
-        // and add the Alter to the result list 
+        // create a virgin Alter with the path found and add its split variations to the result list
         Alter  a;
         a.Init(platformp, kernelp);
         a.targetgp = gp;
-        a.Add2Front(src);
-        resla.push_back(a);
-        // a.DPRINT("... empty path after adding to result list");
-        // Alter::DPRINT("... result list after adding empty path", resla);
-        // DOUT("... will return now");
+        a.total = path;
+        nalters += a.Split(resla, maxalters - nalters);
+        // Alter::DPRINT("... result list after adding split path", resla);
+        path.pop_back();
         return;
     }
 
-    // start looking around at neighbors for serious paths
-    // assume that distance is not approximate but exact and can be met
-    size_t d = grid.Distance(src, tgt);
-    MapperAssert (d >= 1);
-
-    // reduce neighbors nbs to those continuing a shortest path
-    auto nbl = grid.nbs[src];
-    nbl.remove_if( [this,d,tgt](const size_t& n) { return grid.Distance(n,tgt) >= d; } );
-
-    // rotate neighbor list nbl such that largest difference between angles of adjacent elements is beyond back()
-    grid.Normalize(src, nbl);
-    // subset to those neighbors that continue in direction(s) we want
-    if (which == wp_left_shortest)
-    {
-        nbl.remove_if( [nbl](const size_t& n) { return n != nbl.front(); } );
-    }
-    else if (which == wp_right_shortest)
-    {
-        nbl.remove_if( [nbl](const size_t& n) { return n != nbl.back(); } );
-    }
-    else if (which == wp_leftright_shortest)
-    {
-        nbl.remove_if( [nbl](const size_t& n) { return n != nbl.front() && n != nbl.back(); } );
-    }
-
-    // std::cout << "... before iterating, nbl: ";
-    // for (auto dn : nbl) { std::cout << dn << " "; } std::cout << std::endl;
+    // the neighbors continuing a shortest path, rotated such that
+    // largest difference between angles of adjacent elements is beyond the last one
+    size_t  first = dag.offset[src];
+    size_t  last = dag.offset[src+1];   // one beyond
+    size_t  nsucc = last - first;
 
     // for all resulting neighbors, find all continuations of a shortest path
-    for (auto & n : nbl)
+    for (size_t i = first; i < last && nalters < maxalters; i++)
     {
+        size_t  n = dag.succ[i];
         whichpaths_t newwhich = which;
-        // but for each neighbor only look in desired direction, if any
-        if (which == wp_leftright_shortest && nbl.size() != 1)
+        // subset to those neighbors that continue in direction(s) we want
+        // and for each neighbor only look in desired direction, if any
+        if (which == wp_left_shortest && i != first)
+        {
+            continue;
+        }
+        else if (which == wp_right_shortest && i != last-1)
+        {
+            continue;
+        }
+        else if (which == wp_leftright_shortest && nsucc != 1)
         {
             // when looking both left and right still, and there is a choice now, split into left and right
-            if (n == nbl.front())
+            if (i == first)
             {
                 newwhich = wp_left_shortest;
             }
-            else
+            else if (i == last-1)
             {
                 newwhich = wp_right_shortest;
             }
+            else
+            {
+                continue;
+            }
         }
-        GenShortestPaths(gp, n, tgt, genla, newwhich);  // get list of possible paths from n to tgt in genla
-        resla.splice(resla.end(), genla);           // moves all of genla to resla; makes genla empty
-    }
-    // resla contains all paths starting from a neighbor of src, to tgt
-
-    // add src to front of all to-be-returned paths from src's neighbors to tgt
-    for (auto & a : resla)
-    {
-        // DOUT("... GenShortestPaths, about to add src=" << src << "in front of path");
-        a.Add2Front(src);
+        GenShortestPaths(gp, dag, n, tgt, newwhich, path, resla, nalters, maxalters);
     }
+    path.pop_back();
     // DOUT("... GenShortestPaths, returning from call of: " << "src=" << src << " tgt=" << tgt << " which=" << which);
 }
 
-// Generate shortest paths in the grid
+// Generate shortest paths in the grid and the alternatives derived from them, appending them to resla
 void GenShortestPaths(ql::gate* gp, size_t src, size_t tgt, std::list<Alter> & resla)
 {
     std::string mappathselectopt = ql::options::get("mappathselect");
+    whichpaths_t which;
     if ("all" == mappathselectopt)
     {
-        GenShortestPaths(gp, src, tgt, resla, wp_all_shortest);
+        which = wp_all_shortest;
     }
     else if ("borders" == mappathselectopt)
     {
-        GenShortestPaths(gp, src, tgt, resla, wp_leftright_shortest);
+        which = wp_leftright_shortest;
     }
     else
     {
         FATAL("Unknown value of mapppathselect option " << mappathselectopt);
     }
-}
 
-// split each path in the argument old Alter list
-// this gives all variations to put the two-qubit gate in the path
-// all possible Alters are returned in the result list resla
-void GenSplitPaths(std::list<Alter> & oldla, std::list<Alter> & resla)
-{
-    // DOUT("GenSplitPaths");
-    for (auto & a : oldla)
+    std::string mapmaxaltersopt = ql::options::get("mapmaxalters");
+    size_t  maxalters = atoi(mapmaxaltersopt.c_str());
+    if (maxalters == 0)
     {
-        a.Split(resla);
+        maxalters = MAX_CYCLE;
     }
-    // Alter::DPRINT("... after GenSplitPaths", resla);
+
+    auto    dagp = grid.ShortestPathDag(tgt);
+    std::vector<size_t> path;
+    size_t  nalters = 0;
+    GenShortestPaths(gp, *dagp, src, tgt, which, path, resla, nalters, maxalters);
 }
 
 // Generate all possible variations of making gp NN, starting from given past (with its mappings),
-// and return the found variations by appending them to the given list of Alters, la
+// and return the found variations by appending them to the given list of Alters, la;
+// these are all splits of all shortest paths, possibly limited in number by option mapmaxalters
 void GenAltersGate(ql::gate* gp, std::list<Alter>& la, Past& past)
 {
     auto&   q = gp->operands;
@@ -3064,11 +3781,27 @@ void GenAltersGate(ql::gate* gp, std::list<Alter>& la, Past& past)
     DOUT("GenAltersGate: " << gp->qasm() << " in real (q" << src << ",q" << tgt << ") at distance=" << d );
     past.DFcPrint();
 
-    std::list<Alter> directla;  // list that will hold all Alters directly from src to tgt
-    GenShortestPaths(gp, src, tgt, directla);// find shortest paths directly from src to tgt, without split
-    // Alter::DPRINT("... after GenShortestPaths", directla);
-    GenSplitPaths(directla, la);  // split each: 2q gate can be put at each hop in each direct path
-    // Alter::DPRINT("... after GenSplitPaths", la);
+    // find shortest paths directly from src to tgt and split each: 2q gate can be put at each hop in each path
+    GenShortestPaths(gp, src, tgt, la);
+    // Alter::DPRINT("... after GenShortestPaths", la);
+}
+
+// seconds elapsed since t1
+static double Seconds(std::chrono::high_resolution_clock::time_point t1)
+{
+    std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - t1;
+    return d.count();
+}
+
+// count a SelectAlter call or beam level at recursion level level
+void CountLevel(int level)
+{
+    std::lock_guard<std::mutex> lock(statmutex);
+    if (stats.levels.size() <= size_t(level))
+    {
+        stats.levels.resize(level+1, 0);
+    }
+    stats.levels[level]++;
 }
 
 // Generate all possible variations of making gates in lg NN, starting from given past (with its mappings),
@@ -3076,6 +3809,7 @@ void GenAltersGate(ql::gate* gp, std::list<Alter>& la, Past& past)
 // Depending on maplookahead only take first (most critical) gate or take all gates.
 void GenAlters(std::list<ql::gate*> lg, std::list<Alter>& la, Past& past)
 {
+    size_t  nla = la.size();
     std::string maplookaheadopt = ql::options::get("maplookahead");
     if ("all" == maplookaheadopt)
     {
@@ -3095,6 +3829,7 @@ void GenAlters(std::list<ql::gate*> lg, std::list<Alter>& la, Past& past)
         // DOUT("GenAlters, " << lg.size() << " 2q gates; take first: " << gp->qasm());
         GenAltersGate(gp, la, past);  // gen all possible variations to make gp NN, in current v2r mapping ("past")
     }
+    statnalters += la.size() - nla;
 }
 
 // start the random generator with a seed
@@ -3107,10 +3842,10 @@ void RandomInit()
 }
 
 // if the maptiebreak option indicates so,
-// generate a random int number in range 0..count-1 and use
+// generate a random int number in range 0..count-1 using rgen and use
 // that to index in list of alternatives and to return that one,
 // otherwise return a fixed one (front, back or first most critical one
-Alter ChooseAlter(std::list<Alter>& la, Future& future)
+Alter ChooseAlter(std::list<Alter>& la, Future& future, std::mt19937& rgen)
 {
     if (la.size() == 1)
     {
@@ -3139,21 +3874,19 @@ Alter ChooseAlter(std::list<Alter>& la, Future& future)
     }
     if ("random" == maptiebreakopt)
     {
-        Alter res;
         std::uniform_int_distribution<> dis(0, (la.size()-1));
-        size_t choice = dis(gen);
+        size_t choice = dis(rgen);
         size_t i = 0;
         for (auto& a : la)
         {
             if (i == choice)
             {
-                res = a;
-                break;
+                // DOUT(" ... took random draw " << choice << " from 0.." << (la.size()-1));
+                return a;
             }
             i++;
         }
-        // DOUT(" ... took random draw " << choice << " from 0.." << (la.size()-1));
-        return res;
+        return la.front();
     }
     if ("last" == maptiebreakopt)
     {
@@ -3237,6 +3970,7 @@ bool MapMappableGates(Future& future, Past& past, std::list<ql::gate*>& lg, bool
     DOUT("MapMappableGates entry");
     while (1)
     {
+        statnmapmappable++;
         if (future.GetNonQuantumGates(nonqlg))
         {
             // avlist contains non-quantum gates
@@ -3336,6 +4070,73 @@ bool MapMappableGates(Future& future, Past& past, std::list<ql::gate*>& lg, bool
     }
 }
 
+// whether alternatives at the given recursion level are evaluated in parallel;
+// only done at level 0, since below that the workers are already occupied
+bool IsParallel(int level, size_t nalters)
+{
+    return level == 0 && poolp && poolp->size() > 1 && nalters > 1;
+}
+
+// evaluate alternative a of the given recursion level by looking ahead:
+// commit it to past and future, map the gates that then become mappable,
+// and recurse on the alternatives of the next non-NN 2q gates to find the extension it eventually leads to;
+// this extension is left in a.score; past and future are checkpointed first and rolled back at the end
+void LookaheadAlter(Alter& a, Future& future, Past& past, size_t baseMaxFreeCycle, int level, std::mt19937& rgen)
+{
+    a.DPRINT("... ... considering alternative:");
+    future.Checkpoint();                // rolled back below, after evaluating the alternative
+    past.Checkpoint();
+    statncheckpoints++;
+    CommitAlter(a, future, past);
+    a.DPRINT("... ... committed this alternative first before recursion:");
+
+    bool    havegates;                  // are there still non-NN 2q gates to map?
+    std::list<ql::gate*> lg;            // list of non-NN 2q gates taken from avlist, as returned from MapMappableGates
+    std::string maplookaheadopt = ql::options::get("maplookahead");
+    std::string maprecNN2qopt = ql::options::get("maprecNN2q");
+    // In recursion, look at option maprecNN2q:
+    // - MapMappableGates with alsoNN2q==true is greedy and immediately maps each 1q and NN 2q gate
+    // - MapMappableGates with alsoNN2q==false is not greedy, maps all 1q gates but not the (NN) 2q gates
+    //
+    // when yes and when maplookaheadopt is noroutingfirst or all, let MapMappableGates stop mapping only on nonNN2q
+    // when no, let MapMappableGates stop mapping on any 2q
+    // This creates more clear recursion: one 2q at a time instead of a possible empty set of NN2qs followed by a nonNN2q;
+    // also when a NN2q is found, this is perfect; this is not seen when immediately mapping all NN2qs.
+    // So goal is to prove that maprecNN2q should be no at this place, in the recursion step, but not at level 0!
+    bool alsoNN2q = ("yes" == maprecNN2qopt) && ( "noroutingfirst" == maplookaheadopt || "all" == maplookaheadopt );
+    havegates = MapMappableGates(future, past, lg, alsoNN2q); // map all easy gates; remainder returned in lg
+
+    if (havegates)
+    {
+        // DOUT("... ... SelectAlter level=" << level << ", committed + mapped easy gates, now facing " << lg.size() << " 2q gates to evaluate next");
+        std::list<Alter> la;                // list that will hold all variations, as returned by GenAlters
+        GenAlters(lg, la, past);            // gen all possible variations to make gates in lg NN, in current past.v2r mapping
+        // DOUT("... ... SelectAlter level=" << level << ", generated for these 2q gates " << la.size() << " alternatives; RECURSE ... ");
+        Alter resa;                         // result alternative selected and returned by next SelectAlter call
+        SelectAlter(la, resa, future, past, baseMaxFreeCycle, level+1, rgen); // recurse, best in resa ...
+        resa.DPRINT("... ... SelectAlter, generated for these 2q gates ... ; RECURSE DONE; resulting alternative ");
+        a.score = resa.score;               // extension of deep recursion is treated as extension at current level,
+                                            // by this an alternative started bad may be compensated by deeper alts
+    }
+    else
+    {
+        // DOUT("... ... SelectAlter level=" << level << ", no gates to evaluate next; RECURSION BOTTOM");
+        auto mapperopt = ql::options::get("mapper");
+        if ("maxfidelity" == mapperopt)
+        {
+            a.score = past.QuickFidelity();
+        }
+        else
+        {
+            a.score = past.MaxFreeCycle() - baseMaxFreeCycle;
+        }
+        a.DPRINT("... ... SelectAlter, after committing this alternative, mapped easy gates, no gates to evaluate next; RECURSION BOTTOM");
+    }
+    past.Rollback();
+    future.Rollback();
+    a.DPRINT("... ... DONE considering alternative:");
+}
+
 // select Alter determined by strategy defined by mapper options
 // - if base[rc], select from whole list of Alters, of which all 'remain'
 // - if minextend[rc], select Alter from list of Alters with minimal cycle extension of given past
@@ -3343,8 +4144,12 @@ bool MapMappableGates(Future& future, Past& past, std::list<ql::gate*>& lg, bool
 //   - level: level of recursion at which SelectAlter is called: 0 is base, 1 is 1st, etc.
 //   - option mapselectmaxlevel: max level of recursion to use, where inf indicates no maximum
 // - maptiebreak option indicates which one to take when several (still) remain
+// alternatives are evaluated on past and future themselves, between a Checkpoint and a Rollback of both,
+// so on return past and future are unchanged; extensions are relative to baseMaxFreeCycle,
+// the MaxFreeCycle of the base past at the bottom of the recursion
+// rgen is the random generator used by ChooseAlter
 // result is returned in resa
-void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past, Past& basePast, int level)
+void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past, size_t baseMaxFreeCycle, int level, std::mt19937& rgen)
 {
                                 // la are all alternatives we enter with
     MapperAssert(!la.empty());  // so there is always a result Alter
@@ -3353,24 +4158,55 @@ void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past,
     std::list<Alter> bla;       // best alternative subset of gla, suitable to choose result from
 
     DOUT("SelectAlter ENTRY level=" << level << " from " << la.size() << " alternatives");
+    CountLevel(level);
     auto mapperopt = ql::options::get("mapper");
     if (mapperopt == "base"|| mapperopt == "baserc")
     {
         Alter::DPRINT("... SelectAlter base (equally good/best) alternatives:", la);
-        resa = ChooseAlter(la, future);
+        resa = ChooseAlter(la, future, rgen);
         resa.DPRINT("... the selected Alter is");
         // DOUT("SelectAlter DONE level=" << level << " from " << la.size() << " alternatives");
         return;
     }
     MapperAssert(mapperopt == "minextend" || mapperopt == "minextendrc" || mapperopt == "maxfidelity");
 
-    // Compute a.score of each alternative relative to basePast, and sort la on it, minimum first
-    for (auto & a : la)
+    // Prepare for recursion, also to know whether forking for a parallel evaluation will pay off;
+    // option mapselectmaxlevel indicates the maximum level of recursion (0 is no recursion)
+    auto mapselectmaxlevelstring = ql::options::get("mapselectmaxlevel");
+    int  mapselectmaxlevel = ("inf" == mapselectmaxlevelstring) ?  MAX_CYCLE : atoi(mapselectmaxlevelstring.c_str());
+
+    // Compute a.score of each alternative relative to the base past, and sort la on it, minimum first;
+    // in parallel only when recursion follows, since only then evaluation outweighs forking past and future
+    if (level < mapselectmaxlevel && IsParallel(level, la.size()))
+    {
+        std::vector<Alter*> vla;
+        for (auto & a : la)
+        {
+            vla.push_back(&a);
+        }
+        std::vector<Past>   wpast(poolp->size());
+        std::vector<int>    forked(poolp->size(), 0);
+        poolp->parallel_for(vla.size(), [&](size_t i, size_t w)
+        {
+            if (!forked[w])
+            {
+                wpast[w].Fork(past, &workerkernels[w]);
+                forked[w] = 1;
+                statnpastforks++;
+            }
+            vla[i]->Extend(wpast[w], baseMaxFreeCycle);
+        });
+    }
+    else
     {
-        a.DPRINT("Considering extension by alternative: ...");
-        a.Extend(past, basePast);           // locally here, past will be cloned and kept in alter
-                                            // and the extension stored into the a.score
+        for (auto & a : la)
+        {
+            a.DPRINT("Considering extension by alternative: ...");
+            a.Extend(past, baseMaxFreeCycle);   // locally here, past will be extended and rolled back
+                                                // and the extension stored into the a.score
+        }
     }
+    statncheckpoints += la.size();
     la.sort([this](const Alter &a1, const Alter &a2) { return a1.score < a2.score; });
     Alter::DPRINT("... SelectAlter sorted all entry alternatives after extension:", la);
 
@@ -3419,11 +4255,6 @@ void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past,
     // DOUT("SelectAlter mapselectmaxwidth=" << mapselectmaxwidthopt << " level=" << level << " reduced la to gla");
     Alter::DPRINT("... SelectAlter good alternatives before recursion:", gla);
 
-    // Prepare for recursion;
-    // option mapselectmaxlevel indicates the maximum level of recursion (0 is no recursion)
-    auto mapselectmaxlevelstring = ql::options::get("mapselectmaxlevel");
-    int  mapselectmaxlevel = ("inf" == mapselectmaxlevelstring) ?  MAX_CYCLE : atoi(mapselectmaxlevelstring.c_str());
-
     // When maxlevel has been reached, stop the recursion, and choose from the best minextend/maxfidelity alternatives
     if (level >= mapselectmaxlevel)
     {
@@ -3432,7 +4263,7 @@ void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past,
         bla = gla;
         bla.remove_if( [this,gla](const Alter& a) { return a.score != gla.front().score; } );
         Alter::DPRINT("... SelectAlter reduced to best alternatives to choose result from:", bla);
-        resa = ChooseAlter(bla, future);
+        resa = ChooseAlter(bla, future, rgen);
         resa.DPRINT("... the selected Alter (STOPPING RECURSION) is");
         // DOUT("SelectAlter DONE level=" << level << " from " << bla.size() << " best alternatives");
         return;
@@ -3443,7 +4274,7 @@ void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past,
     //
     // For each alternative in gla,
     // lookahead for next non-NN2q gates, and comparing them for their alternative mappings;
-    // the lookahead alternative with the least overall extension (i.e. relative to basePast) is chosen,
+    // the lookahead alternative with the least overall extension (i.e. relative to the base past) is chosen,
     // and the current alternative on top of which it was build
     // is chosen at the current level, unwinding the recursion.
     //
@@ -3453,62 +4284,48 @@ void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past,
     // - end-of-circuit (no non-NN 2q gates remain).
     //
     // When gla.size() == 1, we still want to know its minimum extension, to compare with competitors,
-    // since that is not just a local figure but the extension from basePast;
+    // since that is not just a local figure but the extension from the base past;
     // so indeed with only one alternative we may still go into recursion below.
     // This means that recursion always goes to maxlevel or end-of-circuit.
     // This anomaly may need correction.
     // DOUT("... SelectAlter level=" << level << " entering recursion with " << gla.size() << " good alternatives");
+    //
+    // The alternatives are independent so with more than one worker thread (option mapper_threads),
+    // at level 0 they are evaluated in parallel, each worker on its own fork of past and future;
+    // each alternative gets its own random generator, seeded here in list order,
+    // so that the scores and thus the selection don't depend on the number of threads.
+    std::vector<Alter*>     vgla;
+    std::vector<std::mt19937::result_type> seeds;
     for (auto& a : gla)
     {
-        a.DPRINT("... ... considering alternative:");
-        Future future_copy = future;            // copy!
-        Past   past_copy = past;                // copy!
-        CommitAlter(a, future_copy, past_copy);
-        a.DPRINT("... ... committed this alternative first before recursion:");
-
-        bool    havegates;                  // are there still non-NN 2q gates to map?
-        std::list<ql::gate*> lg;            // list of non-NN 2q gates taken from avlist, as returned from MapMappableGates
-        std::string maplookaheadopt = ql::options::get("maplookahead");
-        std::string maprecNN2qopt = ql::options::get("maprecNN2q");
-        // In recursion, look at option maprecNN2q:
-        // - MapMappableGates with alsoNN2q==true is greedy and immediately maps each 1q and NN 2q gate
-        // - MapMappableGates with alsoNN2q==false is not greedy, maps all 1q gates but not the (NN) 2q gates
-        //
-        // when yes and when maplookaheadopt is noroutingfirst or all, let MapMappableGates stop mapping only on nonNN2q
-        // when no, let MapMappableGates stop mapping on any 2q
-        // This creates more clear recursion: one 2q at a time instead of a possible empty set of NN2qs followed by a nonNN2q;
-        // also when a NN2q is found, this is perfect; this is not seen when immediately mapping all NN2qs.
-        // So goal is to prove that maprecNN2q should be no at this place, in the recursion step, but not at level 0!
-        bool alsoNN2q = ("yes" == maprecNN2qopt) && ( "noroutingfirst" == maplookaheadopt || "all" == maplookaheadopt );
-        havegates = MapMappableGates(future_copy, past_copy, lg, alsoNN2q); // map all easy gates; remainder returned in lg
-
-        if (havegates)
-        {
-            // DOUT("... ... SelectAlter level=" << level << ", committed + mapped easy gates, now facing " << lg.size() << " 2q gates to evaluate next");
-            std::list<Alter> la;                // list that will hold all variations, as returned by GenAlters
-            GenAlters(lg, la, past_copy);       // gen all possible variations to make gates in lg NN, in current past.v2r mapping
-            // DOUT("... ... SelectAlter level=" << level << ", generated for these 2q gates " << la.size() << " alternatives; RECURSE ... ");
-            Alter resa;                         // result alternative selected and returned by next SelectAlter call
-            SelectAlter(la, resa, future_copy, past_copy, basePast, level+1); // recurse, best in resa ...
-            resa.DPRINT("... ... SelectAlter, generated for these 2q gates ... ; RECURSE DONE; resulting alternative ");
-            a.score = resa.score;               // extension of deep recursion is treated as extension at current level,
-                                                // by this an alternative started bad may be compensated by deeper alts
-        }
-        else
+        vgla.push_back(&a);
+        seeds.push_back(rgen());
+    }
+    if (IsParallel(level, vgla.size()))
+    {
+        std::vector<Past>   wpast(poolp->size());
+        std::vector<Future> wfuture(poolp->size());
+        std::vector<int>    forked(poolp->size(), 0);
+        poolp->parallel_for(vgla.size(), [&](size_t i, size_t w)
         {
-            // DOUT("... ... SelectAlter level=" << level << ", no gates to evaluate next; RECURSION BOTTOM");
-            auto mapperopt = ql::options::get("mapper");
-            if ("maxfidelity" == mapperopt)
+            if (!forked[w])
             {
-                a.score = ql::quick_fidelity(past_copy.lg);
+                wpast[w].Fork(past, &workerkernels[w]);
+                wfuture[w] = future;
+                forked[w] = 1;
+                statnpastforks++;
             }
-            else
-            {
-                a.score = past_copy.MaxFreeCycle() - basePast.MaxFreeCycle();
-            }
-            a.DPRINT("... ... SelectAlter, after committing this alternative, mapped easy gates, no gates to evaluate next; RECURSION BOTTOM");
+            std::mt19937    agen(seeds[i]);
+            LookaheadAlter(*vgla[i], wfuture[w], wpast[w], baseMaxFreeCycle, level, agen);
+        });
+    }
+    else
+    {
+        for (size_t i = 0; i < vgla.size(); i++)
+        {
+            std::mt19937    agen(seeds[i]);
+            LookaheadAlter(*vgla[i], future, past, baseMaxFreeCycle, level, agen);
         }
-        a.DPRINT("... ... DONE considering alternative:");
     }
     // Sort list of good alternatives (gla) on score resulting after recursion
     gla.sort([this](const Alter &a1, const Alter &a2) { return a1.score < a2.score; });
@@ -3519,18 +4336,268 @@ void SelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past,
     bla = gla;
     bla.remove_if( [this,gla](const Alter& a) { return a.score != gla.front().score; } );
     Alter::DPRINT("... SelectAlter equally best alternatives on return of RECURSION:", bla);
-    resa = ChooseAlter(bla, future);
+    resa = ChooseAlter(bla, future, rgen);
     resa.DPRINT("... the selected Alter is");
     // DOUT("... SelectAlter level=" << level << " selecting from " << bla.size() << " equally good alternatives above DONE");
     DOUT("SelectAlter DONE level=" << level << " from " << la.size() << " alternatives");
 }
 
+// memory occupied by a beam entry, to compare against option mapbeammemory;
+// past and future are its state: either the one it holds, or the one it would hold when forked from these
+static size_t BeamEntryBytes(const beamentry_t& e, const Past& past, const Future& future)
+{
+    return sizeof(beamentry_t) + e.lg.size() * (sizeof(ql::gate*) + 2 * sizeof(void*))
+        + past.Bytes() + future.Bytes();
+}
+
+// expand beam entry e, with index ei in the beam, into its children, i.e. e's path extended by each of the alternatives
+// that then follow (for the root, rootla are these); each child alternative is committed on top of e's state,
+// the gates that then don't need routing are mapped, and the resulting extension relative to baseMaxFreeCycle
+// is the child's score; e's state is checkpointed first and rolled back at the end, so on return it is unchanged;
+// gates are created in kernel k;
+// when interruptible and the mapbeamtime budget is used up, this stops early and returns false
+bool ExpandBeamEntry(beamentry_t& e, size_t ei, const std::list<Alter>& rootla, size_t baseMaxFreeCycle, bool alsoNN2q, bool interruptible, ql::quantum_kernel *k, std::vector<beamentry_t>& children)
+{
+    Past&   past = *e.pastp;
+    Future& future = *e.futurep;
+    past.SetKernel(k);
+
+    std::list<Alter> la;                // the alternatives following e's path, as returned by GenAlters
+    if (e.isroot)
+    {
+        la = rootla;
+    }
+    else
+    {
+        GenAlters(e.lg, la, past);
+    }
+
+    for (auto & a : la)
+    {
+        if (interruptible && hasbudget && std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        future.Checkpoint();
+        past.Checkpoint();
+        statncheckpoints++;
+        Alter   ca = a;
+        CommitAlter(ca, future, past);
+        beamentry_t child;
+        child.done = !MapMappableGates(future, past, child.lg, alsoNN2q);
+        child.score = past.MaxFreeCycle() - baseMaxFreeCycle;
+        a.score = child.score;
+        a.didscore = true;
+        child.first = (e.isroot ? a : e.first);
+        child.last = a;
+        child.parent = ei;
+        child.isroot = false;
+        child.bytes = BeamEntryBytes(child, past, future);
+        child.lg.clear();               // the state is only held after forking it, see ForkBeamEntry
+        children.push_back(child);
+        past.Rollback();
+        future.Rollback();
+    }
+    return true;
+}
+
+// give beam entry e the state after its path: a fork of the state of its parent p, with e.last committed on top
+// and the gates that then don't need routing mapped; gates are created in kernel k;
+// the fork is checkpointed, so that gates done from its future are journaled and don't refill the shared graph window
+void ForkBeamEntry(beamentry_t& e, const beamentry_t& p, bool alsoNN2q, ql::quantum_kernel *k)
+{
+    e.pastp = std::make_shared<Past>();
+    e.pastp->Fork(*p.pastp, k);
+    e.futurep = std::make_shared<Future>();
+    e.futurep->Fork(*p.futurep);
+    e.pastp->Checkpoint();
+    e.futurep->Checkpoint();
+    statnpastforks++;
+    Alter   ca = e.last;
+    CommitAlter(ca, *e.futurep, *e.pastp);
+    e.lg.clear();
+    MapMappableGates(*e.futurep, *e.pastp, e.lg, alsoNN2q);
+    e.bytes = BeamEntryBytes(e, *e.pastp, *e.futurep);
+}
+
+// select Alter from la using a beam search, with option mapper=beam
+// - the beam holds at most mapbeamwidth partial mappings (beamentry_t), initially the one with an empty path
+// - each level, each unfinished entry is expanded with all alternatives following it (ExpandBeamEntry);
+//   the children and finished entries are sorted on score, minimum first, and the beam is cut to the best ones;
+//   the unfinished entries of the new beam get their own state (ForkBeamEntry) to be expanded from in the next level
+// - this stops after mapselectmaxlevel levels (inf: until end-of-circuit), or when all entries finished,
+//   or when the time budget of option mapbeamtime for the current kernel has been used up;
+//   the budget is checked during expansion too, and a level that is interrupted is left out;
+//   level 0 is always completed to always have a result
+// - the beam is also cut when its size with the states of its entries would exceed option mapbeammemory megabytes
+//   (keeping at least one)
+// maptiebreak chooses from the first alternatives of the equally best entries; result is returned in resa
+//
+// Unlike SelectAlter, which recurses depth-first on all alternatives found equally good,
+// the work per level is bounded by mapbeamwidth times the number of alternatives per gate;
+// since each entry holds its state, expanding it doesn't depend on the length of its path.
+// When more than one worker thread is available, the entries of a level are expanded in parallel,
+// as are the forks of their states; children are combined in entry order for determinism.
+void BeamSelectAlter(std::list<Alter>& la, Alter & resa, Future& future, Past& past)
+{
+    MapperAssert(!la.empty());  // so there is always a result Alter
+    DOUT("BeamSelectAlter ENTRY from " << la.size() << " alternatives");
+
+    size_t  beamwidth = atoi(ql::options::get("mapbeamwidth").c_str());
+    if (beamwidth == 0)
+    {
+        beamwidth = 1;
+    }
+    auto mapselectmaxlevelstring = ql::options::get("mapselectmaxlevel");
+    int  mapselectmaxlevel = ("inf" == mapselectmaxlevelstring) ?  MAX_CYCLE : atoi(mapselectmaxlevelstring.c_str());
+    size_t  maxbytes = size_t(atoi(ql::options::get("mapbeammemory").c_str())) * 1024 * 1024;
+    std::string maplookaheadopt = ql::options::get("maplookahead");
+    std::string maprecNN2qopt = ql::options::get("maprecNN2q");
+    bool alsoNN2q = ("yes" == maprecNN2qopt) && ( "noroutingfirst" == maplookaheadopt || "all" == maplookaheadopt );
+    size_t  baseMaxFreeCycle = past.MaxFreeCycle();
+
+    std::vector<beamentry_t>    beam;
+    beamentry_t root;
+    root.parent = 0;
+    root.isroot = true;
+    root.pastp = std::shared_ptr<Past>(&past, [](Past*){});         // not owned: the base state
+    root.futurep = std::shared_ptr<Future>(&future, [](Future*){});
+    root.score = 0;
+    root.done = false;
+    root.bytes = 0;
+    beam.push_back(root);
+
+    for (int level = 0; ; level++)
+    {
+        CountLevel(level);
+
+        // expand the unfinished entries, keeping the finished ones as they are
+        std::vector<std::vector<beamentry_t>>   children(beam.size());
+        std::vector<size_t> toexpand;
+        for (size_t i = 0; i < beam.size(); i++)
+        {
+            if (beam[i].done)
+            {
+                children[i].push_back(beam[i]);
+            }
+            else
+            {
+                toexpand.push_back(i);
+            }
+        }
+        bool    interruptible = (level > 0);
+        std::vector<int>    complete(beam.size(), 1);
+        if (IsParallel(0, toexpand.size()))
+        {
+            poolp->parallel_for(toexpand.size(), [&](size_t i, size_t w)
+            {
+                size_t  j = toexpand[i];
+                complete[j] = ExpandBeamEntry(beam[j], j, la, baseMaxFreeCycle, alsoNN2q, interruptible, &workerkernels[w], children[j]);
+            });
+        }
+        else
+        {
+            for (auto j : toexpand)
+            {
+                complete[j] = ExpandBeamEntry(beam[j], j, la, baseMaxFreeCycle, alsoNN2q, interruptible, kernelp, children[j]);
+            }
+        }
+        if (std::find(complete.begin(), complete.end(), 0) != complete.end())
+        {
+            DOUT("... BeamSelectAlter level=" << level << ": mapbeamtime budget used up during expansion, keeping the previous beam");
+            break;
+        }
+
+        // the best of these, as far as width and memory allow, form the next beam
+        std::vector<beamentry_t>    candidates;
+        for (auto & c : children)
+        {
+            candidates.insert(candidates.end(), c.begin(), c.end());
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+            [](const beamentry_t& e1, const beamentry_t& e2) { return e1.score < e2.score; });
+        size_t  keep = 0;
+        size_t  bytes = 0;
+        while (keep < candidates.size() && keep < beamwidth)
+        {
+            bytes += candidates[keep].bytes;
+            if (maxbytes != 0 && keep > 0 && bytes > maxbytes)
+            {
+                DOUT("... BeamSelectAlter level=" << level << ": mapbeammemory reached, beam cut to " << keep << " entries");
+                break;
+            }
+            keep++;
+        }
+        candidates.resize(keep);
+
+        bool alldone = true;
+        for (auto & e : candidates)
+        {
+            alldone = alldone && e.done;
+        }
+        bool more = !alldone && level < mapselectmaxlevel;
+        if (more && hasbudget && std::chrono::steady_clock::now() >= deadline)
+        {
+            DOUT("... BeamSelectAlter level=" << level << ": mapbeamtime budget used up, stopping");
+            more = false;
+        }
+
+        // only the entries to be expanded in the next level need their state
+        if (more)
+        {
+            std::vector<size_t> tofork;
+            for (size_t i = 0; i < candidates.size(); i++)
+            {
+                if (!candidates[i].done)
+                {
+                    tofork.push_back(i);
+                }
+            }
+            if (IsParallel(0, tofork.size()))
+            {
+                poolp->parallel_for(tofork.size(), [&](size_t i, size_t w)
+                {
+                    beamentry_t&    c = candidates[tofork[i]];
+                    ForkBeamEntry(c, beam[c.parent], alsoNN2q, &workerkernels[w]);
+                });
+            }
+            else
+            {
+                for (auto i : tofork)
+                {
+                    ForkBeamEntry(candidates[i], beam[candidates[i].parent], alsoNN2q, kernelp);
+                }
+            }
+        }
+        beam.swap(candidates);
+        DOUT("... BeamSelectAlter level=" << level << ": beam of " << beam.size() << " entries, best score=" << beam.front().score);
+        if (!more)
+        {
+            break;
+        }
+    }
+
+    // choose from the first alternatives of the equally best entries
+    std::list<Alter> bla;
+    for (auto & e : beam)
+    {
+        if (e.score == beam.front().score)
+        {
+            bla.push_back(e.first);
+        }
+    }
+    Alter::DPRINT("... BeamSelectAlter first alternatives of equally best entries:", bla);
+    resa = ChooseAlter(bla, future, gen);
+    resa.DPRINT("... the selected Alter is");
+    DOUT("BeamSelectAlter DONE from " << la.size() << " alternatives");
+}
+
 // Given the states of past and future
 // map all mappable gates and find the non-mappable ones
 // for those evaluate what to do next and do it;
-// during recursion, comparison is done with the base past (bottom of recursion stack),
-// and past is the last past (top of recursion stack) relative to which the mapping is done.
-void MapGates(Future& future, Past& past, Past& basePast)
+// during recursion, comparison is done with the past as it is here (bottom of recursion stack),
+// while past is extended in place (top of recursion stack) and rolled back after evaluating each alternative.
+void MapGates(Future& future, Past& past)
 {
     std::list<ql::gate*>   lg;              // list of non-mappable gates taken from avlist, as returned from MapMappableGates
     std::string maplookaheadopt = ql::options::get("maplookahead");
@@ -3543,12 +4610,23 @@ void MapGates(Future& future, Past& past, Past& basePast)
 
         // generate all variations
         std::list<Alter> la;                // list that will hold all variations, as returned by GenAlters
+        auto t1 = std::chrono::high_resolution_clock::now();
         GenAlters(lg, la, past);            // gen all possible variations to make gates in lg NN, in current past.v2r mapping
+        stats.genalterstime += Seconds(t1);
     
         // select best one
         Alter resa;
-        SelectAlter(la, resa, future, past, basePast, 0);
+        t1 = std::chrono::high_resolution_clock::now();
+        if ("beam" == ql::options::get("mapper"))
+        {
+            BeamSelectAlter(la, resa, future, past);
+        }
+        else
+        {
+            SelectAlter(la, resa, future, past, past.MaxFreeCycle(), 0, gen);
                                             // select one according to strategy specified by options; result in resa
+        }
+        stats.selectaltertime += Seconds(t1);
     
         // commit to best one
         // add all or just one swap, as described by resa, to THIS past, and schedule them/it in
@@ -3565,14 +4643,29 @@ void MapCircuit(ql::quantum_kernel& kernel, Virt2Real& v2r)
 
     future.Init(platformp);
     future.SetCircuit(kernel, sched, nq, nc); // constructs depgraph, initializes avlist, ready for producing gates
-    kernel.c.clear();       // future has copied kernel.c to private data; kernel.c ready for use by new_gate
+    kernel.c.clear();       // future has copied or moved kernel.c to private data; kernel.c ready for use by new_gate
     kernelp = &kernel;      // keep kernel to call kernelp->gate() inside Past.new_gate(), to create new gates
 
-    mainPast.Init(platformp, kernelp);  // mainPast and Past clones inside Alters ready for generating output schedules into
+    mainPast.Init(platformp, kernelp);  // mainPast ready for generating output schedules into
     mainPast.ImportV2r(v2r);    // give it the current mapping/state
+
+    std::string mapbeamtimeopt = ql::options::get("mapbeamtime");
+    hasbudget = (0 != atoi(mapbeamtimeopt.c_str()));
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(atoi(mapbeamtimeopt.c_str()));
+
+    workerkernels.clear();      // each worker evaluating alternatives in parallel creates its gates in a private kernel
+    if (poolp->size() > 1)
+    {
+        for (size_t w = 0; w < poolp->size(); w++)
+        {
+            workerkernels.push_back(kernel);
+            workerkernels.back().arena = std::make_shared<ql::gate_arena_t>();  // a copy would share kernel's arena
+            kernel.arena->adopt(workerkernels.back().arena);
+        }
+    }
     // mainPast.DPRINT("start mapping");
 
-    MapGates(future, mainPast, mainPast);
+    MapGates(future, mainPast);
     mainPast.FlushAll();
 
     // mainPast.DPRINT("end mapping");
@@ -3620,47 +4713,40 @@ void MakePrimitives(ql::quantum_kernel& kernel)
 // alternative bundler using gate->cycle attribute instead of lemon's cycle map
 // it assumes that the gate->cycle attribute reflect the cycle assignment of a particular schedule
 // independent entry in mapper class
-ql::ir::bundles_t Bundler(ql::quantum_kernel& kernel)
+ql::ir::flat_bundles_t Bundler(ql::quantum_kernel& kernel)
 {
-    ql::ir::bundles_t bundles;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    ql::ir::flat_bundles_t bundles;
 
     typedef std::vector<ql::gate*> insInOneCycle;
     std::map<size_t,insInOneCycle> insInAllCycles;
 
     // DOUT("Bundler ...");
-    size_t TotalCycles = 0;
     for ( auto & gp : kernel.c)
     {
         if( gp->type() != ql::gate_type_t::__wait_gate__ )
         {
             insInAllCycles[gp->cycle].push_back( gp );
-            TotalCycles = std::max(TotalCycles, gp->cycle);
         }
     }
 
-    for(size_t currCycle=0; currCycle<=TotalCycles; ++currCycle)
+    // insInAllCycles is ordered by cycle, so a bundle is made for each cycle with gates, in order
+    bundles.reserve(kernel.c.size());
+    for (auto & cycleIns : insInAllCycles)
     {
-        auto it = insInAllCycles.find(currCycle);
-        ql::ir::bundle_t abundle;
-        abundle.start_cycle = currCycle;
         size_t bduration = 0;
-        if( it != insInAllCycles.end() )
+        bundles.add_bundle(cycleIns.first, 0);
+        for (auto & ins : cycleIns.second)
         {
-            auto nInsThisCycle = insInAllCycles[currCycle].size();
-            for(size_t i=0; i<nInsThisCycle; ++i )
-            {
-                ql::ir::section_t asec;
-                auto & ins = insInAllCycles[currCycle][i];
-                asec.push_back(ins);
-                abundle.parallel_sections.push_back(asec);
-                size_t iduration = ins->duration;
-                bduration = std::max(bduration, iduration);
-            }
-            abundle.duration_in_cycles = (bduration+cycle_time-1)/cycle_time; 
-            bundles.push_back(abundle);
+            bundles.add_section();
+            bundles.add_gate(ins);
+            size_t iduration = ins->duration;
+            bduration = std::max(bduration, iduration);
         }
+        bundles.duration_in_cycles.back() = (bduration+cycle_time-1)/cycle_time; 
     }
 
+    stats.bundlertime += Seconds(t1);
     // DOUT("Bundler [DONE]");
     return bundles;
 }
@@ -3675,6 +4761,12 @@ void Map(ql::quantum_kernel& kernel)
 
     Virt2Real   v2r;            // current mapping while mapping this kernel
 
+    stats = mapstats_t();       // all counters and timers 0
+    statnalters = 0;
+    statncheckpoints = 0;
+    statnpastforks = 0;
+    statnmapmappable = 0;
+
     // unify all incoming v2rs into v2r to compute kernel input mapping;
     // but until inter-kernel mapping is implemented, take program initial mapping for it
     v2r.Init(nq);               // v2r now contains program initial mapping
@@ -3684,22 +4776,29 @@ void Map(ql::quantum_kernel& kernel)
     v2r.Export(rs_in);   // from v2r to caller for reporting
 
     std::string initialplaceopt = ql::options::get("initialplace");
-    if("no" != initialplaceopt)
-    {
 #ifdef INITIALPLACE
+    bool haveplacer = true;
+#else // ifdef INITIALPLACE
+    bool haveplacer = ("yes" == ql::options::get("initialplaceportfolio"));  // only the heuristic placer is available
+#endif // ifdef INITIALPLACE
+    if("no" != initialplaceopt && haveplacer)
+    {
         std::string initialplace2qhorizonopt = ql::options::get("initialplace2qhorizon");
         DOUT("InitialPlace: kernel=" << kernel.name << " initialplace=" << initialplaceopt << " initialplace2qhorizon=" << initialplace2qhorizonopt << " [START]");
         InitialPlace    ip;             // initial placer facility
         ipr_t           ipok;           // one of several ip result possibilities
         double          iptimetaken;      // time solving the initial placement took, in seconds
         
+        auto t1 = std::chrono::high_resolution_clock::now();
         ip.Init(&grid, platformp);
         ip.Place(kernel.c, v2r, ipok, iptimetaken, initialplaceopt); // compute mapping (in v2r) using ip model, may fail
+        stats.initialplacetime = Seconds(t1);
         DOUT("InitialPlace: kernel=" << kernel.name << " initialplace=" << initialplaceopt << " initialplace2qhorizon=" << initialplace2qhorizonopt << " result=" << ip.ipr2string(ipok) << " iptimetaken=" << iptimetaken << " seconds [DONE]");
-#else // ifdef INITIALPLACE
-        DOUT("InitialPlace code commented out; please uncomment #define INITIALPLACE in src/mapper.h when wanted [DONE]");
-        WOUT("InitialPlace code commented out; please uncomment #define INITIALPLACE in src/mapper.h when wanted [DONE]");
-#endif // ifdef INITIALPLACE
+    }
+    else if ("no" != initialplaceopt)
+    {
+        DOUT("InitialPlace MIP code commented out; please uncomment #define INITIALPLACE in src/mapper.h or set option initialplaceportfolio when wanted [DONE]");
+        WOUT("InitialPlace MIP code commented out; please uncomment #define INITIALPLACE in src/mapper.h or set option initialplaceportfolio when wanted [DONE]");
     }
     v2r.DPRINT("After InitialPlace");
 
@@ -3708,6 +4807,10 @@ void Map(ql::quantum_kernel& kernel)
 
     MapCircuit(kernel, v2r);        // updates kernel.c with swaps, maps all gates, updates v2r map
     v2r.DPRINT("After heuristics");
+    stats.nalters = statnalters;
+    stats.ncheckpoints = statncheckpoints;
+    stats.npastforks = statnpastforks;
+    stats.nmapmappable = statnmapmappable;
 
     MakePrimitives(kernel);         // decompose to primitives as specified in the config file
 
@@ -3733,6 +4836,10 @@ void Init(const ql::quantum_platform *p)
     // DOUT("... platform/real number of qubits=" << nq << ");
     cycle_time = p->cycle_time;
 
+    std::string mapperthreadsopt = ql::options::get("mapper_threads");
+    poolp.reset(new ql::thread_pool(ql::threads_from_option(mapperthreadsopt)));
+    DOUT("... mapper_threads=" << mapperthreadsopt << " so using " << poolp->size() << " thread(s)");
+
     grid.Init(platformp);
 
     // DOUT("Mapping initialization [DONE]");
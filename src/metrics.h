@@ -222,83 +222,103 @@ public:
 		PRINTER(last_op_endtime);
 		IOUT("\n\n");
 
+		if (circ.empty())
+		{
+			return create_output(fids); // no gates, so no gate or idling effects; e.g. swaps over stateless qubits
+		}
+
 		IOUT("Entered loop");
 		for (auto &gate : circ)
 		{
-
-			IOUT("Next gate\n");
-
-			if (gate->name == "measure")
-				continue;
-			else if (gate->name == "prepz")
-			{
-				size_t qubit = gate->operands[0]; 
-				fids[qubit] = 1.0;
-				last_op_endtime[qubit] = gate->cycle + gate->duration / CYCLE_TIME;
-				continue;
-			}
-			
-			if (gate->duration > CYCLE_TIME*2 && gate->name!="prep_z" && gate->name!="measure" )
+			if (!bounded_fidelity_gate(gate, fids, last_op_endtime))
 			{
 				EOUT("Gate with duration larger than CYCLE_TIME*20 detected! Non primitive?: " << gate->name );
     			throw ql::exception("Check for non primitive gates at cycle "  + std::to_string(gate->cycle) + "!", false);
 			}
+		}
+		size_t end_cycle = circ.back()->cycle + circ.back()->duration/CYCLE_TIME; 
+		return bounded_fidelity_output(end_cycle, fids, last_op_endtime);
+	}
 
-			
-			unsigned char type_op = gate->operands.size(); // type of operation (1-qubit/2-qubit)
-			if (type_op == 1)
-			{
-				size_t qubit = gate->operands[0];
-				size_t last_time = last_op_endtime[qubit];
-				IOUT("Gate " + gate->name + "("+ std::to_string(gate->operands[0]) +") at cycle " + std::to_string(gate->cycle) + " with duration " + std::to_string(gate->duration));
-				size_t idled_time = gate->cycle - last_time; //get idlying time to introduce decoherence. This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
-				
-				last_op_endtime[qubit] = gate->cycle  + gate->duration / CYCLE_TIME; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
-				
-				IOUT("Idled time:" + std::to_string(idled_time));
+	// step of bounded_fidelity for one gate, updating fids and last_op_endtime of its operands;
+	// gates on a qubit must come in the order of their cycles; returns false for a non-primitive gate, which is not done
+	bool bounded_fidelity_gate(ql::gate *gate, std::vector<double> &fids, std::vector<size_t> &last_op_endtime)
+	{
+		IOUT("Next gate\n");
 
+		if (gate->name == "measure")
+			return true;
+		else if (gate->name == "prepz")
+		{
+			size_t qubit = gate->operands[0]; 
+			fids[qubit] = 1.0;
+			last_op_endtime[qubit] = gate->cycle + gate->duration / CYCLE_TIME;
+			return true;
+		}
+		
+		if (gate->duration > CYCLE_TIME*2 && gate->name!="prep_z" && gate->name!="measure" )
+		{
+			return false;
+		}
 
-				fids[qubit] *= std::exp(-((double)idled_time)/decoherence_time); // Update fidelity with idling-caused decoherence
-				
-				fids[qubit] *= gatefid_1; //Update fidelity after gate
-				IOUT("METRICS - one qubit gate - END");
+		
+		unsigned char type_op = gate->operands.size(); // type of operation (1-qubit/2-qubit)
+		if (type_op == 1)
+		{
+			size_t qubit = gate->operands[0];
+			size_t last_time = last_op_endtime[qubit];
+			IOUT("Gate " + gate->name + "("+ std::to_string(gate->operands[0]) +") at cycle " + std::to_string(gate->cycle) + " with duration " + std::to_string(gate->duration));
+			size_t idled_time = gate->cycle - last_time; //get idlying time to introduce decoherence. This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
+			
+			last_op_endtime[qubit] = gate->cycle  + gate->duration / CYCLE_TIME; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
+			
+			IOUT("Idled time:" + std::to_string(idled_time));
 
-			}
-			else if (type_op == 2)
-			{
-				IOUT("METRICS - TWO qubit gate");
-				size_t qubit_c = gate->operands[0];
-				size_t qubit_t = gate->operands[1];
-				
-				size_t last_time_c = last_op_endtime[qubit_c];
-				size_t last_time_t = last_op_endtime[qubit_t];
-				size_t idled_time_c = gate->cycle - last_time_c;
-				size_t idled_time_t = gate->cycle - last_time_t; //get idlying time to introduce decoherence. This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
-				last_op_endtime[qubit_c] = gate->cycle  + gate->duration / CYCLE_TIME; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
-				last_op_endtime[qubit_t] = gate->cycle  + gate->duration / CYCLE_TIME ; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
-				
-				IOUT("Gate " + gate->name + "("+ std::to_string(gate->operands[0]) + ", " + std::to_string(gate->operands[1]) +") at cycle " + std::to_string(gate->cycle) + " with duration " + std::to_string(gate->duration));
-				IOUT("Idled time q_c:" + std::to_string(idled_time_c));
-				IOUT("Idled time q_t:" + std::to_string(idled_time_t) + " gate cycle=" + std::to_string(gate->cycle) + ". last_time_t=" + std::to_string(last_time_t));
 
-				fids[qubit_c] *= std::exp(-(double) idled_time_c/decoherence_time); // Update fidelity with idling-caused decoherence
-				fids[qubit_t] *= std::exp(-(double)idled_time_t/decoherence_time); // Update fidelity with idling-caused decoherence
+			fids[qubit] *= std::exp(-((double)idled_time)/decoherence_time); // Update fidelity with idling-caused decoherence
+			
+			fids[qubit] *= gatefid_1; //Update fidelity after gate
+			IOUT("METRICS - one qubit gate - END");
+
+		}
+		else if (type_op == 2)
+		{
+			IOUT("METRICS - TWO qubit gate");
+			size_t qubit_c = gate->operands[0];
+			size_t qubit_t = gate->operands[1];
+			
+			size_t last_time_c = last_op_endtime[qubit_c];
+			size_t last_time_t = last_op_endtime[qubit_t];
+			size_t idled_time_c = gate->cycle - last_time_c;
+			size_t idled_time_t = gate->cycle - last_time_t; //get idlying time to introduce decoherence. This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
+			last_op_endtime[qubit_c] = gate->cycle  + gate->duration / CYCLE_TIME; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
+			last_op_endtime[qubit_t] = gate->cycle  + gate->duration / CYCLE_TIME ; //This assumes "cycle" starts at zero, otherwise gate->cycle-> (gate->cycle - 1)
+			
+			IOUT("Gate " + gate->name + "("+ std::to_string(gate->operands[0]) + ", " + std::to_string(gate->operands[1]) +") at cycle " + std::to_string(gate->cycle) + " with duration " + std::to_string(gate->duration));
+			IOUT("Idled time q_c:" + std::to_string(idled_time_c));
+			IOUT("Idled time q_t:" + std::to_string(idled_time_t) + " gate cycle=" + std::to_string(gate->cycle) + ". last_time_t=" + std::to_string(last_time_t));
 
-				IOUT("Fidelity after idlying: ");
-				PRINTER(fids);
+			fids[qubit_c] *= std::exp(-(double) idled_time_c/decoherence_time); // Update fidelity with idling-caused decoherence
+			fids[qubit_t] *= std::exp(-(double)idled_time_t/decoherence_time); // Update fidelity with idling-caused decoherence
 
-				fids[qubit_c] *=  fids[qubit_t] * gatefid_2; //Update fidelity after gate
-				fids[qubit_t] = fids[qubit_c];  					//Update fidelity after gate
+			IOUT("Fidelity after idlying: ");
+			PRINTER(fids);
 
-				//TODO - Convert the code into a for loop with range 2, to get the compiler's for optimization (and possible paralellization?)
-			}
-				PRINTER(fids);
-				PRINTER(last_op_endtime);
-				
-				IOUT("\n NEXT GATE");
+			fids[qubit_c] *=  fids[qubit_t] * gatefid_2; //Update fidelity after gate
+			fids[qubit_t] = fids[qubit_c];  					//Update fidelity after gate
 
+			//TODO - Convert the code into a for loop with range 2, to get the compiler's for optimization (and possible paralellization?)
 		}
-		size_t end_cycle = circ.back()->cycle + circ.back()->duration/CYCLE_TIME; 
+		PRINTER(fids);
+		PRINTER(last_op_endtime);
+		IOUT("\n NEXT GATE");
+
+		return true;
+	}
+
+	// final step of bounded_fidelity: decoherence of all qubits while idling until end_cycle, and the resulting metric
+	double bounded_fidelity_output(size_t end_cycle, std::vector<double> &fids, const std::vector<size_t> &last_op_endtime)
+	{
 		for (size_t i=0; i < Nqubits; i++ )
 		{
 			size_t idled_time_final = end_cycle - last_op_endtime[i];
@@ -348,6 +368,56 @@ public:
 		return fidelity;
 	}
 
+	// incremental form of quick_fidelity, for the mapper's Past to score alternatives
+	// in time proportional to the gates added instead of to all gates in the past:
+	// quick_fidelity_add does the step of bounded_fidelity for each gate as it is added,
+	// and quick_fidelity_result computes from this state what quick_fidelity computes on the whole list;
+	// per qubit, gates must be added in the order of their cycles
+	typedef struct
+	{
+		std::vector<double>	fids;				// fidelity of each qubit after the gates added
+		std::vector<size_t>	last_op_endtime;	// cycle at which each qubit became idle
+		ql::gate			*nonprimitive;		// first non-primitive gate added, or NULL
+	} quick_fidelity_state_t;
+
+	void quick_fidelity_init(quick_fidelity_state_t &state)
+	{
+		state.fids.assign(17, 1.0);
+		state.last_op_endtime.assign(17, 1);
+		state.nonprimitive = NULL;
+	}
+
+	void quick_fidelity_add(quick_fidelity_state_t &state, ql::gate *gate)
+	{
+		static ql::Metrics estimator(17);	// is only read, so can be shared
+		if (!estimator.bounded_fidelity_gate(gate, state.fids, state.last_op_endtime) && state.nonprimitive == NULL)
+		{
+			state.nonprimitive = gate;
+		}
+	}
+
+	// lastgate is the last gate of the list, which determines the end cycle; NULL when the list is empty
+	double quick_fidelity_result(const quick_fidelity_state_t &state, ql::gate *lastgate)
+	{
+		static ql::Metrics estimator(17);	// is only read, so can be shared
+		if (state.nonprimitive != NULL)
+		{
+			EOUT("Gate with duration larger than CYCLE_TIME*20 detected! Non primitive?: " << state.nonprimitive->name );
+			throw ql::exception("Check for non primitive gates at cycle "  + std::to_string(state.nonprimitive->cycle) + "!", false);
+		}
+		std::vector<double> fids = state.fids;
+		double fidelity;
+		if (lastgate == NULL)
+		{
+			fidelity = estimator.create_output(fids);
+		}
+		else
+		{
+			fidelity = estimator.bounded_fidelity_output(lastgate->cycle + lastgate->duration/CYCLE_TIME, fids, state.last_op_endtime);
+		}
+		return -fidelity;	//Symmetric value because lower score is considered better in mapper.h
+	}
+
 
 // const unsigned char transition_matrix[4][4]  = {{ 0, 1, 2, 3 },  //[input_state][new_error]
 // 					   						    { 1, 0, 3, 2 },  //I = 0, X = 1, Y = 2, Z = 3
@@ -38,8 +38,11 @@ namespace ql
           opt_name2opt_val["scheduler"] = "ALAP";
           opt_name2opt_val["scheduler_uniform"] = "no";
           opt_name2opt_val["scheduler_commute"] = "no";
+          opt_name2opt_val["scheduler_commute_rotations"] = "no";
+          opt_name2opt_val["scheduler_threads"] = "1";
           opt_name2opt_val["prescheduler"] = "yes";
           opt_name2opt_val["scheduler_post179"] = "yes";
+          opt_name2opt_val["resource_timeline"] = "no";
           opt_name2opt_val["backend_cc_map_input_file"] = "";
 
           opt_name2opt_val["cz_mode"] = "manual";
@@ -54,7 +57,9 @@ namespace ql
           opt_name2opt_val["mapprepinitsstate"] = "no";
           opt_name2opt_val["initialplace"] = "no";
           opt_name2opt_val["initialplace2qhorizon"] = "0";
+          opt_name2opt_val["initialplaceportfolio"] = "no";
           opt_name2opt_val["maplookahead"] = "noroutingfirst";
+          opt_name2opt_val["maplookaheadwindow"] = "0";
           opt_name2opt_val["mappathselect"] = "all";
           opt_name2opt_val["maprecNN2q"] = "no";
           opt_name2opt_val["mapselectmaxlevel"] = "0";
@@ -63,6 +68,11 @@ namespace ql
           opt_name2opt_val["maptiebreak"] = "random";
           opt_name2opt_val["mapusemoves"] = "yes";
           opt_name2opt_val["mapreverseswap"] = "yes";
+          opt_name2opt_val["mapper_threads"] = "1";
+          opt_name2opt_val["mapmaxalters"] = "0";
+          opt_name2opt_val["mapbeamwidth"] = "4";
+          opt_name2opt_val["mapbeamtime"] = "0";
+          opt_name2opt_val["mapbeammemory"] = "0";
 
           opt_name2opt_val["write_qasm_files"] = "no";
           opt_name2opt_val["write_report_files"] = "no";
@@ -78,6 +88,9 @@ namespace ql
           app->add_set_ignore_case("--scheduler", opt_name2opt_val["scheduler"], {"ASAP", "ALAP"}, "scheduler type", true);
           app->add_set_ignore_case("--scheduler_uniform", opt_name2opt_val["scheduler_uniform"], {"yes", "no"}, "Do uniform scheduling or not", true);
           app->add_set_ignore_case("--scheduler_commute", opt_name2opt_val["scheduler_commute"], {"yes", "no"}, "Commute gates when possible, or not", true);
+          app->add_set_ignore_case("--scheduler_commute_rotations", opt_name2opt_val["scheduler_commute_rotations"], {"yes", "no"}, "Commute single-qubit rotations with cz/cnot by default, or not", true);
+          app->add_set_ignore_case("--resource_timeline", opt_name2opt_val["resource_timeline"], {"yes", "no"}, "Keep resource reservations as intervals, so that gates can fill gaps, or not", true);
+          app->add_option("--scheduler_threads", opt_name2opt_val["scheduler_threads"], "Number of threads scheduling kernels in parallel; 0 is one per core", true);
           app->add_set_ignore_case("--use_default_gates", opt_name2opt_val["use_default_gates"], {"yes", "no"}, "Use default gates or not", true);
           app->add_set_ignore_case("--optimize", opt_name2opt_val["optimize"], {"yes", "no"}, "optimize or not", true);
           app->add_set_ignore_case("--clifford_premapper", opt_name2opt_val["clifford_premapper"], {"yes", "no"}, "clifford optimize before mapping yes or not", true);
@@ -87,13 +100,15 @@ namespace ql
           app->add_option("--backend_cc_map_input_file", opt_name2opt_val["backend_cc_map_input_file"], "Name of CC input map file", true);
           app->add_set_ignore_case("--cz_mode", opt_name2opt_val["cz_mode"], {"manual", "auto"}, "CZ mode", true);
 
-          app->add_set_ignore_case("--mapper", opt_name2opt_val["mapper"], {"no", "base", "baserc", "minextend", "minextendrc", "maxfidelity"}, "Mapper heuristic", true);
+          app->add_set_ignore_case("--mapper", opt_name2opt_val["mapper"], {"no", "base", "baserc", "minextend", "minextendrc", "maxfidelity", "beam"}, "Mapper heuristic", true);
           app->add_set_ignore_case("--mapinitone2one", opt_name2opt_val["mapinitone2one"], {"no", "yes"}, "Initialize mapping of virtual qubits one to one to real qubits", true);
           app->add_set_ignore_case("--mapprepinitsstate", opt_name2opt_val["mapprepinitsstate"], {"no", "yes"}, "Prep gate leaves qubit in zero state", true);
           app->add_set_ignore_case("--mapassumezeroinitstate", opt_name2opt_val["assumezeroinitstate"], {"no", "yes"}, "Assume that qubits are initialized to zero state", true);
           app->add_set_ignore_case("--initialplace", opt_name2opt_val["initialplace"], {"no","yes","1s","10s","1m","10m","1h","1sx","10sx","1mx","10mx","1hx"}, "Initialplace qubits before mapping", true);
           app->add_set_ignore_case("--initialplace2qhorizon", opt_name2opt_val["initialplace2qhorizon"], {"0","1","2","3","4","5","6","7","8","9", "10","11","12","13","14","15","16","17","18","19","20","30","40","50","60","70","80","90","100"}, "Initialplace considers only this number of initial two-qubit gates", true);
+          app->add_set_ignore_case("--initialplaceportfolio", opt_name2opt_val["initialplaceportfolio"], {"no", "yes"}, "Initialplace also runs a heuristic placer and takes its result when the MIP doesn't finish in time; the only placer when the MIP is not compiled in", true);
           app->add_set_ignore_case("--maplookahead", opt_name2opt_val["maplookahead"], {"no", "1qfirst", "noroutingfirst", "all"}, "Strategy wrt selecting next gate(s) to map", true);
+          app->add_option("--maplookaheadwindow", opt_name2opt_val["maplookaheadwindow"], "Maximum number of unmapped gates in the mapper's dependence graph; 0 is no maximum", true);
           app->add_set_ignore_case("--mappathselect", opt_name2opt_val["mappathselect"], {"all", "borders"}, "Which paths: all or borders", true);
           app->add_set_ignore_case("--mapselectswaps", opt_name2opt_val["mapselectswaps"], {"one", "all", "earliest"}, "Select only one swap, or earliest, or all swaps for one alternative", true);
           app->add_set_ignore_case("--maprecNN2q", opt_name2opt_val["maprecNN2q"], {"no","yes"}, "Recursing also on NN 2q gate?", true);
@@ -102,6 +117,11 @@ namespace ql
           app->add_set_ignore_case("--maptiebreak", opt_name2opt_val["maptiebreak"], {"first", "last", "random", "critical"}, "Tie break method", true);
           app->add_set_ignore_case("--mapusemoves", opt_name2opt_val["mapusemoves"], {"no", "yes", "0","1","2","3","4","5","6","7","8","9","10","11","12","13","14","15","16","17","18","19","20"}, "Use unused qubit to move thru", true);
           app->add_set_ignore_case("--mapreverseswap", opt_name2opt_val["mapreverseswap"], {"no", "yes"}, "Reverse swap operands when better", true);
+          app->add_option("--mapper_threads", opt_name2opt_val["mapper_threads"], "Number of threads evaluating mapper alternatives; 0 is one per core", true);
+          app->add_option("--mapmaxalters", opt_name2opt_val["mapmaxalters"], "Maximum number of alternatives generated per 2q gate; 0 is no maximum", true);
+          app->add_option("--mapbeamwidth", opt_name2opt_val["mapbeamwidth"], "Number of partial mappings kept per level by the beam mapper", true);
+          app->add_option("--mapbeamtime", opt_name2opt_val["mapbeamtime"], "Time in milliseconds after which the beam mapper stops looking ahead in a kernel; 0 is no limit", true);
+          app->add_option("--mapbeammemory", opt_name2opt_val["mapbeammemory"], "Maximum size in megabytes of the beam mapper's partial mappings; 0 is no limit", true);
 
           app->add_set_ignore_case("--write_qasm_files", opt_name2opt_val["write_qasm_files"], {"yes", "no"}, "write (un-)scheduled (with and without resource-constraint) qasm files", true);
           app->add_set_ignore_case("--write_report_files", opt_name2opt_val["write_report_files"], {"yes", "no"}, "write report files on circuit characteristics and pass results", true);
@@ -124,15 +144,25 @@ namespace ql
                     << "mapinitone2one: "   << opt_name2opt_val["mapinitone2one"] << std::endl
                     << "initialplace: "     << opt_name2opt_val["initialplace"] << std::endl
                     << "initialplace2qhorizon: "<< opt_name2opt_val["initialplace2qhorizon"] << std::endl
+                    << "initialplaceportfolio: "<< opt_name2opt_val["initialplaceportfolio"] << std::endl
                     << "maplookahead: "     << opt_name2opt_val["maplookahead"] << std::endl
+                    << "maplookaheadwindow: "<< opt_name2opt_val["maplookaheadwindow"] << std::endl
                     << "mappathselect: "    << opt_name2opt_val["mappathselect"] << std::endl
                     << "maptiebreak: "      << opt_name2opt_val["maptiebreak"] << std::endl
                     << "mapusemoves: "      << opt_name2opt_val["mapusemoves"] << std::endl
                     << "mapreverseswap: "   << opt_name2opt_val["mapreverseswap"] << std::endl
                     << "mapselectswaps: "   << opt_name2opt_val["mapselectswaps"] << std::endl
+                    << "mapper_threads: "   << opt_name2opt_val["mapper_threads"] << std::endl
+                    << "mapmaxalters: "     << opt_name2opt_val["mapmaxalters"] << std::endl
+                    << "mapbeamwidth: "     << opt_name2opt_val["mapbeamwidth"] << std::endl
+                    << "mapbeamtime: "      << opt_name2opt_val["mapbeamtime"] << std::endl
+                    << "mapbeammemory: "    << opt_name2opt_val["mapbeammemory"] << std::endl
                     << "clifford_postmapper: " << opt_name2opt_val["clifford_postmapper"] << std::endl
                     << "scheduler_post179: " << opt_name2opt_val["scheduler_post179"] << std::endl
                     << "scheduler_commute: " << opt_name2opt_val["scheduler_commute"] << std::endl
+                    << "scheduler_commute_rotations: " << opt_name2opt_val["scheduler_commute_rotations"] << std::endl
+                    << "resource_timeline: " << opt_name2opt_val["resource_timeline"] << std::endl
+                    << "scheduler_threads: " << opt_name2opt_val["scheduler_threads"] << std::endl
                     << "cz_mode: " << opt_name2opt_val["cz_mode"] << std::endl
                     << "print_dot_graphs: " << opt_name2opt_val["print_dot_graphs"] << std::endl;
           // FIXME: incomplete, function seems unused
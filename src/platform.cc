@@ -47,6 +47,114 @@ quantum_platform::quantum_platform(std::string name, std::string configuration_f
     }
     else
         cycle_time = hardware_settings["cycle_time"];
+
+    intern_instructions();
+    init_buffer_cycles();
+}
+
+// intern a string in table, returning its index
+static size_t intern(std::vector<std::string>& table, const std::string& str)
+{
+    auto it = std::find(table.begin(), table.end(), str);
+    if (it != table.end())
+    {
+        return it - table.begin();
+    }
+    table.push_back(str);
+    return table.size()-1;
+}
+
+/**
+ * create the descriptors of the instructions in instruction_settings
+ */
+void quantum_platform::intern_instructions()
+{
+    operation_names.assign(1, "");
+    instruction_types.assign(1, "");
+    operation_types = { "none", "mw", "flux", "readout" };
+    undefined_descriptor = instruction_descriptor_t();
+    for (auto it = instruction_settings.begin(); it != instruction_settings.end(); ++it)
+    {
+        const json& instr = it.value();
+        instruction_descriptor_t d;
+        d.name = it.key();
+        d.operation_name = d.name;
+        if (JSON_EXISTS(instr, "cc_light_instr") && !instr["cc_light_instr"].is_null())
+        {
+            d.operation_name = instr["cc_light_instr"].get<std::string>();
+        }
+        if (JSON_EXISTS(instr, "type") && !instr["type"].is_null())
+        {
+            d.operation_type = instr["type"].get<std::string>();
+        }
+        if (JSON_EXISTS(instr, "cc_light_instr_type") && !instr["cc_light_instr_type"].is_null())
+        {
+            d.instruction_type = instr["cc_light_instr_type"].get<std::string>();
+        }
+        if (JSON_EXISTS(instr, "duration") && instr["duration"].is_number())
+        {
+            d.duration = std::ceil(instr["duration"].get<float>() / cycle_time);
+        }
+        if (JSON_EXISTS(instr, "latency") && instr["latency"].is_number())
+        {
+            float latency_ns = instr["latency"].get<float>();
+            d.latency = (std::ceil( static_cast<float>(std::abs(latency_ns)) / cycle_time)) *
+                            ql::utils::sign_of(latency_ns);
+        }
+        if (JSON_EXISTS(instr, "commutation") && instr["commutation"].is_array())
+        {
+            for (auto& c : instr["commutation"])
+            {
+                std::string cname = c.is_string() ? c.get<std::string>() : "";
+                if (cname == "z")           d.commutation.push_back(commute_z);
+                else if (cname == "x")      d.commutation.push_back(commute_x);
+                else if (cname == "none")   d.commutation.push_back(commute_none);
+                else
+                {
+                    FATAL("instruction '" << d.name << "': commutation class " << c << " is not one of \"z\", \"x\" or \"none\"");
+                }
+            }
+            d.commutation_rotations = d.commutation;
+        }
+        else
+        {
+            d.commutation = default_commutation(d.name, false);
+            d.commutation_rotations = default_commutation(d.name, true);
+        }
+        d.operation_name_id = intern(operation_names, d.operation_name);
+        d.instruction_type_id = intern(instruction_types, d.instruction_type);
+        if (d.operation_type == "" || d.operation_type == "none")  d.optype = optype_none;
+        else if (d.operation_type == "mw")                          d.optype = optype_mw;
+        else if (d.operation_type == "flux")                        d.optype = optype_flux;
+        else if (d.operation_type == "readout")                     d.optype = optype_readout;
+        else                                                        d.optype = optype_other;
+        d.optype_id = (d.optype == optype_other ? intern(operation_types, d.operation_type) : size_t(d.optype));
+        descriptor_index[d.name] = descriptors.size();
+        descriptors.push_back(d);
+    }
+}
+
+/**
+ * fill the buffer_cycles table from the "<type1>_<type2>_buffer" hardware settings,
+ * for each pair of operation types of the instructions;
+ * the 'none' type is a dummy type for which these settings are also looked up
+ */
+void quantum_platform::init_buffer_cycles()
+{
+    size_t  ntypes = operation_types.size();
+    buffer_cycles.assign(ntypes, std::vector<size_t>(ntypes, 0));
+    for (size_t t1 = 0; t1 < ntypes; t1++)
+    {
+        for (size_t t2 = 0; t2 < ntypes; t2++)
+        {
+            auto bname = operation_types[t1] + "_" + operation_types[t2] + "_buffer";
+            if (hardware_settings.count(bname) > 0)
+            {
+                buffer_cycles[t1][t2] = std::ceil( static_cast<float>(hardware_settings[bname]) / cycle_time);
+                DOUT("buffer_cycles " << bname << ": " << buffer_cycles[t1][t2]);
+            }
+        }
+    }
 }
 
 /**
@@ -107,5 +215,63 @@ size_t quantum_platform::time_to_cycles(float time_ns) const
     return std::ceil(time_ns/cycle_time);
 }
 
+const instruction_descriptor_t* quantum_platform::find_descriptor(const std::string& iname) const
+{
+    auto it = descriptor_index.find(iname);
+    if (it == descriptor_index.end())
+    {
+        return NULL;
+    }
+    return &descriptors[it->second];
+}
+
+const instruction_descriptor_t& quantum_platform::get_descriptor(const std::string& iname) const
+{
+    const instruction_descriptor_t* dp = find_descriptor(iname);
+    return (dp == NULL ? undefined_descriptor : *dp);
+}
+
+std::vector<commute_t> quantum_platform::default_commutation(const std::string& iname, bool rotations)
+{
+    static const std::unordered_map<std::string, std::vector<commute_t>> by_name = {
+        { "cnot",   { commute_z, commute_x } },
+        { "cz",     { commute_z, commute_z } },
+        { "cphase", { commute_z, commute_z } }
+    };
+    static const std::unordered_map<std::string, std::vector<commute_t>> rotations_by_name = {
+        { "z",      { commute_z } },
+        { "s",      { commute_z } },
+        { "sdag",   { commute_z } },
+        { "t",      { commute_z } },
+        { "tdag",   { commute_z } },
+        { "rz",     { commute_z } },
+        { "x",      { commute_x } },
+        { "rx",     { commute_x } },
+        { "x90",    { commute_x } },
+        { "mx90",   { commute_x } },
+        { "xm90",   { commute_x } },
+        { "x45",    { commute_x } },
+        { "xm45",   { commute_x } },
+        { "rx90",   { commute_x } },
+        { "rxm90",  { commute_x } },
+        { "rx180",  { commute_x } },
+        { "x180",   { commute_x } }
+    };
+    std::string first = iname.substr(0, iname.find(' '));
+    auto it = by_name.find(first);
+    if (it != by_name.end())
+    {
+        return it->second;
+    }
+    if (rotations)
+    {
+        it = rotations_by_name.find(first);
+        if (it != rotations_by_name.end())
+        {
+            return it->second;
+        }
+    }
+    return std::vector<commute_t>();
+}
 
 }   // namespace
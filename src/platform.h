@@ -9,6 +9,8 @@
 
 #include <string>
 #include <tuple>
+#include <vector>
+#include <unordered_map>
 
 #include <compile_options.h>
 #include <json.h>
@@ -16,6 +18,45 @@
 
 namespace ql
 {
+
+// operation type of an instruction ("type" in its instruction settings), as used by the resource managers
+typedef enum {
+    optype_none,        // no type, or "none"
+    optype_mw,          // "mw"
+    optype_flux,        // "flux"
+    optype_readout,     // "readout"
+    optype_other        // any other type
+} optype_t;
+
+// commutation class of the use of a qubit operand by an instruction, as used in dependence graph construction;
+// uses of the same qubit with the same class other than commute_none commute (see scheduler.h)
+typedef enum {
+    commute_none,       // commutes with nothing: Write event
+    commute_z,          // diagonal in the Z basis (e.g. cz operands, cnot control, z, s, t, rz): Read event
+    commute_x           // diagonal in the X basis (e.g. cnot target, x, x90, rx): D event
+} commute_t;
+
+// the settings of an instruction that the schedulers and resource managers need,
+// interned from instruction_settings once when the platform is loaded,
+// so that these don't need json lookups and string compares while scheduling
+class instruction_descriptor_t
+{
+public:
+    std::string name;                   // instruction name, the key in instruction_settings
+    std::string operation_name;         // "cc_light_instr", or name when not there
+    std::string operation_type;         // "type", or empty when not there
+    std::string instruction_type;       // "cc_light_instr_type", or empty when not there
+    size_t      operation_name_id = 0;  // operation_name interned in quantum_platform::operation_names
+    optype_t    optype = optype_none;   // operation_type as enum
+    size_t      optype_id = optype_none;// operation_type interned in quantum_platform::operation_types
+    size_t      instruction_type_id = 0;// instruction_type interned in quantum_platform::instruction_types
+    size_t      duration = 0;           // "duration" in cycles
+    long        latency = 0;            // "latency" in cycles, rounded up in absolute value; negative is earlier
+    std::vector<commute_t> commutation; // class of each qubit operand, "commutation" or else by name; none when absent
+    std::vector<commute_t> commutation_rotations;   // same, by name including the single-qubit gates
+                                        // (option scheduler_commute_rotations); equal to commutation when "commutation" is given
+};
+
 class quantum_platform
 {
 
@@ -33,6 +74,16 @@ public:
     json                    topology;
     json                    aliases;                  // workaround the generic instruction composition
 
+    std::vector<instruction_descriptor_t>       descriptors;        // of the instructions in instruction_settings
+    std::unordered_map<std::string,size_t>      descriptor_index;   // descriptors[descriptor_index[name]] is that of name
+    std::vector<std::string>                    operation_names;    // interned operation names; 0 is ""
+    std::vector<std::string>                    instruction_types;  // interned instruction types; 0 is ""
+    std::vector<std::string>                    operation_types;    // interned operation types; the first optype_other
+                                                                    // are those of optype_t: "none", "mw", "flux", "readout"
+    instruction_descriptor_t                    undefined_descriptor;   // of instructions not in instruction_settings
+    std::vector<std::vector<size_t>>            buffer_cycles;      // [optype_id1][optype_id2]: "<type1>_<type2>_buffer"
+                                                                    // in cycles, 0 when not there
+
 #if OPT_TARGET_PLATFORM   // FIXME: constructed object is not useable
     quantum_platform() : name("default")
     {
@@ -66,6 +117,21 @@ public:
     std::string find_instruction_type(std::string iname) const;
 
     size_t time_to_cycles(float time_ns) const;
+
+    // descriptor of instruction iname, NULL when it is not in instruction_settings
+    const instruction_descriptor_t* find_descriptor(const std::string& iname) const;
+
+    // descriptor of instruction iname, undefined_descriptor when it is not in instruction_settings
+    const instruction_descriptor_t& get_descriptor(const std::string& iname) const;
+
+    // commutation classes of the qubit operands of a gate with name iname, derived from iname's first word;
+    // this is the default for instructions without "commutation" and for gates not in instruction_settings;
+    // only cnot and cz/cphase have classes, and with rotations also the single-qubit gates diagonal in the Z or X basis
+    static std::vector<commute_t> default_commutation(const std::string& iname, bool rotations);
+
+private:
+    void intern_instructions();
+    void init_buffer_cycles();
 };
 
 }
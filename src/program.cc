@@ -12,6 +12,7 @@
 #include <utils.h>
 #include <options.h>
 #include <interactionMatrix.h>
+#include <thread_pool.h>
 #include <arch/cbox/cbox_eqasm_compiler.h>
 #include <arch/cc_light/cc_light_eqasm_compiler.h>
 #include <arch/cc/eqasm_backend_cc.h>
@@ -613,25 +614,40 @@ void quantum_program::schedule()
     sched_qasm += "qubits " + std::to_string(qubit_count) + "\n";
 
     IOUT("scheduling the quantum program");
-    for (auto k : kernels)
+    // the kernels are scheduled independently, each a copy of the program's kernel as before,
+    // so these run in parallel (option scheduler_threads); their outputs are assembled in kernel order
+    size_t nkernels = kernels.size();
+    std::vector<std::string> kernel_sched_qasms(nkernels);
+    std::vector<std::string> dots(nkernels);
+    std::vector<std::string> kernel_sched_dots(nkernels);
+    size_t nthreads = ql::threads_from_option(ql::options::get("scheduler_threads"));
+    if (nthreads > 1 && ql::kernels_share_gates(kernels))
+    {
+        nthreads = 1;
+    }
+    ql::thread_pool pool(nthreads);
+    pool.parallel_for(nkernels, [&](size_t i, size_t worker)
+    {
+        quantum_kernel k(kernels[i]);
+        k.schedule(platform, kernel_sched_qasms[i], dots[i], kernel_sched_dots[i]);
+    });
+
+    for (size_t i = 0; i < nkernels; i++)
     {
-        std::string kernel_sched_qasm;
-        std::string dot;
-        std::string kernel_sched_dot;
-        k.schedule(platform, kernel_sched_qasm, dot, kernel_sched_dot);
-        sched_qasm += kernel_sched_qasm + '\n';
+        auto & k = kernels[i];
+        sched_qasm += kernel_sched_qasms[i] + '\n';
 
         if(ql::options::get("print_dot_graphs") == "yes")
         {
             string fname;
             fname = ql::options::get("output_dir") + "/" + k.get_name() + "_dependence_graph.dot";
             IOUT("writing scheduled dot to '" << fname << "' ...");
-            ql::utils::write_file(fname, dot);
+            ql::utils::write_file(fname, dots[i]);
 
             std::string scheduler = ql::options::get("scheduler");
             fname = ql::options::get("output_dir") + "/" + k.get_name() + scheduler + "_scheduled.dot";
             IOUT("writing scheduled dot to '" << fname << "' ...");
-            ql::utils::write_file(fname, kernel_sched_dot);
+            ql::utils::write_file(fname, kernel_sched_dots[i]);
         }
     }
 
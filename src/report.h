@@ -13,6 +13,7 @@
 #include <options.h>
 #include <kernel.h>
 #include <ir.h>
+#include <gate_record.h>
 
 namespace ql
 {
@@ -44,14 +45,15 @@ namespace report
      */
     /*
      * support functions for reporting statistics
+     * the counts are computed from a compact copy of the circuit, made once per kernel without the names
      */
-    size_t  get_classical_operations_count(const circuit& c, const quantum_platform& platform)
+    size_t  get_classical_operations_count(const compact_circuit_t& c, const quantum_platform& platform)
     {
         size_t classical_operations = 0;
         // DOUT("... reporting get_classical_operations_count");
-        for (auto & gp: c)
+        for (auto & gr: c)
         {
-            switch(gp->type())
+            switch(gr.type())
             {
             case __classical_gate__:
                 classical_operations++;
@@ -65,20 +67,21 @@ namespace report
         return classical_operations;
     }
 
-    size_t  get_non_single_qubit_quantum_gates_count(const circuit& c, const quantum_platform& platform)
+    size_t  get_non_single_qubit_quantum_gates_count(const compact_circuit_t& c, const quantum_platform& platform)
     {
         size_t quantum_gates = 0;
         // DOUT("... reporting get_non_single_qubit_quantum_gates_count");
-        for (auto & gp: c)
+        for (size_t i = 0; i < c.size(); i++)
         {
-            switch(gp->type())
+            auto & gr = c[i];
+            switch(gr.type())
             {
             case __classical_gate__:
                 break;
             case __wait_gate__:
                 break;
             default:    // quantum gate
-                if( gp->operands.size() > 1 )
+                if( c.qubit_count(i) > 1 )
                 {
                     quantum_gates++;
                 }
@@ -89,20 +92,21 @@ namespace report
         return quantum_gates;
     }
 
-    void  get_qubit_usecount(const circuit& c, const quantum_platform& platform, std::vector<size_t>& usecount)
+    void  get_qubit_usecount(const compact_circuit_t& c, const quantum_platform& platform, std::vector<size_t>& usecount)
     {
         // DOUT("... reporting get_qubit_usecount");
-        for (auto & gp: c)
+        for (size_t i = 0; i < c.size(); i++)
         {
-            switch(gp->type())
+            auto & gr = c[i];
+            switch(gr.type())
             {
             case __classical_gate__:
             case __wait_gate__:
                 break;
             default:    // quantum gate
-                for (auto v: gp->operands)
+                for (size_t k = 0; k < c.qubit_count(i); k++)
                 {
-                    usecount[v]++;
+                    usecount[c.qubit(i,k)]++;
                 }
                 break;
             }
@@ -111,22 +115,23 @@ namespace report
         return;
     }
 
-    void  get_qubit_usedcyclecount(const circuit& c, const quantum_platform& platform, std::vector<size_t>& usedcyclecount)
+    void  get_qubit_usedcyclecount(const compact_circuit_t& c, const quantum_platform& platform, std::vector<size_t>& usedcyclecount)
     {
         size_t  cycle_time = platform.cycle_time;
 
         // DOUT("... reporting get_qubit_usedcyclecount");
-        for (auto & gp: c)
+        for (size_t i = 0; i < c.size(); i++)
         {
-            switch(gp->type())
+            auto & gr = c[i];
+            switch(gr.type())
             {
             case __classical_gate__:
             case __wait_gate__:
                 break;
             default:    // quantum gate
-                for (auto v: gp->operands)
+                for (size_t k = 0; k < c.qubit_count(i); k++)
                 {
-                    usedcyclecount[v] += (gp->duration+cycle_time-1)/cycle_time;
+                    usedcyclecount[c.qubit(i,k)] += (c.duration(i)+cycle_time-1)/cycle_time;
                 }
                 break;
             }
@@ -135,13 +140,13 @@ namespace report
         return;
     }
 
-    size_t  get_quantum_gates_count(const circuit& c, const quantum_platform& platform)
+    size_t  get_quantum_gates_count(const compact_circuit_t& c, const quantum_platform& platform)
     {
         size_t quantum_gates = 0;
         // DOUT("... reporting get_quantum_gates_count");
-        for (auto & gp: c)
+        for (auto & gr: c)
         {
-            switch(gp->type())
+            switch(gr.type())
             {
             case __classical_gate__:
                 break;
@@ -339,21 +344,22 @@ namespace report
         }
 
         // DOUT("... reporting report_kernel_statistics");
+        ql::compact_circuit_t kc(k.c, false);
         std::vector<size_t> usecount;
         usecount.resize(platform.qubit_number, 0);
-        get_qubit_usecount(k.c, platform, usecount);
+        get_qubit_usecount(kc, platform, usecount);
         size_t qubits_used = 0; for (auto v: usecount) { if (v != 0) { qubits_used++; } } 
 
         std::vector<size_t> usedcyclecount;
         usedcyclecount.resize(platform.qubit_number, 0);
-        get_qubit_usedcyclecount(k.c, platform, usedcyclecount);
+        get_qubit_usedcyclecount(kc, platform, usedcyclecount);
 
         size_t  depth = get_depth(k.c, platform);
         ofs << prefix << "kernel: " << k.name << "\n";
         ofs << prefix << "----- depth: " << depth << "\n";
-        ofs << prefix << "----- quantum gates: " << get_quantum_gates_count(k.c, platform) << "\n";
-        ofs << prefix << "----- non single qubit gates: " << get_non_single_qubit_quantum_gates_count(k.c, platform) << "\n";
-        ofs << prefix << "----- classical operations: " << get_classical_operations_count(k.c, platform) << "\n";
+        ofs << prefix << "----- quantum gates: " << get_quantum_gates_count(kc, platform) << "\n";
+        ofs << prefix << "----- non single qubit gates: " << get_non_single_qubit_quantum_gates_count(kc, platform) << "\n";
+        ofs << prefix << "----- classical operations: " << get_classical_operations_count(kc, platform) << "\n";
         ofs << prefix << "----- qubits used: " << qubits_used << "\n";
         ofs << prefix << "----- qubit cycles use:" << ql::utils::to_string(usedcyclecount) << "\n";
         // DOUT("... reporting report_kernel_statistics [done]");
@@ -401,12 +407,13 @@ namespace report
         size_t total_non_single_qubit_gates= 0;
         for (auto& k : kernels)
         {
-            get_qubit_usecount(k.c, platform, usecount);
+            ql::compact_circuit_t kc(k.c, false);
+            get_qubit_usecount(kc, platform, usecount);
 
             total_depth += get_depth(k.c, platform);
-            total_classical_operations += get_classical_operations_count(k.c, platform);
-            total_quantum_gates += get_quantum_gates_count(k.c, platform);
-            total_non_single_qubit_gates += get_non_single_qubit_quantum_gates_count(k.c, platform);
+            total_classical_operations += get_classical_operations_count(kc, platform);
+            total_quantum_gates += get_quantum_gates_count(kc, platform);
+            total_non_single_qubit_gates += get_non_single_qubit_quantum_gates_count(kc, platform);
         }
         size_t qubits_used = 0; for (auto v: usecount) { if (v != 0) { qubits_used++; } } 
 
@@ -12,8 +12,14 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <memory>
+#include <limits>
+#include <iterator>
+#include <algorithm>
 
 #include <platform.h>
+#include <options.h>
 
 namespace ql
 {
@@ -39,16 +45,260 @@ public:
     resource_t(std::string n, scheduling_direction_t dir) : name(n), direction(dir)
     {
         DOUT("constructing resource: " << n << " for direction (0:fwd,1:bwd): " << dir);
+        use_timeline = (ql::options::get("resource_timeline") == "yes");
+    }
+
+    // a copy starts without checkpoints, so it doesn't copy the undo logs (which refer to the original's state)
+    resource_t(const resource_t& r) : name(r.name), count(r.count), direction(r.direction),
+        timeline(r.timeline), use_timeline(r.use_timeline) {}
+
+    virtual bool available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration) = 0;
+    virtual void reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration) = 0;
+
+    // the first cycle from op_start_cycle on (fwd) or from it down (bwd) at which the resource
+    // might be available for the operation, given the reservations made so far;
+    // in the cycles skipped, available certainly returns false;
+    // the default doesn't skip any cycle
+    virtual size_t next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        return op_start_cycle;
+    }
+
+    // bwd: the last cycle at which an operation of the given duration can start to complete by cycle
+    static size_t until_cycle(size_t cycle, size_t operation_duration)
+    {
+        return (cycle < operation_duration ? 0 : cycle - operation_duration);
     }
 
-    virtual bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration) = 0;
-    virtual void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration) = 0;
     virtual ~resource_t() {}
     virtual resource_t* clone() const & = 0;
     virtual resource_t* clone() && = 0;
 
+    // checkpoint/rollback support, see resource_manager_t::checkpoint:
+    // the state of a resource is made up of elements of vectors that are sized at construction;
+    // a resource changes its state only by assign, which, while a checkpoint is open,
+    // logs the element's address and old value in undo_log, so that rollback can restore the state
+    typedef struct {
+        size_t*     element;        // changed element of the state
+        size_t      old;            // its value before the change
+    } undo_t;
+    std::vector<undo_t> undo_log;
+    bool                journaling = false;     // whether changes are logged, i.e. a checkpoint is open
+
+    void assign(size_t& element, size_t value)
+    {
+        if (journaling)
+        {
+            undo_log.push_back(undo_t{&element, element});
+        }
+        element = value;
+    }
+
+    // timeline model of the reservations, used instead of the state of the derived resource
+    // when option resource_timeline is yes:
+    // an operation claims units of the resource (e.g. the qwgs of its operands), each claim with a tag;
+    // claims of a unit that overlap in time are compatible when they have the same tag
+    // (e.g. the same operation on a qwg), except for claims with the exclusive tag;
+    // the reservations of each unit are intervals [from,to) of cycles with the tag of their claims,
+    // kept disjoint by merging overlapping compatible ones, in a map ordered by from;
+    // so available, reserve and next_available can be done at any cycle in O(log reservations) per claim,
+    // which allows to schedule out of order, e.g. to fill a gap left between gates scheduled earlier,
+    // and which doesn't depend on the scheduling direction
+    typedef struct {
+        size_t      unit;           // claimed unit
+        size_t      tag;            // claims with equal tags may overlap, unless exclusive
+    } claim_t;
+    static const size_t exclusive = std::numeric_limits<size_t>::max();
+    typedef struct {
+        size_t      to;             // end cycle of the reservation, not inclusive
+        size_t      tag;            // tag of the claims it reserves for
+    } reservation_t;
+    typedef std::map<size_t,reservation_t> unit_timeline_t;    // reservations of a unit by from cycle
+    std::vector<unit_timeline_t>    timeline;       // timeline[unit], extended as units are reserved
+    bool                            use_timeline;   // option resource_timeline
+    std::vector<claim_t>            claims;         // the claims of the operation at hand
+
+    // append to claims the units that the operation starting at op_start_cycle claims
+    virtual void claim(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc)
+    {
+        FATAL("resource " << name << " doesn't support option resource_timeline");
+    }
+
+    bool timeline_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        claims.clear();
+        claim(op_start_cycle, ins, desc);
+        size_t  end = op_start_cycle + std::max<size_t>(operation_duration, 1);
+        for (auto & c : claims)
+        {
+            if (c.unit >= timeline.size())
+            {
+                continue;
+            }
+            // the overlapping reservations are the last ones starting before end that end after op_start_cycle
+            auto & tl = timeline[c.unit];
+            auto it = tl.lower_bound(end);
+            while (it != tl.begin())
+            {
+                --it;
+                if (it->second.to <= op_start_cycle)
+                {
+                    break;
+                }
+                if (c.tag == exclusive || it->second.tag != c.tag)
+                {
+                    DOUT("    " << name << " resource busy for unit " << c.unit << " from cycle " << it->first << " to cycle " << it->second.to);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void timeline_reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        if (operation_duration == 0)
+        {
+            return;
+        }
+        claims.clear();
+        claim(op_start_cycle, ins, desc);
+        size_t  end = op_start_cycle + operation_duration;
+        for (auto & c : claims)
+        {
+            if (c.unit >= timeline.size())
+            {
+                timeline.resize(c.unit+1);
+            }
+            // merge the overlapping reservations, which are compatible, into the new one
+            auto & tl = timeline[c.unit];
+            size_t  from = op_start_cycle;
+            size_t  to = end;
+            auto it = tl.lower_bound(end);
+            while (it != tl.begin())
+            {
+                auto prev = std::prev(it);
+                if (prev->second.to <= op_start_cycle)
+                {
+                    break;
+                }
+                from = std::min(from, prev->first);
+                to = std::max(to, prev->second.to);
+                if (journaling)
+                {
+                    timeline_log.push_back(timeline_undo_t{c.unit, prev->first, prev->second, true});
+                }
+                tl.erase(prev);
+            }
+            tl[from] = reservation_t{to, c.tag};
+            if (journaling)
+            {
+                timeline_log.push_back(timeline_undo_t{c.unit, from, reservation_t{to, c.tag}, false});
+            }
+        }
+    }
+
+    // see next_available; a cycle in which the reservations of a claimed unit all end (fwd) or start (bwd)
+    // is an available candidate; the start of a conflicting reservation is as well, since a claim with a tag
+    // that depends on the start cycle may be compatible with it there
+    size_t timeline_next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        claims.clear();
+        claim(op_start_cycle, ins, desc);
+        bool    fwd = (forward_scheduling == direction);
+        size_t  length = std::max<size_t>(operation_duration, 1);
+        size_t  cycle = op_start_cycle;
+        for (auto & c : claims)
+        {
+            if (c.unit >= timeline.size())
+            {
+                continue;
+            }
+            bool    conflicts = false;
+            size_t  ccycle = 0;             // first candidate cycle of this claim
+            auto & tl = timeline[c.unit];
+            auto it = tl.lower_bound(op_start_cycle + length);
+            while (it != tl.begin())
+            {
+                --it;
+                if (it->second.to <= op_start_cycle)
+                {
+                    break;
+                }
+                if (c.tag != exclusive && it->second.tag == c.tag)
+                {
+                    continue;
+                }
+                size_t  rcycle;
+                if (fwd)
+                {
+                    rcycle = (it->first > op_start_cycle ? it->first : it->second.to);
+                    ccycle = (conflicts ? std::min(ccycle, rcycle) : rcycle);
+                }
+                else
+                {
+                    rcycle = (it->first < op_start_cycle ? it->first : until_cycle(it->first, length));
+                    ccycle = (conflicts ? std::max(ccycle, rcycle) : rcycle);
+                }
+                conflicts = true;
+            }
+            if (conflicts)
+            {
+                cycle = (fwd ? std::max(cycle, ccycle) : std::min(cycle, ccycle));
+            }
+        }
+        return cycle;
+    }
+
+    // changes to the timeline, logged as the changes to the state by assign
+    typedef struct {
+        size_t          unit;       // unit of the changed reservation
+        size_t          from;       // its from cycle
+        reservation_t   reservation;// the reservation
+        bool            erased;     // whether it was erased, otherwise inserted
+    } timeline_undo_t;
+    std::vector<timeline_undo_t>    timeline_log;
+
+    // sizes of the undo logs at a checkpoint
+    typedef struct {
+        size_t          undo;
+        size_t          timeline;
+    } mark_t;
+
+    mark_t mark() const
+    {
+        return mark_t{undo_log.size(), timeline_log.size()};
+    }
+
+    // undo the changes logged since mark
+    void rollback(mark_t mark)
+    {
+        while (undo_log.size() > mark.undo)
+        {
+            *undo_log.back().element = undo_log.back().old;
+            undo_log.pop_back();
+        }
+        while (timeline_log.size() > mark.timeline)
+        {
+            timeline_undo_t& u = timeline_log.back();
+            if (u.erased)
+            {
+                timeline[u.unit][u.from] = u.reservation;
+            }
+            else
+            {
+                timeline[u.unit].erase(u.from);
+            }
+            timeline_log.pop_back();
+        }
+    }
+
     void Print(std::string s)
     {
         DOUT(s);
@@ -62,6 +312,9 @@ protected:
 
     std::vector<resource_t*> resource_ptrs;
 
+    // stack of open checkpoints; each is the mark of the undo logs of each resource when it was made
+    std::vector<std::vector<resource_t::mark_t>> checkpoints;
+
     // constructor needed by mapper::FreeCycle to bridge time from its construction to its Init
     // see the note on the use of constructors and Init functions at the start of mapper.h
     resource_manager_t()
@@ -83,7 +336,8 @@ public:
         DOUT(s);
     }
 
-    // copy constructor doing a deep copy
+    // copy constructor doing a deep copy of the state of the resources, without the checkpoints;
+    // the constant configuration of the resources is shared by the copies (see e.g. qwg_resource_t::config)
     // *orgrptr->clone() does the trick to create a copy of the actual derived class' object
     resource_manager_t(const resource_manager_t& org)
     {
@@ -110,17 +364,51 @@ public:
             delete rptr;
         }
         resource_ptrs = new_resource_ptrs;
+        checkpoints.clear();
         return *this;
     }
 
-    bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    // checkpoint the state of the resources, so that a later rollback can return to it;
+    // checkpoints nest: each rollback returns to the state of the last open checkpoint;
+    // this replaces making a copy of the resource manager to try a schedule on:
+    // while a checkpoint is open, the changes by reserve are logged and undone by rollback,
+    // so trying costs O(changes) instead of O(resources)
+    void checkpoint()
+    {
+        std::vector<resource_t::mark_t> marks;
+        for(auto rptr : resource_ptrs)
+        {
+            marks.push_back(rptr->mark());
+            rptr->journaling = true;
+        }
+        checkpoints.push_back(marks);
+    }
+
+    // return to the state of the last open checkpoint and close it
+    void rollback()
+    {
+        if (checkpoints.empty())
+        {
+            FATAL("resource manager rollback without checkpoint");
+        }
+        std::vector<resource_t::mark_t>& marks = checkpoints.back();
+        for(size_t r = 0; r < resource_ptrs.size(); r++)
+        {
+            resource_ptrs[r]->rollback(marks[r]);
+            resource_ptrs[r]->journaling = (checkpoints.size() > 1);
+        }
+        checkpoints.pop_back();
+    }
+
+    bool available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         // COUT("checking availability of resources for: " << ins->qasm());
         for(auto rptr : resource_ptrs)
         {
             // DOUT("... checking availability for resource " << rptr->name);
-            if( rptr->available(op_start_cycle, ins, operation_name, operation_type, instruction_type, operation_duration) == false)
+            if( (rptr->use_timeline ? rptr->timeline_available(op_start_cycle, ins, desc, operation_duration)
+                                    : rptr->available(op_start_cycle, ins, desc, operation_duration)) == false)
             {
                 // DOUT("... resource " << rptr->name << "not available");
                 return false;
@@ -130,18 +418,41 @@ public:
         return true;
     }
 
-    void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
-        std::string & operation_type, std::string & instruction_type, size_t operation_duration)
+    void reserve(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
     {
         // COUT("reserving resources for: " << ins->qasm());
         for(auto rptr : resource_ptrs)
         {
             // DOUT("... reserving resource " << rptr->name);
-            rptr->reserve(op_start_cycle, ins, operation_name, operation_type, instruction_type, operation_duration);
+            if (rptr->use_timeline)
+            {
+                rptr->timeline_reserve(op_start_cycle, ins, desc, operation_duration);
+            }
+            else
+            {
+                rptr->reserve(op_start_cycle, ins, desc, operation_duration);
+            }
         }
         // DOUT("all resources reserved for: " << ins->qasm());
     }
 
+    // the first cycle from op_start_cycle on (fwd) or from it down (bwd) at which all resources
+    // might be available for the operation, given the reservations made so far (see resource_t::next_available);
+    // a scheduler can continue at that cycle instead of testing available cycle by cycle
+    size_t next_available(size_t op_start_cycle, ql::gate * ins, const ql::instruction_descriptor_t & desc,
+        size_t operation_duration)
+    {
+        size_t  cycle = op_start_cycle;
+        for(auto rptr : resource_ptrs)
+        {
+            size_t rcycle = (rptr->use_timeline ? rptr->timeline_next_available(op_start_cycle, ins, desc, operation_duration)
+                                                : rptr->next_available(op_start_cycle, ins, desc, operation_duration));
+            cycle = (forward_scheduling == rptr->direction ? std::max(cycle, rcycle) : std::min(cycle, rcycle));
+        }
+        return cycle;
+    }
+
     // destructor destroying deep resource_t's
     // runs before shallow destruction which is done by synthesized resource_manager_t destructor
     ~resource_manager_t()
@@ -35,8 +35,16 @@
         This event applies to all operands of CZ, the first operand of CNOT gates, and to all reads in classical code.
         It also applies in general to the control operand of Control Unitaries.
         It represents commutativity between the gates which such use: CU(a,b), CZ(a,c), CZ(d,a) and CNOT(a,e) all commute.
+        It also applies to the operand of single-qubit gates that are diagonal in the Z basis, e.g. Z, S, T and RZ,
+        when option "scheduler_commute_rotations" is yes or their instructions define it.
     - D: such uses can be arbitrarily reordered but are sequentialized with W and R events on the same qubit.
         This event applies to the second operand of CNOT gates: CNOT(a,d) and CNOT(b,d) commute.
+        It also applies to the operand of single-qubit gates that are diagonal in the X basis, e.g. X, X90 and RX,
+        when option "scheduler_commute_rotations" is yes or their instructions define it.
+    Which event each qubit operand of a gate has (with scheduler_post179), is its commutation class:
+    commute_z for R, commute_x for D, and commute_none for W (see commute_t in platform.h);
+    the classes are taken from the "commutation" attribute of the instruction in the platform configuration file,
+    and otherwise derived from the gate's name (see quantum_platform::default_commutation).
     With this, we effectively get the following table of event transitions (from left-bottom to right-up),
     in which 'no' indicates no dependence from left event to top event and '/' indicates a dependence from left to top.
              W   R   D                  w   R   D
@@ -60,44 +68,282 @@
     that the scheduler commutes gates when possible is enabled by default and can be controlled by option "scheduler_commute".
  */
 
-#include <lemon/list_graph.h>
-#include <lemon/lgf_reader.h>
-#include <lemon/lgf_writer.h>
-#include <lemon/dijkstra.h>
-#include <lemon/connectivity.h>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <tuple>
 
 #include "utils.h"
 #include "gate.h"
 #include "circuit.h"
+#include "gate_arena.h"
 #include "ir.h"
 #include "resource_manager.h"
 
 using namespace std;
-using namespace lemon;
 
 // see above/below for the meaning of R, W, and D events and their relation to dependences
 enum DepTypes{RAW, WAW, WAR, RAR, RAD, DAR, DAD, WAD, DAW};
 const string DepTypesNames[] = {"RAW", "WAW", "WAR", "RAR", "RAD", "DAR", "DAD", "WAD", "DAW"};
+#define DEPTYPE_COUNT   9
+
+#define INVALID_NODE    (-1)    // no node; in LastWriter: the last writer is not in the dependence graph
+
+// The dependence graph, in compressed sparse row (CSR) form.
+// Nodes are numbered from 0 in the order in which they are added, which is a topological order:
+// s (when there) is first, then the gates in circuit order, and t (when there) is last.
+// Arcs are only added to the last added node, so the predecessors of each node form one slice of predarcs;
+// when the next node is added, duplicate arcs in that slice (with the same source but e.g. another cause)
+// are removed, so that each pair of nodes is connected by at most one arc.
+// close() computes the successor lists from the predecessor lists in one pass when all nodes have been added.
+// The arcs of a node are in reverse order of their creation (for successors: from high to low node number);
+// this is the order in which LEMON's ListDigraph iterates arcs,
+// and schedules depend on it because nodes are made available in that order.
+// Of each arc, only the other node and the dependence type and cause of the last duplicate are kept;
+// its weight is the duration of the source node in cycles, which is kept per node by the Scheduler.
+class DepGraph
+{
+public:
+    typedef int Node;
+
+    typedef struct
+    {
+        Node            node;   // the other node: the source when in predarcs, the target when in succarcs
+        unsigned int    dep;    // cause*DEPTYPE_COUNT + dependence type
+    } arc_t;
+
+    // the arcs of one node, to iterate over as in: for (auto & a : graph.preds(n))
+    class arcs_t
+    {
+    public:
+        const arc_t*    first;
+        const arc_t*    last;
+        const arc_t*    begin() const { return first; }
+        const arc_t*    end() const { return last; }
+        bool            empty() const { return first == last; }
+    };
+
+    std::vector<size_t> predindex;  // predecessors of n are predarcs[predindex[n]] up to predarcs[predindex[n+1]]
+    std::vector<arc_t>  predarcs;
+    std::vector<size_t> succindex;  // successors of n are succarcs[succindex[n]] up to succarcs[succindex[n+1]]
+    std::vector<arc_t>  succarcs;
+    std::vector<Node>   lastsrc;    // lastsrc[m] == n while removing the duplicates of n when m is a source of n
+    size_t              nnodes = 0;
+
+    void clear()
+    {
+        predindex.clear();
+        predarcs.clear();
+        succindex.clear();
+        succarcs.clear();
+        lastsrc.clear();
+        nnodes = 0;
+    }
+
+    size_t size() const
+    {
+        return nnodes;
+    }
+
+    Node add_node()
+    {
+        if (nnodes != 0)
+        {
+            close_preds(nnodes-1);
+        }
+        predindex.push_back(predarcs.size());
+        lastsrc.push_back(INVALID_NODE);
+        return nnodes++;
+    }
+
+    // add an arc from src to tgt, which must be the last added node
+    void add_arc(Node src, Node tgt, int deptype, int cause)
+    {
+        arc_t   a;
+        a.node = src;
+        a.dep = cause*DEPTYPE_COUNT + deptype;
+        predarcs.push_back(a);
+    }
+
+    // put the predecessors of n, the last added node, in reverse order of creation and remove the duplicates
+    void close_preds(Node n)
+    {
+        std::reverse(predarcs.begin()+predindex[n], predarcs.end());
+        size_t  w = predindex[n];
+        for (size_t r = predindex[n]; r < predarcs.size(); r++)
+        {
+            Node    src = predarcs[r].node;
+            if (lastsrc[src] != n)
+            {
+                lastsrc[src] = n;
+                predarcs[w++] = predarcs[r];
+            }
+        }
+        predarcs.resize(w);
+    }
+
+    // finish the graph: after this, no nodes can be added but preds and succs can be used
+    void close()
+    {
+        if (nnodes != 0)
+        {
+            close_preds(nnodes-1);
+        }
+        predindex.push_back(predarcs.size());
+        std::vector<Node>().swap(lastsrc);
+
+        succindex.assign(nnodes+1, 0);
+        for (auto & a : predarcs)
+        {
+            succindex[a.node+1]++;
+        }
+        for (size_t n = 0; n < nnodes; n++)
+        {
+            succindex[n+1] += succindex[n];
+        }
+        succarcs.resize(predarcs.size());
+        std::vector<size_t> next(succindex.begin(), succindex.end()-1);
+        for (Node tgt = Node(nnodes)-1; tgt >= 0; tgt--)
+        {
+            for (auto & a : preds(tgt))
+            {
+                arc_t   sa;
+                sa.node = tgt;
+                sa.dep = a.dep;
+                succarcs[next[a.node]++] = sa;
+            }
+        }
+    }
+
+    arcs_t preds(Node n) const
+    {
+        arcs_t  as;
+        as.first = predarcs.data() + predindex[n];
+        as.last = predarcs.data() + predindex[n+1];
+        return as;
+    }
+
+    arcs_t succs(Node n) const
+    {
+        arcs_t  as;
+        as.first = succarcs.data() + succindex[n];
+        as.last = succarcs.data() + succindex[n+1];
+        return as;
+    }
+
+    static int deptype(const arc_t& a)
+    {
+        return a.dep % DEPTYPE_COUNT;
+    }
+
+    static int cause(const arc_t& a)
+    {
+        return a.dep / DEPTYPE_COUNT;
+    }
+};
+
+// the avlist: the nodes that are available for scheduling (see MakeAvailable);
+// it is ordered on deep-criticality, highest first (see set_rank),
+// and among equally deep-critical nodes on the order in which they were made available;
+// it is keyed on the precomputed rank of the nodes so that inserting and erasing a node is O(log n)
+class avlist_t
+{
+public:
+    typedef std::pair<size_t,size_t>    key_t;      // (rank, sequence number of making available)
+    struct key_order
+    {
+        bool operator()(const key_t& k1, const key_t& k2) const
+        {
+            return k1.first > k2.first || (k1.first == k2.first && k1.second < k2.second);
+        }
+    };
+    std::map<key_t,DepGraph::Node,key_order> nodes;     // the available nodes in avlist order
+    std::map<DepGraph::Node,key_t>              keys;   // keys[n] is the key of available node n in nodes
+    size_t                                      nextseq = 0;
+
+    bool empty() const
+    {
+        return nodes.empty();
+    }
+
+    size_t size() const
+    {
+        return nodes.size();
+    }
+
+    void clear()
+    {
+        nodes.clear();
+        keys.clear();
+        nextseq = 0;
+    }
+
+    bool contains(DepGraph::Node n) const
+    {
+        return keys.count(n) != 0;
+    }
+
+    // add n with the given rank after the nodes with the same or higher rank
+    void insert(DepGraph::Node n, size_t rank)
+    {
+        key_t   k(rank, nextseq++);
+        nodes[k] = n;
+        keys[n] = k;
+    }
+
+    void erase(DepGraph::Node n)
+    {
+        auto it = keys.find(n);
+        if (it != keys.end())
+        {
+            nodes.erase(it->second);
+            keys.erase(it);
+        }
+    }
+
+    void swap(avlist_t& other)
+    {
+        nodes.swap(other.nodes);
+        keys.swap(other.keys);
+        std::swap(nextseq, other.nextseq);
+    }
+
+    // reorder on the given recomputed ranks;
+    // among nodes of equal rank, their current order is kept (as by a stable sort)
+    void rerank(const std::vector<size_t>& rank)
+    {
+        std::map<key_t,DepGraph::Node,key_order> oldnodes;
+        oldnodes.swap(nodes);
+        nextseq = 0;
+        for (auto & kn : oldnodes)
+        {
+            key_t   k(rank[kn.second], nextseq++);
+            nodes[k] = kn.second;
+            keys[kn.second] = k;
+        }
+    }
+};
 
 class Scheduler
 {
 public:
     // dependence graph is constructed (see Init) once from the sequence of gates in a kernel's circuit
     // it can be reused as often as needed as long as no gates are added/deleted; it doesn't modify those gates
-    ListDigraph graph;
+    DepGraph graph;
 
     // conversion between gate* (pointer to the gate in the circuit) and node (of the dependence graph)
-    ListDigraph::NodeMap<ql::gate*> instruction;// instruction[n] == gate*
-    std::map<ql::gate*,ListDigraph::Node>  node;// node[gate*] == n
+    std::vector<ql::gate*>  instruction;        // instruction[n] == gate*
+    std::unordered_map<ql::gate*,DepGraph::Node> node;  // node[gate*] == n
 
-    // attributes
-    ListDigraph::NodeMap<std::string> name;     // name[n] == qasm string
-    ListDigraph::ArcMap<int> weight;            // number of cycles of dependence
-    ListDigraph::ArcMap<int> cause;             // qubit/creg index of dependence
-    ListDigraph::ArcMap<int> depType;           // RAW, WAW, ...
+    // attributes; the qasm string of node n is instruction[n]->qasm(), computed only when printing
+    std::vector<int>        weight;             // number of cycles of the dependences on n, i.e. n's duration
+    std::vector<const ql::instruction_descriptor_t*> descriptor;    // platform's descriptor of instruction[n], see GetDescriptor
 
     // s and t nodes are the top and bottom of the dependence graph
-    ListDigraph::Node s, t;                     // instruction[s]==SOURCE, instruction[t]==SINK
+    DepGraph::Node          s, t;               // instruction[s]==SOURCE, instruction[t]==SINK
+    ql::gate*               sourcegp = NULL;    // the SOURCE and SINK gates, created once, see add_node
+    ql::gate*               sinkgp = NULL;
+    std::shared_ptr<ql::gate_arena_t> gatesp = std::make_shared<ql::gate_arena_t>();  // owns them; shared by copies
 
     // parameters of dependence graph construction
     size_t          cycle_time;                 // to convert durations to cycles as weight of dependence
@@ -105,14 +351,37 @@ public:
     size_t          creg_count;                 // number of cregs, to check/represent creg as cause of dependence
     ql::circuit*    circp;                      // current and result circuit, passed from Init to each scheduler
 
+    // state of dependence graph construction, see init_begin and add_gate;
+    // dependences are created with a current gate as target
+    // and with those previous gates as source that have an operand match:
+    // - the previous gates that Read r in LastReaders[r]; this is a list
+    // - the previous gates that D qubit q in LastDs[q]; this is a list
+    // - the previous gate that Wrote r in LastWriter[r]; this can only be one, or INVALID_NODE
+    // operands can be a qubit or a classical register
+    // - when the last events on q are a run of R (/D) events, the previous gates of the run of D (/R) events
+    //   before it, after the last Write, in LastPrevRun[q]; each event of the current run depends on these;
+    //   it is stale (and ignored) when not after LastWriter[q]
+    typedef vector<int> ReadersListType;
+    vector<ReadersListType> LastReaders;
+    vector<ReadersListType> LastDs;
+    vector<ReadersListType> LastPrevRun;
+    vector<int>             LastWriter;
+    const ql::quantum_platform* platformp = NULL;   // platform of last init_begin, for the commutation classes
+
     // scheduler support
-    std::map< std::pair<std::string,std::string>, size_t> buffer_cycles_map;
-    std::map<ListDigraph::Node,size_t>  remaining;  // remaining[node] == cycles until end; critical path representation
+    std::vector<size_t>     remaining;  // remaining[node] == cycles until end; critical path representation
+
+    // deep-criticality (see set_deepcrit_gate), computed together with remaining:
+    std::vector<size_t>         critdep;    // largest remaining of the depending nodes
+    std::vector<size_t>         ncritdep;   // number of depending nodes with that remaining; 0 when none
+    std::vector<DepGraph::Node> bestdep;    // most deep-critical of those, INVALID_NODE when none
+    std::vector<size_t>         critclass;  // nodes with equal critclass are equally deep-critical
+    std::map<std::tuple<size_t,size_t,size_t,size_t>,size_t> critclasses;   // critclass of each signature
+    std::vector<size_t>         rank;       // rank[node] == position in deep-criticality order, higher is more critical
 
 
 public:
-    Scheduler(): instruction(graph), name(graph), weight(graph),
-        cause(graph), depType(graph) {}
+    Scheduler() {}
 
     // ins->name may contain parameters, so must be stripped first before checking it for gate's name
     void stripname(std::string& name)
@@ -124,23 +393,52 @@ public:
         }
     }
 
+    // add a node for gate gp to the dependence graph
+    DepGraph::Node add_node(ql::gate* gp)
+    {
+        DepGraph::Node n = graph.add_node();
+        instruction.push_back(gp);
+        weight.push_back(std::ceil( static_cast<float>(gp->duration) / cycle_time));
+        // weight.push_back((gp->duration + cycle_time -1)/cycle_time);
+        descriptor.push_back(NULL);
+        node[gp] = n;
+        return n;
+    }
+
     // factored out code from Init to add a dependence between two nodes
     // operand is in qubit_creg combined index space
+    // no dependence is added from a node that is not in the graph (see restart)
     void add_dep(int srcID, int tgtID, enum DepTypes deptype, int operand)
     {
         DOUT(".. adddep ...");
-        ListDigraph::Node srcNode = graph.nodeFromId(srcID);
-        ListDigraph::Node tgtNode = graph.nodeFromId(tgtID);
-        ListDigraph::Arc arc = graph.addArc(srcNode,tgtNode);
-        weight[arc] = std::ceil( static_cast<float>(instruction[srcNode]->duration) / cycle_time);
-        // weight[arc] = (instruction[srcNode]->duration + cycle_time -1)/cycle_time;
-        cause[arc] = operand;
-        depType[arc] = deptype;
-        DOUT("... dep " << name[srcNode] << " -> " << name[tgtNode] << " (opnd=" << operand << ", dep=" << DepTypesNames[deptype] << ", wght=" << weight[arc] << ")");
+        if (srcID == INVALID_NODE)
+        {
+            return;
+        }
+        graph.add_arc(srcID, tgtID, deptype, operand);
+        DOUT("... dep " << instruction[srcID]->qasm() << " -> " << instruction[tgtID]->qasm() << " (opnd=" << operand << ", dep=" << DepTypesNames[deptype] << ", wght=" << weight[srcID] << ")");
     }
 
     // fill the dependence graph ('graph') with nodes from the circuit and adding arcs for their dependences
-    void init(ql::circuit& ckt, ql::quantum_platform platform, size_t qcount, size_t ccount)
+    void init(ql::circuit& ckt, const ql::quantum_platform& platform, size_t qcount, size_t ccount)
+    {
+        init_begin(ckt, platform, qcount, ccount);
+        node.reserve(ckt.size()+2);
+
+        // for each gate pointer ins in the circuit, add a node and add dependences from previous gates to it
+        for( auto ins : ckt )
+        {
+            add_gate(ins);
+        }
+
+        init_end();
+    }
+
+    // the dependence graph can also be constructed incrementally, gate by gate, as init does above;
+    // init_begin initializes it and creates the s node, add_gate adds the next gate of the circuit to it,
+    // and init_end closes it by creating the t node;
+    // restart can start the construction again, for a part of the circuit (see restart)
+    void init_begin(ql::circuit& ckt, const ql::quantum_platform& platform, size_t qcount, size_t ccount)
     {
         DOUT("Dependence graph creation ...");
         qubit_count = qcount;
@@ -149,496 +447,556 @@ public:
         DOUT("Scheduler.init: qubit_count=" << qubit_count << ", creg_count=" << creg_count << ", total=" << qubit_creg_count);
         cycle_time = platform.cycle_time;
         circp = &ckt;
+        platformp = &platform;
 
-        // populate buffer map
-        // 'none' type is a dummy type and 0 buffer cycles will be inserted for
-        // instructions of type 'none'
-        //
-        // this has nothing to do with dependence graph generation but with scheduling
-        // so should be in resource-constrained scheduler constructor
-        std::vector<std::string> buffer_names = {"none", "mw", "flux", "readout"};
-        for(auto & buf1 : buffer_names)
-        {
-            for(auto & buf2 : buffer_names)
-            {
-                auto bpair = std::pair<std::string,std::string>(buf1,buf2);
-                auto bname = buf1+ "_" + buf2 + "_buffer";
-                if(platform.hardware_settings.count(bname) > 0)
-                {
-                    buffer_cycles_map[ bpair ] = std::ceil( 
-                        static_cast<float>(platform.hardware_settings[bname]) / cycle_time);
-                }
-                // DOUT("Initializing " << bname << ": "<< buffer_cycles_map[bpair]);
-            }
-        }
+        restart(true);
+    }
+
+    // start constructing the dependence graph again, with the parameters of the last init_begin;
+    // without s (withs false), the gates added next don't depend on anything before them;
+    // this is used to construct a graph for the remaining part of a window of a circuit (see Future::Refill)
+    void restart(bool withs)
+    {
+        size_t qubit_creg_count = qubit_count + creg_count;
+        graph.clear();
+        instruction.clear();
+        weight.clear();
+        descriptor.clear();
+        node.clear();
 
         // dependences are created with a current gate as target
-        // and with those previous gates as source that have an operand match:
-        // - the previous gates that Read r in LastReaders[r]; this is a list
-        // - the previous gates that D qubit q in LastDs[q]; this is a list
-        // - the previous gate that Wrote r in LastWriter[r]; this can only be one
-        // operands can be a qubit or a classical register
-        typedef vector<int> ReadersListType;
-
-        vector<ReadersListType> LastReaders;
+        // and with those previous gates as source that have an operand match,
+        // as maintained in LastReaders, LastDs and LastWriter (see their declarations)
+        LastReaders.clear();
         LastReaders.resize(qubit_creg_count);
-
-        vector<ReadersListType> LastDs;
+        LastDs.clear();
         LastDs.resize(qubit_creg_count);
+        LastPrevRun.clear();
+        LastPrevRun.resize(qubit_creg_count);
 
         // start filling the dependence graph by creating the s node, the top of the graph
+        if (withs)
         {
             // add dummy source node
-            ListDigraph::Node srcNode = graph.addNode();
-            instruction[srcNode] = new ql::SOURCE();    // so SOURCE is defined as instruction[s], not unique in itself
-            node[instruction[srcNode]] = srcNode;
-            name[srcNode] = instruction[srcNode]->qasm();
-            s=srcNode;
+            if (sourcegp == NULL)
+            {
+                sourcegp = gatesp->create<ql::SOURCE>();            // so SOURCE is defined as instruction[s], not unique in itself
+            }
+            s = add_node(sourcegp);
+            LastWriter.assign(qubit_creg_count,s);      // it implicitly writes to all qubits and class. regs
+        }
+        else
+        {
+            s = INVALID_NODE;
+            LastWriter.assign(qubit_creg_count,INVALID_NODE);
         }
-        int srcID = graph.id(s);
-        vector<int> LastWriter(qubit_creg_count,srcID);     // it implicitly writes to all qubits and class. regs
+        t = INVALID_NODE;                               // until init_end
+    }
 
-        // for each gate pointer ins in the circuit, add a node and add dependences from previous gates to it
-        for( auto ins : ckt )
+    // whether LastPrevRun[r] is the run before the current run of R or D events on r, i.e. it is not stale;
+    // it is stale when r was written after it, since nodes are numbered in circuit order
+    bool IsPrevRun(size_t r)
+    {
+        return !LastPrevRun[r].empty() && LastPrevRun[r].back() > LastWriter[r];
+    }
+
+    // add a node for gate ins, the next one of the circuit, and add dependences from previous gates to it
+    void add_gate(ql::gate* ins)
+    {
+        size_t qubit_creg_count = qubit_count + creg_count;
+        DOUT("Current instruction's name: `" << ins->name << "'");
+        DOUT(".. Qasm(): " << ins->qasm());
+        for( auto operand : ins->operands ) DOUT(".. Operand: `" << operand << "'");
+        for( auto coperand : ins->creg_operands ) DOUT(".. Classical operand: `" << coperand << "'");
+
+        auto iname = ins->name; // copy!!!!
+        stripname(iname);
+
+        // Add node
+        int consID = add_node(ins);
+
+        // Add edges (arcs)
+        // In quantum computing there are no real Reads and Writes on qubits because they cannot be cloned.
+        // Every qubit use influences the qubit, updates it, so would be considered a Read+Write at the same time.
+        // In dependence graph construction, this leads to WAW-dependence chains of all uses of the same qubit,
+        // and hence in a scheduler using this graph to a sequentialization of those uses in the original program order.
+        //
+        // For a scheduler, only the presence of a dependence counts, not its type (RAW/WAW/etc.).
+        // A dependence graph also has other uses apart from the scheduler: e.g. to find chains of live qubits,
+        // from their creation (Prep etc.) to their destruction (Measure, etc.) in allocation of virtual to real qubits.
+        // For those uses it makes sense to make a difference with a gate doing a Read+Write, just a Write or just a Read:
+        // a Prep creates a new 'value' (Write); wait, display, x, swap, cnot, all pass this value on (so Read+Write),
+        // while a Measure 'destroys' the 'value' (Read+Write of the qubit, Write of the creg),
+        // the destruction aspect of a Measure being implied by it being followed by a Prep (Write only) on the same qubit.
+        // Furthermore Writes can model barriers on a qubit (see Wait, Display, etc.), because Writes sequentialize.
+        // The dependence graph creation below models a graph suitable for all functions, including chains of live qubits.
+
+        if (ql::options::get("scheduler_post179") == "yes")
+        {
+        // Control-operands of Controlled Unitaries commute, independent of the Unitary,
+        // i.e. these gates need not be kept in order.
+        // But, of course, those qubit uses should be ordered after (/before) the last (/next) non-control use of the qubit.
+        // In this way, those control-operand qubit uses would be like pure Reads in dependence graph construction.
+        // A problem might be that the gates with the same control-operands might be scheduled in parallel then.
+        // In a non-resource scheduler that will happen but it doesn't do harm because it is not a real machine.
+        // In a resource-constrained scheduler the resource constraint that prohibits more than one use
+        // of the same qubit being active at the same time, will prevent this parallelism.
+        // So ignoring Read After Read (RAR) dependences enables the scheduler to take advantage
+        // of the commutation property of Controlled Unitaries without disadvantages.
+        //
+        // In more detail:
+        // 1. CU1(a,b) and CU2(a,c) commute (for any U1, U2, so also can be equal and/or be CNOT and/or be CZ)
+        // 2. CNOT(a,b) and CNOT(c,b) commute (property of CNOT only).
+        // 3. CZ(a,b) and CZ(b,a) are identical (property of CZ only).
+        // 4. CNOT(a,b) commutes with CZ(a,c) (from 1.) and thus with CZ(c,a) (from 3.)
+        // 5. CNOT(a,b) does not commute with CZ(c,b) (and thus not with CZ(b,c), from 3.)
+        // 6. Single-qubit gates diagonal in the Z basis (Z, S, T, RZ, ...) commute with each other,
+        //    and with CZ and the control operand of CNOT (these are diagonal in the Z basis on that operand).
+        // 7. Single-qubit gates diagonal in the X basis (X, X90, RX, ...) commute with each other,
+        //    and with the target operand of CNOT (which is diagonal in the X basis on that operand).
+        // To support this, next to R and W a D (for controlleD operand :-) is introduced for the target operand of CNOT.
+        // The events (instead of just Read and Write) become then:
+        // - Both operands of CZ are just Read.
+        // - The control operand of CNOT is Read, the target operand is D.
+        // - The operand of a single-qubit gate diagonal in the Z basis is Read, in the X basis it is D.
+        // - Of any other Control Unitary, the control operand is Read and the target operand is Write (not D!)
+        // - Of any other gate the operands are Read+Write or just Write (as usual to represent flow).
+        // These events are not coded here per gate but are given by the commutation class of each operand,
+        // commute_z for R, commute_x for D and commute_none for W, which can be defined in the platform configuration;
+        // see quantum_platform::default_commutation for the gates above when not defined there;
+        // the defaults of 6. and 7. only apply with option scheduler_commute_rotations.
+        // With this, we effectively get the following table of event transitions (from left-bottom to right-up),
+        // in which 'no' indicates no dependence from left event to top event and '/' indicates a dependence from left to top.
+        //
+        //             W   R   D                  w   R   D
+        //        W    /   /   /              W   WAW RAW DAW
+        //        R    /   no  /              R   WAR RAR DAR
+        //        D    /   /   no             D   WAD RAD DAD
+        //
+        // In addition to LastReaders, we introduce LastDs.
+        // Either one is cleared when dependences are generated from them, and extended otherwise.
+        // From the table it can be seen that the D 'behaves' as a Write to Read, and as a Read to Write,
+        // that there is no order among Ds nor among Rs, but D after R and R after D sequentialize.
+        // So all Ds of a run of Ds depend on all Rs of the run of Rs before it, and vice-versa;
+        // the run before the current one is kept in LastPrevRun, for the later events of the current run.
+        // With this, the dependence graph is claimed to represent the commutations as above.
+        //
+        // The post179 schedulers are list schedulers, i.e. they maintain a list of gates in their algorithm,
+        // of gates available for being scheduled because they are not blocked by dependences on non-scheduled gates.
+        // Therefore, the post179 schedulers are able to select the best one from a set of commutable gates.
+        }
+
+        // with scheduler_post179, the commutation classes of the qubit operands determine their events;
+        // the gate commutes with others when it has an operand with a class other than commute_none
+        bool commutes = false;
+        std::vector<ql::commute_t> default_commutation;     // only filled for gates without descriptor
+        const std::vector<ql::commute_t>* commutationp = &default_commutation;
+        if (ql::options::get("scheduler_post179") == "yes")
         {
-            DOUT("Current instruction's name: `" << ins->name << "'");
-            DOUT(".. Qasm(): " << ins->qasm());
-            for( auto operand : ins->operands ) DOUT(".. Operand: `" << operand << "'");
-            for( auto coperand : ins->creg_operands ) DOUT(".. Classical operand: `" << coperand << "'");
-
-            auto iname = ins->name; // copy!!!!
-            stripname(iname);
-
-            // Add node
-            ListDigraph::Node consNode = graph.addNode();
-            int consID = graph.id(consNode);
-            instruction[consNode] = ins;
-            node[ins] = consNode;
-            name[consNode] = ins->qasm();
-
-            // Add edges (arcs)
-            // In quantum computing there are no real Reads and Writes on qubits because they cannot be cloned.
-            // Every qubit use influences the qubit, updates it, so would be considered a Read+Write at the same time.
-            // In dependence graph construction, this leads to WAW-dependence chains of all uses of the same qubit,
-            // and hence in a scheduler using this graph to a sequentialization of those uses in the original program order.
-            //
-            // For a scheduler, only the presence of a dependence counts, not its type (RAW/WAW/etc.).
-            // A dependence graph also has other uses apart from the scheduler: e.g. to find chains of live qubits,
-            // from their creation (Prep etc.) to their destruction (Measure, etc.) in allocation of virtual to real qubits.
-            // For those uses it makes sense to make a difference with a gate doing a Read+Write, just a Write or just a Read:
-            // a Prep creates a new 'value' (Write); wait, display, x, swap, cnot, all pass this value on (so Read+Write),
-            // while a Measure 'destroys' the 'value' (Read+Write of the qubit, Write of the creg),
-            // the destruction aspect of a Measure being implied by it being followed by a Prep (Write only) on the same qubit.
-            // Furthermore Writes can model barriers on a qubit (see Wait, Display, etc.), because Writes sequentialize.
-            // The dependence graph creation below models a graph suitable for all functions, including chains of live qubits.
-
-            if (ql::options::get("scheduler_post179") == "yes")
-            {
-            // Control-operands of Controlled Unitaries commute, independent of the Unitary,
-            // i.e. these gates need not be kept in order.
-            // But, of course, those qubit uses should be ordered after (/before) the last (/next) non-control use of the qubit.
-            // In this way, those control-operand qubit uses would be like pure Reads in dependence graph construction.
-            // A problem might be that the gates with the same control-operands might be scheduled in parallel then.
-            // In a non-resource scheduler that will happen but it doesn't do harm because it is not a real machine.
-            // In a resource-constrained scheduler the resource constraint that prohibits more than one use
-            // of the same qubit being active at the same time, will prevent this parallelism.
-            // So ignoring Read After Read (RAR) dependences enables the scheduler to take advantage
-            // of the commutation property of Controlled Unitaries without disadvantages.
-            //
-            // In more detail:
-            // 1. CU1(a,b) and CU2(a,c) commute (for any U1, U2, so also can be equal and/or be CNOT and/or be CZ)
-            // 2. CNOT(a,b) and CNOT(c,b) commute (property of CNOT only).
-            // 3. CZ(a,b) and CZ(b,a) are identical (property of CZ only).
-            // 4. CNOT(a,b) commutes with CZ(a,c) (from 1.) and thus with CZ(c,a) (from 3.)
-            // 5. CNOT(a,b) does not commute with CZ(c,b) (and thus not with CZ(b,c), from 3.)
-            // To support this, next to R and W a D (for controlleD operand :-) is introduced for the target operand of CNOT.
-            // The events (instead of just Read and Write) become then:
-            // - Both operands of CZ are just Read.
-            // - The control operand of CNOT is Read, the target operand is D.
-            // - Of any other Control Unitary, the control operand is Read and the target operand is Write (not D!)
-            // - Of any other gate the operands are Read+Write or just Write (as usual to represent flow).
-            // With this, we effectively get the following table of event transitions (from left-bottom to right-up),
-            // in which 'no' indicates no dependence from left event to top event and '/' indicates a dependence from left to top.
-            //
-            //             W   R   D                  w   R   D
-            //        W    /   /   /              W   WAW RAW DAW
-            //        R    /   no  /              R   WAR RAR DAR
-            //        D    /   /   no             D   WAD RAD DAD
-            //
-            // In addition to LastReaders, we introduce LastDs.
-            // Either one is cleared when dependences are generated from them, and extended otherwise.
-            // From the table it can be seen that the D 'behaves' as a Write to Read, and as a Read to Write,
-            // that there is no order among Ds nor among Rs, but D after R and R after D sequentialize.
-            // With this, the dependence graph is claimed to represent the commutations as above.
-            //
-            // The post179 schedulers are list schedulers, i.e. they maintain a list of gates in their algorithm,
-            // of gates available for being scheduled because they are not blocked by dependences on non-scheduled gates.
-            // Therefore, the post179 schedulers are able to select the best one from a set of commutable gates.
+            bool rotations = (ql::options::get("scheduler_commute_rotations") == "yes");
+            const ql::instruction_descriptor_t* dp = (platformp == NULL ? NULL : platformp->find_descriptor(ins->name));
+            if (dp == NULL)
+            {
+                default_commutation = ql::quantum_platform::default_commutation(iname, rotations);
+            }
+            else
+            {
+                commutationp = (rotations ? &dp->commutation_rotations : &dp->commutation);
+            }
+            for (auto c : *commutationp)
+            {
+                commutes = commutes || (c != ql::commute_none);
             }
+        }
+        const std::vector<ql::commute_t>& commutation = *commutationp;
 
-            // each type of gate has a different 'signature' of events; switch out to each one
+        // each type of gate has a different 'signature' of events; switch out to each one
 
-            // TODO: define signature in .json file similar to how gcc defines instructions
-            // and then have a signature interpreter here; then we don't have this long if-chain
-            // and, more importantly, we don't have the knowledge of particular gates here;
-            // the default signature would be that of a default gate, modifying each qubit operand;
-            // that also solves
-            if(iname == "measure")
+        // TODO: define signature in .json file similar to how gcc defines instructions
+        // and then have a signature interpreter here; then we don't have this long if-chain
+        // and, more importantly, we don't have the knowledge of particular gates here;
+        // the default signature would be that of a default gate, modifying each qubit operand;
+        // that also solves
+        if(iname == "measure")
+        {
+            DOUT(". considering " << ins->qasm() << " as measure");
+            // Read+Write each qubit operand + Write corresponding creg
+            auto operands = ins->operands;
+            for( auto operand : operands )
             {
-                DOUT(". considering " << name[consNode] << " as measure");
-                // Read+Write each qubit operand + Write corresponding creg
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[operand])
                 {
-                    DOUT(".. Operand: " << operand);
-                    add_dep(LastWriter[operand], consID, WAW, operand);
-                    for(auto & readerID : LastReaders[operand])
+                    add_dep(readerID, consID, WAR, operand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        add_dep(readerID, consID, WAR, operand);
-                    }
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        for(auto & readerID : LastDs[operand])
-                        {
-                            add_dep(readerID, consID, WAD, operand);
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
                 }
+            }
 
-                for( auto coperand : ins->creg_operands )
+            for( auto coperand : ins->creg_operands )
+            {
+                DOUT(".. Classical operand: " << coperand);
+                add_dep(LastWriter[qubit_count+coperand], consID, WAW, qubit_count+coperand);
+                for(auto & readerID : LastReaders[qubit_count+coperand])
                 {
-                    DOUT(".. Classical operand: " << coperand);
-                    add_dep(LastWriter[qubit_count+coperand], consID, WAW, qubit_count+coperand);
-                    for(auto & readerID : LastReaders[qubit_count+coperand])
-                    {
-                        add_dep(readerID, consID, WAR, qubit_count+coperand);
-                    }
+                    add_dep(readerID, consID, WAR, qubit_count+coperand);
                 }
+            }
 
-                // update LastWriter and so clear LastReaders
-                for( auto operand : operands )
+            // update LastWriter and so clear LastReaders
+            for( auto operand : operands )
+            {
+                DOUT(".. Update LastWriter for operand: " << operand);
+                LastWriter[operand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
                 {
-                    DOUT(".. Update LastWriter for operand: " << operand);
-                    LastWriter[operand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        DOUT(".. Clearing LastReaders for operand: " << operand);
-                        LastReaders[operand].clear();
-                        LastDs[operand].clear();
-                    }
-                    DOUT(".. Update LastWriter done");
+                    DOUT(".. Clearing LastReaders for operand: " << operand);
+                    LastReaders[operand].clear();
+                    LastDs[operand].clear();
                 }
-                for( auto coperand : ins->creg_operands )
+                DOUT(".. Update LastWriter done");
+            }
+            for( auto coperand : ins->creg_operands )
+            {
+                DOUT(".. Update LastWriter for coperand: " << coperand);
+                LastWriter[qubit_count+coperand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
                 {
-                    DOUT(".. Update LastWriter for coperand: " << coperand);
-                    LastWriter[qubit_count+coperand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        DOUT(".. Clearing LastReaders for coperand: " << coperand);
-                        LastReaders[qubit_count+coperand].clear();
-                    }
-                    DOUT(".. Update LastWriter done");
+                    DOUT(".. Clearing LastReaders for coperand: " << coperand);
+                    LastReaders[qubit_count+coperand].clear();
                 }
-                DOUT(". measure done");
+                DOUT(".. Update LastWriter done");
             }
-            else if(iname == "display")
+            DOUT(". measure done");
+        }
+        else if(iname == "display")
+        {
+            DOUT(". considering " << ins->qasm() << " as display");
+            // no operands, display all qubits and cregs
+            // Read+Write each operand
+            std::vector<size_t> qubits(qubit_creg_count);
+            std::iota(qubits.begin(), qubits.end(), 0);
+            for( auto operand : qubits )
             {
-                DOUT(". considering " << name[consNode] << " as display");
-                // no operands, display all qubits and cregs
-                // Read+Write each operand
-                std::vector<size_t> qubits(qubit_creg_count);
-                std::iota(qubits.begin(), qubits.end(), 0);
-                for( auto operand : qubits )
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[operand])
                 {
-                    DOUT(".. Operand: " << operand);
-                    add_dep(LastWriter[operand], consID, WAW, operand);
-                    for(auto & readerID : LastReaders[operand])
-                    {
-                        add_dep(readerID, consID, WAR, operand);
-                    }
-                    if (ql::options::get("scheduler_post179") == "yes")
+                    add_dep(readerID, consID, WAR, operand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        for(auto & readerID : LastDs[operand])
-                        {
-                            add_dep(readerID, consID, WAD, operand);
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
                 }
+            }
 
-                // now update LastWriter and so clear LastReaders/LastDs
-                for( auto operand : qubits )
+            // now update LastWriter and so clear LastReaders/LastDs
+            for( auto operand : qubits )
+            {
+                LastWriter[operand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
                 {
-                    LastWriter[operand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        LastReaders[operand].clear();
-                        LastDs[operand].clear();
-                    }
+                    LastReaders[operand].clear();
+                    LastDs[operand].clear();
                 }
             }
-            else if(ins->type() == ql::gate_type_t::__classical_gate__)
+        }
+        else if(ins->type() == ql::gate_type_t::__classical_gate__)
+        {
+            DOUT(". considering " << ins->qasm() << " as classical gate");
+            // Read+Write each classical operand
+            for( auto coperand : ins->creg_operands )
             {
-                DOUT(". considering " << name[consNode] << " as classical gate");
-                // Read+Write each classical operand
-                for( auto coperand : ins->creg_operands )
+                DOUT("... Classical operand: " << coperand);
+                add_dep(LastWriter[qubit_count+coperand], consID, WAW, qubit_count+coperand);
+                for(auto & readerID : LastReaders[qubit_count+coperand])
                 {
-                    DOUT("... Classical operand: " << coperand);
-                    add_dep(LastWriter[qubit_count+coperand], consID, WAW, qubit_count+coperand);
-                    for(auto & readerID : LastReaders[qubit_count+coperand])
-                    {
-                        add_dep(readerID, consID, WAR, qubit_count+coperand);
-                    }
-                    if (ql::options::get("scheduler_post179") == "yes")
+                    add_dep(readerID, consID, WAR, qubit_count+coperand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[qubit_count+coperand])
                     {
-                        for(auto & readerID : LastDs[qubit_count+coperand])
-                        {
-                            add_dep(readerID, consID, WAD, qubit_count+coperand);
-                        }
+                        add_dep(readerID, consID, WAD, qubit_count+coperand);
                     }
                 }
+            }
 
-                // now update LastWriter and so clear LastReaders/LastDs
-                for( auto coperand : ins->creg_operands )
+            // now update LastWriter and so clear LastReaders/LastDs
+            for( auto coperand : ins->creg_operands )
+            {
+                LastWriter[qubit_count+coperand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
                 {
-                    LastWriter[qubit_count+coperand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        LastReaders[qubit_count+coperand].clear();
-                        LastDs[qubit_count+coperand].clear();
-                    }
+                    LastReaders[qubit_count+coperand].clear();
+                    LastDs[qubit_count+coperand].clear();
                 }
             }
-            else if (  iname == "cnot"
-                    )
+        }
+        else if (commutes)
+        {
+            DOUT(". considering " << ins->qasm() << " as gate with commuting operands");
+            // Read the operands of class commute_z, D the operands of class commute_x, and Write the others
+            auto operands = ins->operands;
+            for (size_t operandNo = 0; operandNo < operands.size(); operandNo++)
             {
-                DOUT(". considering " << name[consNode] << " as cnot");
-                // CNOTs Read the first operands, and Ds the second operand
-                size_t operandNo=0;
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                auto operand = operands[operandNo];
+                ql::commute_t c = (operandNo < commutation.size() ? commutation[operandNo] : ql::commute_none);
+                DOUT(".. Operand: " << operand << " commutation class: " << c);
+                if (c == ql::commute_z)
                 {
-                    DOUT(".. Operand: " << operand);
-                    if( operandNo == 0)
+                    add_dep(LastWriter[operand], consID, RAW, operand);
+                    if (ql::options::get("scheduler_commute") == "no")
                     {
-                        add_dep(LastWriter[operand], consID, RAW, operand);
-	                    if (ql::options::get("scheduler_post179") == "no"
-	                    ||  ql::options::get("scheduler_commute") == "no")
-                        {
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, RAR, operand);
-                            }
-                        }
-                        if (ql::options::get("scheduler_post179") == "yes")
+                        for(auto & readerID : LastReaders[operand])
                         {
-                            for(auto & readerID : LastDs[operand])
-                            {
-                                add_dep(readerID, consID, RAD, operand);
-                            }
+                            add_dep(readerID, consID, RAR, operand);
                         }
                     }
-                    else
+                    else if (LastDs[operand].empty() && IsPrevRun(operand))
                     {
-	                    if (ql::options::get("scheduler_post179") == "no")
+                        // continuing a run of Rs, so depend on the run of Ds before it
+                        for(auto & readerID : LastPrevRun[operand])
                         {
-                            add_dep(LastWriter[operand], consID, WAW, operand);
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, WAR, operand);
-                            }
-                        }
-                        else
-                        {
-                            add_dep(LastWriter[operand], consID, DAW, operand);
-	                        if (ql::options::get("scheduler_commute") == "no")
-                            {
-                                for(auto & readerID : LastDs[operand])
-                                {
-                                    add_dep(readerID, consID, DAD, operand);
-                                }
-                            }
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, DAR, operand);
-                            }
+                            add_dep(readerID, consID, RAD, operand);
                         }
                     }
-                    operandNo++;
-                } // end of operand for
-
-                // now update LastWriter and so clear LastReaders
-                operandNo=0;
-                for( auto operand : operands )
+                    for(auto & readerID : LastDs[operand])
+                    {
+                        add_dep(readerID, consID, RAD, operand);
+                    }
+                }
+                else if (c == ql::commute_x)
                 {
-                    if( operandNo == 0)
+                    add_dep(LastWriter[operand], consID, DAW, operand);
+                    if (ql::options::get("scheduler_commute") == "no")
                     {
-                        // update LastReaders for this operand 0
-                        LastReaders[operand].push_back(consID);
-                        if (ql::options::get("scheduler_post179") == "yes")
+                        for(auto & readerID : LastDs[operand])
                         {
-                            LastDs[operand].clear();
+                            add_dep(readerID, consID, DAD, operand);
                         }
                     }
-                    else
+                    else if (LastReaders[operand].empty() && IsPrevRun(operand))
                     {
-	                    if (ql::options::get("scheduler_post179") == "no")
+                        // continuing a run of Ds, so depend on the run of Rs before it
+                        for(auto & readerID : LastPrevRun[operand])
                         {
-	                        LastWriter[operand] = consID;
+                            add_dep(readerID, consID, DAR, operand);
                         }
-                        else
-                        {
-                            LastDs[operand].push_back(consID);
-                        }
-	                    LastReaders[operand].clear();
                     }
-                    operandNo++;
+                    for(auto & readerID : LastReaders[operand])
+                    {
+                        add_dep(readerID, consID, DAR, operand);
+                    }
                 }
-            }
-            else if (  iname == "cz"
-                    || iname == "cphase"
-                    )
-            {
-                DOUT(". considering " << name[consNode] << " as cz");
-                // CZs Read all operands for post179
-                // CZs Read all operands and write last one for pre179 
-                size_t operandNo=0;
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                else
                 {
-                    DOUT(".. Operand: " << operand);
-                    if (ql::options::get("scheduler_post179") == "no")
+                    add_dep(LastWriter[operand], consID, WAW, operand);
+                    for(auto & readerID : LastReaders[operand])
                     {
-                        add_dep(LastWriter[operand], consID, RAW, operand);
-                        for(auto & readerID : LastReaders[operand])
-                        {
-                            add_dep(readerID, consID, RAR, operand);
-                        }
-	                    if( operandNo != 0)
-	                    {
-                            add_dep(LastWriter[operand], consID, WAW, operand);
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, WAR, operand);
-                            }
-	                    }
+                        add_dep(readerID, consID, WAR, operand);
                     }
-                    else
+                    for(auto & readerID : LastDs[operand])
                     {
-                        if (ql::options::get("scheduler_commute") == "no")
-                        {
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, RAR, operand);
-                            }
-                        }
-                        add_dep(LastWriter[operand], consID, RAW, operand);
-                        for(auto & readerID : LastDs[operand])
-                        {
-                            add_dep(readerID, consID, RAD, operand);
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
-                    operandNo++;
-                } // end of operand for
+                }
+            } // end of operand for
 
-                // update LastReaders etc.
-                operandNo=0;
-                for( auto operand : operands )
+            // now update LastWriter, LastReaders and LastDs
+            for (size_t operandNo = 0; operandNo < operands.size(); operandNo++)
+            {
+                auto operand = operands[operandNo];
+                ql::commute_t c = (operandNo < commutation.size() ? commutation[operandNo] : ql::commute_none);
+                if (c == ql::commute_z)
                 {
-                    if (ql::options::get("scheduler_post179") == "no")
+                    if (!LastDs[operand].empty())
                     {
-	                    if( operandNo == 0)
-	                    {
-	                        LastReaders[operand].push_back(consID);
-	                    }
-	                    else
-	                    {
-	                        LastWriter[operand] = consID;
-	                        LastReaders[operand].clear();
-	                    }
+                        // starting a run of Rs
+                        LastPrevRun[operand].swap(LastDs[operand]);
+                        LastDs[operand].clear();
                     }
-                    else
+                    LastReaders[operand].push_back(consID);
+                }
+                else if (c == ql::commute_x)
+                {
+                    if (!LastReaders[operand].empty())
                     {
-                        LastDs[operand].clear();
-                        LastReaders[operand].push_back(consID);
+                        // starting a run of Ds
+                        LastPrevRun[operand].swap(LastReaders[operand]);
+                        LastReaders[operand].clear();
                     }
-                    operandNo++;
+                    LastDs[operand].push_back(consID);
+                }
+                else
+                {
+                    LastWriter[operand] = consID;
+                    LastReaders[operand].clear();
+                    LastDs[operand].clear();
                 }
             }
-#ifdef HAVEGENERALCONTROLUNITARIES
-            else if (
-                    // or is a Control Unitary in general
-                    // Read on all operands, Write on last operand
-                    // before implementing it, check whether all commutativity on Reads above hold for this Control Unitary
-                    )
-            {
-                DOUT(". considering " << name[consNode] << " as Control Unitary");
-                // Control Unitaries Read all operands, and Write the last operand
-                size_t operandNo=0;
-                auto operands = ins->operands;
-                size_t op_count = operands.size();
-                for( auto operand : operands )
+
+            // Read+Write each classical operand
+            for( auto coperand : ins->creg_operands )
+            {
+                DOUT("... Classical operand: " << coperand);
+                add_dep(LastWriter[qubit_count+coperand], consID, WAW, qubit_count+coperand);
+                for(auto & readerID : LastReaders[qubit_count+coperand])
+                {
+                    add_dep(readerID, consID, WAR, qubit_count+coperand);
+                }
+                for(auto & readerID : LastDs[qubit_count+coperand])
+                {
+                    add_dep(readerID, consID, WAD, qubit_count+coperand);
+                }
+                LastWriter[qubit_count+coperand] = consID;
+                LastReaders[qubit_count+coperand].clear();
+                LastDs[qubit_count+coperand].clear();
+            }
+        }
+        else if (  ql::options::get("scheduler_post179") == "no"
+                && iname == "cnot"
+                )
+        {
+            DOUT(". considering " << ins->qasm() << " as cnot");
+            // CNOTs Read the first operands, and Write the second operand
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                if( operandNo == 0)
                 {
-                    DOUT(".. Operand: " << operand);
                     add_dep(LastWriter[operand], consID, RAW, operand);
-                    if (ql::options::get("scheduler_post179") == "no"
-                    ||  ql::options::get("scheduler_commute") == "no")
+                    for(auto & readerID : LastReaders[operand])
                     {
-                        for(auto & readerID : LastReaders[operand])
-                        {
-                            add_dep(readerID, consID, RAR, operand);
-                        }
+                        add_dep(readerID, consID, RAR, operand);
                     }
-                    if (ql::options::get("scheduler_post179") == "yes")
+                }
+                else
+                {
+                    add_dep(LastWriter[operand], consID, WAW, operand);
+                    for(auto & readerID : LastReaders[operand])
                     {
-                        for(auto & readerID : LastDs[operand])
-                        {
-                            add_dep(readerID, consID, RAD, operand);
-                        }
+                        add_dep(readerID, consID, WAR, operand);
                     }
+                }
+                operandNo++;
+            } // end of operand for
 
-                    if( operandNo < op_count-1 )
+            // now update LastWriter and so clear LastReaders
+            operandNo=0;
+            for( auto operand : operands )
+            {
+                if( operandNo == 0)
+                {
+                    // update LastReaders for this operand 0
+                    LastReaders[operand].push_back(consID);
+                }
+                else
+                {
+                    LastWriter[operand] = consID;
+                    LastReaders[operand].clear();
+                }
+                operandNo++;
+            }
+        }
+        else if (  ql::options::get("scheduler_post179") == "no"
+                && (  iname == "cz"
+                   || iname == "cphase"
+                   )
+                )
+        {
+            DOUT(". considering " << ins->qasm() << " as cz");
+            // CZs Read all operands and write last one for pre179
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, RAW, operand);
+                for(auto & readerID : LastReaders[operand])
+                {
+                    add_dep(readerID, consID, RAR, operand);
+                }
+                if( operandNo != 0)
+                {
+                    add_dep(LastWriter[operand], consID, WAW, operand);
+                    for(auto & readerID : LastReaders[operand])
+                    {
+                        add_dep(readerID, consID, WAR, operand);
+                    }
+                }
+                operandNo++;
+            } // end of operand for
+
+            // update LastReaders etc.
+            operandNo=0;
+            for( auto operand : operands )
+            {
+                if( operandNo == 0)
+                {
+                    LastReaders[operand].push_back(consID);
+                }
+                else
+                {
+                    LastWriter[operand] = consID;
+                    LastReaders[operand].clear();
+                }
+                operandNo++;
+            }
+        }
+#ifdef HAVEGENERALCONTROLUNITARIES
+        else if (
+                // or is a Control Unitary in general
+                // Read on all operands, Write on last operand
+                // before implementing it, check whether all commutativity on Reads above hold for this Control Unitary
+                )
+        {
+            DOUT(". considering " << ins->qasm() << " as Control Unitary");
+            // Control Unitaries Read all operands, and Write the last operand
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            size_t op_count = operands.size();
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, RAW, operand);
+                if (ql::options::get("scheduler_post179") == "no"
+                ||  ql::options::get("scheduler_commute") == "no")
+                {
+                    for(auto & readerID : LastReaders[operand])
                     {
-                        LastReaders[operand].push_back(consID);
-                        if (ql::options::get("scheduler_post179") == "yes")
-                        {
-                            LastDs[operand].clear();
-                        }
+                        add_dep(readerID, consID, RAR, operand);
                     }
-                    else
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        add_dep(LastWriter[operand], consID, WAW, operand);
-                        for(auto & readerID : LastReaders[operand])
-                        {
-                            add_dep(readerID, consID, WAR, operand);
-                        }
-                        if (ql::options::get("scheduler_post179") == "yes")
-                        {
-                            for(auto & readerID : LastDs[operand])
-                            {
-                                add_dep(readerID, consID, WAD, operand);
-                            }
-                        }
+                        add_dep(readerID, consID, RAD, operand);
+                    }
+                }
 
-                        LastWriter[operand] = consID;
-                        LastReaders[operand].clear();
-                        if (ql::options::get("scheduler_post179") == "yes")
-                        {
-                            LastDs[operand].clear();
-                        }
+                if( operandNo < op_count-1 )
+                {
+                    LastReaders[operand].push_back(consID);
+                    if (ql::options::get("scheduler_post179") == "yes")
+                    {
+                        LastDs[operand].clear();
                     }
-                    operandNo++;
-                } // end of operand for
-            }
-#endif  // HAVEGENERALCONTROLUNITARIES
-            else
-            {
-                DOUT(". considering " << name[consNode] << " as no special gate (catch-all, generic rules)");
-                // Read+Write on each quantum operand
-                // Read+Write on each classical operand
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                }
+                else
                 {
-                    DOUT(".. Operand: " << operand);
                     add_dep(LastWriter[operand], consID, WAW, operand);
                     for(auto & readerID : LastReaders[operand])
                     {
@@ -658,47 +1016,85 @@ public:
                     {
                         LastDs[operand].clear();
                     }
-                } // end of operand for
-
-                // Read+Write each classical operand
-                for( auto coperand : ins->creg_operands )
+                }
+                operandNo++;
+            } // end of operand for
+        }
+#endif  // HAVEGENERALCONTROLUNITARIES
+        else
+        {
+            DOUT(". considering " << ins->qasm() << " as no special gate (catch-all, generic rules)");
+            // Read+Write on each quantum operand
+            // Read+Write on each classical operand
+            auto operands = ins->operands;
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[operand])
                 {
-                    DOUT("... Classical operand: " << coperand);
-                    add_dep(LastWriter[qubit_count+coperand], consID, WAW, qubit_count+coperand);
-                    for(auto & readerID : LastReaders[qubit_count+coperand])
-                    {
-                        add_dep(readerID, consID, WAR, qubit_count+coperand);
-                    }
-                    if (ql::options::get("scheduler_post179") == "yes")
+                    add_dep(readerID, consID, WAR, operand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        for(auto & readerID : LastDs[qubit_count+coperand])
-                        {
-                            add_dep(readerID, consID, WAD, qubit_count+coperand);
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
+                }
 
-                    // now update LastWriter and so clear LastReaders/LastDs
-                    LastWriter[qubit_count+coperand] = consID;
-                    LastReaders[qubit_count+coperand].clear();
-                    if (ql::options::get("scheduler_post179") == "yes")
+                LastWriter[operand] = consID;
+                LastReaders[operand].clear();
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    LastDs[operand].clear();
+                }
+            } // end of operand for
+
+            // Read+Write each classical operand
+            for( auto coperand : ins->creg_operands )
+            {
+                DOUT("... Classical operand: " << coperand);
+                add_dep(LastWriter[qubit_count+coperand], consID, WAW, qubit_count+coperand);
+                for(auto & readerID : LastReaders[qubit_count+coperand])
+                {
+                    add_dep(readerID, consID, WAR, qubit_count+coperand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[qubit_count+coperand])
                     {
-                        LastDs[qubit_count+coperand].clear();
+                        add_dep(readerID, consID, WAD, qubit_count+coperand);
                     }
-                } // end of coperand for
-            } // end of if/else
-            DOUT(". instruction done: " << ins->qasm());
-        } // end of instruction for
+                }
+
+                // now update LastWriter and so clear LastReaders/LastDs
+                LastWriter[qubit_count+coperand] = consID;
+                LastReaders[qubit_count+coperand].clear();
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    LastDs[qubit_count+coperand].clear();
+                }
+            } // end of coperand for
+        } // end of if/else
+        DOUT(". instruction done: " << ins->qasm());
+    }
 
+    // finish the dependence graph by creating the t node (unless witht is false), and closing it
+    void init_end(bool witht = true)
+    {
+        size_t qubit_creg_count = qubit_count + creg_count;
 	    DOUT("adding deps to SINK");
         // finish filling the dependence graph by creating the t node, the bottom of the graph
+        if (witht)
         {
 	        // add dummy target node
-	        ListDigraph::Node consNode = graph.addNode();
-	        int consID = graph.id(consNode);
-	        instruction[consNode] = new ql::SINK();    // so SINK is defined as instruction[t], not unique in itself
-	        node[instruction[consNode]] = consNode;
-	        name[consNode] = instruction[consNode]->qasm();
-	        t=consNode;
+            if (sinkgp == NULL)
+            {
+                sinkgp = gatesp->create<ql::SINK>();                // so SINK is defined as instruction[t], not unique in itself
+            }
+	        int consID = add_node(sinkgp);
+	        t=consID;
 	
 	        // add deps to the dummy target node to close the dependence chains
 	        // it behaves as a W to every qubit and creg
@@ -710,7 +1106,7 @@ public:
 	        // and also for implementing scheduling and mapping across control-flow (so that it is
 	        // guaranteed that on a jump and on start of target circuit, the source circuit completed).
             //
-            // note that there always is a LastWriter: the dummy source node wrote to every qubit and class. reg
+            // note that there always is a LastWriter when there is s: the dummy source node wrote to every qubit and class. reg
 	        std::vector<size_t> operands(qubit_creg_count);
 	        std::iota(operands.begin(), operands.end(), 0);
 	        for( auto operand : operands )
@@ -743,30 +1139,29 @@ public:
 	        }
         }
 
-        // useless as well because by construction, there cannot be cycles
-        // but when afterwards dependences are added, cycles may be created,
-        // and after doing so (a copy of) this test should certainly be done because
-        // a cyclic dependence graph cannot be scheduled;
-        // this test here is a kind of debugging aid whether dependence creation was done well
-        if( !dag(graph) )
-        {
-            DOUT("The dependence graph is not a DAG.");
-            EOUT("The dependence graph is not a DAG.");
-        }
+        // by construction, there cannot be cycles: all arcs go from a lower to a higher numbered node
+        graph.close();
         DOUT("Dependence graph creation Done.");
     }
 
+    // print the dependence graph in LEMON's graph format (lgf)
     void print()
     {
         COUT("Printing Dependence Graph ");
-        digraphWriter(graph).
-        nodeMap("name", name).
-        arcMap("cause", cause).
-        arcMap("weight", weight).
-        // arcMap("depType", depType).
-        node("source", s).
-        node("target", t).
-        run();
+        std::cout << "@nodes" << endl << "label\tname" << endl;
+        for (DepGraph::Node n = DepGraph::Node(graph.size())-1; n >= 0; n--)
+        {
+            std::cout << n << "\t\"" << instruction[n]->qasm() << "\"" << endl;
+        }
+        std::cout << "@arcs" << endl << "\t\tcause\tweight" << endl;
+        for (DepGraph::Node n = DepGraph::Node(graph.size())-1; n >= 0; n--)
+        {
+            for (auto & a : graph.succs(n))
+            {
+                std::cout << n << "\t" << a.node << "\t" << DepGraph::cause(a) << "\t" << weight[n] << endl;
+            }
+        }
+        std::cout << "@attributes" << endl << "source\t" << s << endl << "target\t" << t << endl;
     }
 
     void write_dependence_matrix()
@@ -782,17 +1177,16 @@ public:
             return;
         }
 
-        size_t totalInstructions = countNodes(graph);
+        size_t totalInstructions = graph.size();
         vector< vector<bool> > Matrix(totalInstructions, vector<bool>(totalInstructions));
 
         // now print the edges
-        for (ListDigraph::ArcIt arc(graph); arc != INVALID; ++arc)
+        for (size_t srcID = 0; srcID < totalInstructions; srcID++)
         {
-            ListDigraph::Node srcNode = graph.source(arc);
-            ListDigraph::Node dstNode = graph.target(arc);
-            size_t srcID = graph.id( srcNode );
-            size_t dstID = graph.id( dstNode );
-            Matrix[srcID][dstID] = true;
+            for (auto & a : graph.succs(srcID))
+            {
+                Matrix[srcID][a.node] = true;
+            }
         }
 
         for(size_t i=1; i<totalInstructions-1;i++)
@@ -853,22 +1247,22 @@ public:
     // please note that set_cycle_gate expects a caller like set_cycle which iterates gp forward through the circuit
     void set_cycle_gate(ql::gate* gp, ql::scheduling_direction_t dir)
     {
-        ListDigraph::Node   currNode = node[gp];
+        DepGraph::Node  currNode = node[gp];
         size_t  currCycle;
         if (ql::forward_scheduling == dir)
         {
             currCycle = 0;
-            for( ListDigraph::InArcIt arc(graph,currNode); arc != INVALID; ++arc )
+            for (auto & a : graph.preds(currNode))
             {
-                currCycle = std::max(currCycle, instruction[graph.source(arc)]->cycle + weight[arc]);
+                currCycle = std::max(currCycle, instruction[a.node]->cycle + weight[a.node]);
             }
         }
         else
         {
             currCycle = MAX_CYCLE;
-            for( ListDigraph::OutArcIt arc(graph,currNode); arc != INVALID; ++arc )
+            for (auto & a : graph.succs(currNode))
             {
-                currCycle = std::min(currCycle, instruction[graph.target(arc)]->cycle - weight[arc]);
+                currCycle = std::min(currCycle, instruction[a.node]->cycle - weight[currNode]);
             }
         }
         gp->cycle = currCycle;
@@ -1038,7 +1432,7 @@ public:
 #endif
 
     // ASAP scheduler without RC, updating circuit and returning bundles
-    ql::ir::bundles_t schedule_asap_post179(std::string & sched_dot)
+    ql::ir::flat_bundles_t schedule_asap_post179(std::string & sched_dot)
     {
         DOUT("Scheduling ASAP post179 ...");
         set_cycle(ql::forward_scheduling);
@@ -1056,7 +1450,7 @@ public:
     }
 
     // ALAP scheduler without RC, updating circuit and returning bundles
-    ql::ir::bundles_t schedule_alap_post179(std::string & sched_dot)
+    ql::ir::flat_bundles_t schedule_alap_post179(std::string & sched_dot)
     {
         DOUT("Scheduling ALAP post179 ...");
         set_cycle(ql::backward_scheduling);
@@ -1081,36 +1475,71 @@ public:
     // to avoid largely suboptimal results (issue 179), i.e. apply list scheduling.
 
     // latency compensation
+    //
+    // the latency of each gate in cycles is in its instruction descriptor (see quantum_platform::intern_instructions);
+    // the circuit is ordered by cycle, and gates with equal latency keep that relative order after compensation;
+    // so instead of sorting the circuit again, the subsequences of gates with equal latency are merged,
+    // in the same linear sweep over the circuit;
+    // on equal cycle values the original order is kept, as with sort_by_cycle
     void latency_compensation(ql::circuit* circp, const ql::quantum_platform& platform)
     {
         DOUT("Latency compensation ...");
+        std::vector<long>                   latencies;  // the different latencies found
+        std::vector<std::vector<size_t>>    positions;  // positions[l]: positions in circuit of gates with latencies[l]
         bool    compensated_one = false;
-        for ( auto & gp : *circp)
+        for (size_t i = 0; i < circp->size(); i++)
         {
-            auto & id = gp->name;
-            // DOUT("Latency compensating instruction: " << id);
-            long latency_cycles=0;
+            auto gp = (*circp)[i];
+            long latency_cycles = platform.get_descriptor(gp->name).latency;
+            if (latency_cycles != 0)
+            {
+                compensated_one = true;
+                gp->cycle = gp->cycle + latency_cycles;
+                DOUT( "... compensated to @" << gp->cycle << " <- " << gp->name << " with " << latency_cycles );
+            }
 
-            if(platform.instruction_settings.count(id) > 0)
+            size_t l = std::find(latencies.begin(), latencies.end(), latency_cycles) - latencies.begin();
+            if (l == latencies.size())
             {
-                if(platform.instruction_settings[id].count("latency") > 0)
-                {
-                    float latency_ns = platform.instruction_settings[id]["latency"];
-                    latency_cycles = (std::ceil( static_cast<float>(std::abs(latency_ns)) / cycle_time)) *
-                                            ql::utils::sign_of(latency_ns);
-                    compensated_one = true;
+                latencies.push_back(latency_cycles);
+                positions.push_back(std::vector<size_t>());
+            }
+            positions[l].push_back(i);
+        }
 
-                    gp->cycle = gp->cycle + latency_cycles;
-                    DOUT( "... compensated to @" << gp->cycle << " <- " << id << " with " << latency_cycles );
+        if (compensated_one && latencies.size() > 1)
+        {
+            DOUT("... merging on cycle value after latency compensation");
+            ql::circuit merged;
+            merged.reserve(circp->size());
+            std::vector<size_t> next(latencies.size(), 0);  // next[l]: index in positions[l] of next gate to merge
+            for (size_t i = 0; i < circp->size(); i++)
+            {
+                // find the subsequence whose next gate has lowest cycle, and on equal cycle, lowest position
+                size_t  best = latencies.size();
+                for (size_t l = 0; l < latencies.size(); l++)
+                {
+                    if (next[l] == positions[l].size())
+                    {
+                        continue;
+                    }
+                    if (best == latencies.size()
+                        || (*circp)[positions[l][next[l]]]->cycle < (*circp)[positions[best][next[best]]]->cycle
+                        || ((*circp)[positions[l][next[l]]]->cycle == (*circp)[positions[best][next[best]]]->cycle
+                            && positions[l][next[l]] < positions[best][next[best]])
+                       )
+                    {
+                        best = l;
+                    }
                 }
+                merged.push_back((*circp)[positions[best][next[best]]]);
+                next[best]++;
             }
+            circp->swap(merged);
         }
 
         if (compensated_one)
         {
-            DOUT("... sorting on cycle value after latency compensation");
-            sort_by_cycle();
-
             DOUT("... printing schedule after latency compensation");
             for ( auto & gp : *circp)
             {
@@ -1125,45 +1554,39 @@ public:
     }
 
     // insert buffer - buffer delays
-    void insert_buffer_delays(ql::ir::bundles_t& bundles, const ql::quantum_platform& platform)
+    //
+    // in a single sweep over the bundles, the distinct operation types (optype_id) of the current bundle are collected;
+    // the buffer cycles to insert before it are the maximum of platform.buffer_cycles
+    // over the pairs of operation types of the previous and the current bundle
+    void insert_buffer_delays(ql::ir::flat_bundles_t& bundles, const ql::quantum_platform& platform)
     {
         DOUT("Buffer-buffer delay insertion ... ");
-        std::vector<std::string> operations_prev_bundle;
+        std::vector<size_t> optypes_prev_bundle;    // the distinct optype_ids in the previous bundle
         size_t buffer_cycles_accum = 0;
-        for(ql::ir::bundle_t & abundle : bundles)
+        for (size_t b = 0; b < bundles.size(); b++)
         {
-            std::vector<std::string> operations_curr_bundle;
-            for( auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt )
+            std::vector<size_t> optypes_curr_bundle;
+            for (size_t i = bundles.bundle_gates_begin(b); i < bundles.bundle_gates_end(b); i++)
             {
-                for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
+                size_t t = platform.get_descriptor(bundles.gates[i]->name).optype_id;
+                if (std::find(optypes_curr_bundle.begin(), optypes_curr_bundle.end(), t) == optypes_curr_bundle.end())
                 {
-                    auto & id = (*insIt)->name;
-                    std::string op_type("none");
-                    if(platform.instruction_settings.count(id) > 0)
-                    {
-                        if(platform.instruction_settings[id].count("type") > 0)
-                        {
-                            op_type = platform.instruction_settings[id]["type"];
-                        }
-                    }
-                    operations_curr_bundle.push_back(op_type);
+                    optypes_curr_bundle.push_back(t);
                 }
             }
 
             size_t buffer_cycles = 0;
-            for(auto & op_prev : operations_prev_bundle)
+            for (auto t_prev : optypes_prev_bundle)
             {
-                for(auto & op_curr : operations_curr_bundle)
+                for (auto t_curr : optypes_curr_bundle)
                 {
-                    auto temp_buf_cycles = buffer_cycles_map[ std::pair<std::string,std::string>(op_prev, op_curr) ];
-                    DOUT("... considering buffer_" << op_prev << "_" << op_curr << ": " << temp_buf_cycles);
-                    buffer_cycles = std::max(temp_buf_cycles, buffer_cycles);
+                    buffer_cycles = std::max(platform.buffer_cycles[t_prev][t_curr], buffer_cycles);
                 }
             }
             DOUT( "... inserting buffer : " << buffer_cycles);
             buffer_cycles_accum += buffer_cycles;
-            abundle.start_cycle = abundle.start_cycle + buffer_cycles_accum;
-            operations_prev_bundle = operations_curr_bundle;
+            bundles.start_cycle[b] = bundles.start_cycle[b] + buffer_cycles_accum;
+            optypes_prev_bundle.swap(optypes_curr_bundle);
         }
         DOUT("Buffer-buffer delay insertion [DONE] ");
     }
@@ -1189,68 +1612,119 @@ public:
     // Note that set_remaining_gate expects a caller like set_remaining that iterates gp backward over the circuit
     void set_remaining_gate(ql::gate* gp, ql::scheduling_direction_t dir)
     {
-        ListDigraph::Node   currNode = node[gp];
-        size_t              currRemain = 0;
+        DepGraph::Node  currNode = node[gp];
+        size_t          currRemain = 0;
         if (ql::forward_scheduling == dir)
         {
-            for( ListDigraph::OutArcIt arc(graph,currNode); arc != INVALID; ++arc )
+            for (auto & a : graph.succs(currNode))
             {
-                currRemain = std::max(currRemain, remaining[graph.target(arc)] + weight[arc]);
+                currRemain = std::max(currRemain, remaining[a.node] + weight[currNode]);
             }
         }
         else
         {
-            for( ListDigraph::InArcIt arc(graph,currNode); arc != INVALID; ++arc )
+            for (auto & a : graph.preds(currNode))
             {
-                currRemain = std::max(currRemain, remaining[graph.source(arc)] + weight[arc]);
+                currRemain = std::max(currRemain, remaining[a.node] + weight[a.node]);
             }
         }
         remaining[currNode] = currRemain;
     }
 
+    // size remaining and the deep-criticality values (see set_deepcrit_gate) to the dependence graph
+    void clear_remaining()
+    {
+        size_t  n = graph.size();
+        remaining.assign(n, 0);
+        critdep.assign(n, 0);
+        ncritdep.assign(n, 0);
+        bestdep.assign(n, INVALID_NODE);
+        critclass.assign(n, 0);
+        rank.assign(n, 0);
+        critclasses.clear();
+    }
+
     void set_remaining(ql::scheduling_direction_t dir)
     {
         ql::gate*   gp;
-        remaining.clear();
+        clear_remaining();
         if (ql::forward_scheduling == dir)
         {
             // remaining until SINK (i.e. the SINK.cycle-ALAP value)
             remaining[t] = 0;
+            set_deepcrit_gate(t, dir);
             // *circp is by definition in a topological order of the dependence graph
             for ( ql::circuit::reverse_iterator gpit = circp->rbegin(); gpit != circp->rend(); gpit++)
             {
                 ql::gate*   gp2 = *gpit;
                 set_remaining_gate(gp2, dir);
+                set_deepcrit_gate(node[gp2], dir);
                 DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining[node[gp2]]);
             }
             gp = instruction[s];
             set_remaining_gate(gp, dir);
+            set_deepcrit_gate(s, dir);
             DOUT("... remaining at " << gp->qasm() << " cycles " << remaining[s]);
         }
         else
         {
             // remaining until SOURCE (i.e. the ASAP value)
             remaining[s] = 0;
+            set_deepcrit_gate(s, dir);
             // *circp is by definition in a topological order of the dependence graph
             for ( ql::circuit::iterator gpit = circp->begin(); gpit != circp->end(); gpit++)
             {
                 ql::gate*   gp2 = *gpit;
                 set_remaining_gate(gp2, dir);
+                set_deepcrit_gate(node[gp2], dir);
                 DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining[node[gp2]]);
             }
             gp = instruction[t];
             set_remaining_gate(gp, dir);
+            set_deepcrit_gate(t, dir);
             DOUT("... remaining at " << gp->qasm() << " cycles " << remaining[t]);
         }
+        set_rank();
+    }
+
+    // set remaining for forward scheduling in an incrementally constructed dependence graph (see init_begin)
+    // that contains the nodes of the given gates (in circuit order), and maybe s and t;
+    // when t is not there yet, a gate without depending nodes gets its own duration as remaining,
+    // as if t depended on it: criticality is then relative to the end of what is in the graph
+    void set_remaining_window(std::vector<ql::gate*>& gates)
+    {
+        clear_remaining();
+        if (t != INVALID_NODE)
+        {
+            remaining[t] = 0;
+            set_deepcrit_gate(t, ql::forward_scheduling);
+        }
+        for (auto gpit = gates.rbegin(); gpit != gates.rend(); gpit++)
+        {
+            ql::gate*   gp = *gpit;
+            set_remaining_gate(gp, ql::forward_scheduling);
+            DepGraph::Node n = node[gp];
+            if (graph.succs(n).empty())
+            {
+                remaining[n] = std::ceil( static_cast<float>(gp->duration) / cycle_time);
+            }
+            set_deepcrit_gate(n, ql::forward_scheduling);
+        }
+        if (s != INVALID_NODE)
+        {
+            set_remaining_gate(instruction[s], ql::forward_scheduling);
+            set_deepcrit_gate(s, ql::forward_scheduling);
+        }
+        set_rank();
     }
 
-    ql::gate* find_mostcritical(std::list<ql::gate*>& lg)
+    ql::gate* find_mostcritical(std::list<ql::gate*>& lg) const
     {
         size_t      maxRemain = 0;
         ql::gate*   mostCriticalGate = NULL;
         for ( auto gp : lg)
         {
-            size_t gr = remaining[node[gp]];
+            size_t gr = remaining[node.at(gp)];
             if (gr > maxRemain)
             {
                 mostCriticalGate = gp;
@@ -1280,118 +1754,115 @@ public:
 
     // Set the curr_cycle of the scheduling algorithm to start at the appropriate end as well;
     // note that the cycle attributes will be shifted down to start at 1 after backward scheduling.
-    void init_available(std::list<ListDigraph::Node>& avlist, ql::scheduling_direction_t dir, size_t& curr_cycle)
+    // Expects the ranks to have been computed (see set_remaining).
+    void init_available(avlist_t& avlist, ql::scheduling_direction_t dir, size_t& curr_cycle)
     {
         avlist.clear();
         if (ql::forward_scheduling == dir)
         {
             curr_cycle = 0;
             instruction[s]->cycle = curr_cycle;
-            avlist.push_back(s);
+            avlist.insert(s, rank[s]);
         }
         else
         {
             curr_cycle = ALAP_SINK_CYCLE;
             instruction[t]->cycle = curr_cycle;
-            avlist.push_back(t);
+            avlist.insert(t, rank[t]);
         }
     }
 
-    // collect the list of directly depending nodes
-    // (i.e. those necessarily scheduled after the given node) without duplicates;
-    // dependences that are duplicates from the perspective of the scheduler
-    // may be present in the dependence graph because the scheduler ignores dependence type and cause
-    void get_depending_nodes(ListDigraph::Node n, ql::scheduling_direction_t dir, std::list<ListDigraph::Node> & ln)
+    // Deep-criticality of nodes, for the given scheduling direction:
+    // criticality of a node is given by its remaining[node] value which is precomputed;
+    // deep-criticality takes into account the criticality of depending nodes (in the right direction!);
+    // it is used to order the avlist in an order from highest deep-criticality to lowest deep-criticality;
+    // it is the core of the heuristics of the critical path list scheduler.
+    //
+    // A node n1 is less deep-critical than n2 when, compared in this order:
+    // - its remaining is less
+    // - it has no depending nodes while n2 has
+    // - the largest remaining of its depending nodes (critdep) is less
+    // - the number of its depending nodes with that largest remaining (ncritdep) is less
+    // - the most deep-critical of those depending nodes (bestdep) is less deep-critical than that of n2
+    // This defines a total order on equivalence classes of nodes (critclass).
+    // Instead of evaluating it recursively each time two nodes are compared,
+    // critdep, ncritdep, bestdep and critclass are computed per node by set_deepcrit_gate,
+    // once after remaining, and from those, set_rank computes the position of each node in the order.
+
+    // compare n1 and n2 on deep-criticality using the precomputed values; the loop ends because
+    // nodes of different critclass differ in one of the values somewhere along their bestdep chains
+    bool deepcrit_lessthan(DepGraph::Node n1, DepGraph::Node n2)
     {
-        if (ql::forward_scheduling == dir)
+        while (critclass[n1] != critclass[n2])
         {
-            for (ListDigraph::OutArcIt succArc(graph,n); succArc != INVALID; ++succArc)
-            {
-                ListDigraph::Node succNode = graph.target(succArc);
-                // DOUT("...... succ of " << instruction[n]->qasm() << " : " << instruction[succNode]->qasm());
-                bool found = false;             // filter out duplicates
-                for ( auto anySuccNode : ln )
-                {
-                    if (succNode == anySuccNode)
-                    {
-                        // DOUT("...... duplicate: " << instruction[succNode]->qasm());
-                        found = true;           // duplicate found
-                    }
-                }
-                if (found == false)             // found new one
-                {
-                    ln.push_back(succNode);     // new node to ln
-                }
-            }
-            // ln contains depending nodes of n without duplicates
+            if (remaining[n1] != remaining[n2]) return remaining[n1] < remaining[n2];
+            if (ncritdep[n2] == 0) return false;    // strictly < only when n1 has no depending nodes and n2 has
+            if (ncritdep[n1] == 0) return true;
+            if (critdep[n1] != critdep[n2]) return critdep[n1] < critdep[n2];
+            if (ncritdep[n1] != ncritdep[n2]) return ncritdep[n1] < ncritdep[n2];
+            n1 = bestdep[n1];
+            n2 = bestdep[n2];
         }
-        else
+        return false;
+    }
+
+    // compute critdep, ncritdep, bestdep and critclass of node n;
+    // expects remaining of n and all values of its depending nodes to have been computed,
+    // i.e. a caller like set_remaining iterating backward over the circuit
+    void set_deepcrit_gate(DepGraph::Node n, ql::scheduling_direction_t dir)
+    {
+        size_t          cd = 0;
+        size_t          ncd = 0;
+        DepGraph::Node  bd = INVALID_NODE;
+        for (auto & a : (ql::forward_scheduling == dir ? graph.succs(n) : graph.preds(n)))
         {
-            for (ListDigraph::InArcIt predArc(graph,n); predArc != INVALID; ++predArc)
+            DepGraph::Node  d = a.node;
+            if (bd == INVALID_NODE || remaining[d] > cd)
             {
-                ListDigraph::Node predNode = graph.source(predArc);
-                // DOUT("...... pred of " << instruction[n]->qasm() << " : " << instruction[predNode]->qasm());
-                bool found = false;             // filter out duplicates
-                for ( auto anyPredNode : ln )
-                {
-                    if (predNode == anyPredNode)
-                    {
-                        // DOUT("...... duplicate: " << instruction[predNode]->qasm());
-                        found = true;           // duplicate found
-                    }
-                }
-                if (found == false)             // found new one
+                cd = remaining[d];
+                ncd = 1;
+                bd = d;
+            }
+            else if (remaining[d] == cd)
+            {
+                ncd++;
+                if (deepcrit_lessthan(bd, d))
                 {
-                    ln.push_back(predNode);     // new node to ln
+                    bd = d;
                 }
             }
-            // ln contains depending nodes of n without duplicates
         }
+        critdep[n] = cd;
+        ncritdep[n] = ncd;
+        bestdep[n] = bd;
+
+        // nodes with the same signature are equally deep-critical
+        auto    sig = std::make_tuple(remaining[n], cd, ncd, (bd == INVALID_NODE ? 0 : critclass[bd]));
+        auto    it = critclasses.find(sig);
+        if (it == critclasses.end())
+        {
+            it = critclasses.insert(std::make_pair(sig, critclasses.size()+1)).first;
+        }
+        critclass[n] = it->second;
     }
 
-    // Compute of two nodes whether the first one is less deep-critical than the second, for the given scheduling direction;
-    // criticality of a node is given by its remaining[node] value which is precomputed;
-    // deep-criticality takes into account the criticality of depending nodes (in the right direction!);
-    // this function is used to order the avlist in an order from highest deep-criticality to lowest deep-criticality;
-    // it is the core of the heuristics of the critical path list scheduler.
-    bool criticality_lessthan(ListDigraph::Node n1, ListDigraph::Node n2, ql::scheduling_direction_t dir)
+    // compute rank of all nodes from their deep-criticality;
+    // equally deep-critical nodes get equal rank
+    void set_rank()
     {
-        if (n1 == n2) return false;             // because not <
-
-        if (remaining[n1] < remaining[n2]) return true;
-        if (remaining[n1] > remaining[n2]) return false;
-        // so: remaining[n1] == remaining[n2]
-
-        std::list<ListDigraph::Node>   ln1;
-        std::list<ListDigraph::Node>   ln2;
-
-        get_depending_nodes(n1, dir, ln1);
-        get_depending_nodes(n2, dir, ln2);
-        if (ln2.empty()) return false;          // strictly < only when ln1.empty and ln2.not_empty
-        if (ln1.empty()) return true;           // so when both empty, it is equal, so not strictly <, so false
-        // so: ln1.non_empty && ln2.non_empty
-
-        ln1.sort([this](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return remaining[d1] < remaining[d2]; });
-        ln2.sort([this](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return remaining[d1] < remaining[d2]; });
-
-        size_t crit_dep_n1 = remaining[ln1.back()];    // the last of the list is the one with the largest remaining value
-        size_t crit_dep_n2 = remaining[ln2.back()];
-
-        if (crit_dep_n1 < crit_dep_n2) return true;
-        if (crit_dep_n1 > crit_dep_n2) return false;
-        // so: crit_dep_n1 == crit_dep_n2, call this crit_dep
-
-        ln1.remove_if([this,crit_dep_n1](ListDigraph::Node n) { return remaining[n] < crit_dep_n1; });
-        ln2.remove_if([this,crit_dep_n2](ListDigraph::Node n) { return remaining[n] < crit_dep_n2; });
-        // because both contain element with remaining == crit_dep: ln1.non_empty && ln2.non_empty
-
-        if (ln1.size() < ln2.size()) return true;
-        if (ln1.size() > ln2.size()) return false;
-        // so: ln1.size() == ln2.size() >= 1
-
-        ln1.sort([this,dir](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return criticality_lessthan(d1, d2, dir); });
-        ln2.sort([this,dir](const ListDigraph::Node &d1, const ListDigraph::Node &d2) { return criticality_lessthan(d1, d2, dir); });
-        return criticality_lessthan(ln1.back(), ln2.back(), dir);
+        std::vector<DepGraph::Node> order(graph.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+            [this](const DepGraph::Node& n1, const DepGraph::Node& n2) { return deepcrit_lessthan(n1, n2); });
+        size_t  r = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (i > 0 && critclass[order[i]] != critclass[order[i-1]])
+            {
+                r++;
+            }
+            rank[order[i]] = r;
+        }
     }
 
     // Make node n available
@@ -1401,54 +1872,46 @@ public:
     // update its cycle attribute to reflect these dependences;
     // avlist is initialized with s or t as first element by init_available
     // avlist is kept ordered on deep-criticality, non-increasing (i.e. highest deep-criticality first)
-    void MakeAvailable(ListDigraph::Node n, std::list<ListDigraph::Node>& avlist, ql::scheduling_direction_t dir)
+    //
+    // when a node has same deep-criticality as n, new node n is put after it, as last one of set of same criticality,
+    // so order of calling MakeAvailable (and probably original circuit, and running other scheduler first) matters,
+    // also when all dependence sets (and so remaining values) are identical!
+    void MakeAvailable(DepGraph::Node n, avlist_t& avlist, ql::scheduling_direction_t dir)
     {
-        bool    already_in_avlist = false;  // check whether n is already in avlist
-                                            // originates from having multiple arcs between pair of nodes
-        std::list<ListDigraph::Node>::iterator first_lower_criticality_inp;     // for keeping avlist ordered
-        bool    first_lower_criticality_found = false;                          // for keeping avlist ordered
+        DOUT(".... making available node " << instruction[n]->qasm() << " remaining: " << remaining[n]);
+        if (avlist.contains(n))
+        {
+            DOUT("...... duplicate when making available: " << instruction[n]->qasm());
+            return;
+        }
+        set_cycle_gate(instruction[n], dir);    // for the schedulers to inspect whether gate has completed
+        avlist.insert(n, rank[n]);
+        DOUT("...... made available node(@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " remaining: " << remaining[n]);
+    }
 
-        DOUT(".... making available node " << name[n] << " remaining: " << remaining[n]);
-        for (std::list<ListDigraph::Node>::iterator inp = avlist.begin(); inp != avlist.end(); inp++)
+    // make node n available as MakeAvailable does when forward scheduling, but leave the cycle attribute of its gate;
+    // so this changes neither the scheduler nor its gates, and the mapper's futures, that don't use the cycles,
+    // can share the scheduler (for its dependence graph) while evaluating alternatives concurrently
+    void MakeAvailableNoCycle(DepGraph::Node n, avlist_t& avlist) const
+    {
+        if (!avlist.contains(n))
         {
-            if (*inp == n)
-            {
-                already_in_avlist = true;
-                DOUT("...... duplicate when making available: " << name[n]);
-            }
-            else
-            {
-                // scanning avlist from front to back (avlist is ordered from high to low criticality)
-                // when encountering first node *inp with less criticality,
-                // that is where new node n should be inserted just before,
-                // to keep avlist in desired order
-                //
-                // consequence is that
-                // when a node has same criticality as n, new node n is put after it, as last one of set of same criticality,
-                // so order of calling MakeAvailable (and probably original circuit, and running other scheduler first) matters,
-                // also when all dependence sets (and so remaining values) are identical!
-                if (criticality_lessthan(*inp, n, dir) && !first_lower_criticality_found)
-                {
-                    first_lower_criticality_inp = inp;
-                    first_lower_criticality_found = true;
-                }
-            }
+            avlist.insert(n, rank[n]);
         }
-        if (!already_in_avlist)
+    }
+
+    // whether the nodes that node n depends on, its predecessors (forward scheduling) or successors (backward scheduling),
+    // all have been scheduled
+    bool IsSchedulable(DepGraph::Node n, std::map<ql::gate*,bool> & scheduled, ql::scheduling_direction_t dir) const
+    {
+        for (auto & a : (ql::forward_scheduling == dir ? graph.preds(n) : graph.succs(n)))
         {
-            set_cycle_gate(instruction[n], dir);        // for the schedulers to inspect whether gate has completed
-            if (first_lower_criticality_found)
-            {
-                // add n to avlist just before the first with lower criticality
-                avlist.insert(first_lower_criticality_inp, n);
-            }
-            else
+            if (!scheduled[instruction[a.node]])
             {
-                // add n to end of avlist, if none found with less criticality
-                avlist.push_back(n);
+                return false;
             }
-            DOUT("...... made available node(@" << instruction[n]->cycle << "): " << name[n] << " remaining: " << remaining[n]);
         }
+        return true;
     }
 
     // take node n out of avlist because it has been scheduled;
@@ -1468,129 +1931,104 @@ public:
     // update (through MakeAvailable) the cycle attribute of the nodes made available
     // because from then on that value is compared to the curr_cycle to check
     // whether a node has completed execution and thus is available for scheduling in curr_cycle
-    void TakeAvailable(ListDigraph::Node n, std::list<ListDigraph::Node>& avlist, std::map<ql::gate*,bool> & scheduled, ql::scheduling_direction_t dir)
+    void TakeAvailable(DepGraph::Node n, avlist_t& avlist, std::map<ql::gate*,bool> & scheduled, ql::scheduling_direction_t dir)
     {
         scheduled[instruction[n]] = true;
-        avlist.remove(n);
+        avlist.erase(n);
 
-        if (ql::forward_scheduling == dir)
+        for (auto & a : (ql::forward_scheduling == dir ? graph.succs(n) : graph.preds(n)))
         {
-            for (ListDigraph::OutArcIt succArc(graph,n); succArc != INVALID; ++succArc)
+            if (IsSchedulable(a.node, scheduled, dir))
             {
-                ListDigraph::Node succNode = graph.target(succArc);
-                bool schedulable = true;
-                for (ListDigraph::InArcIt predArc(graph,succNode); predArc != INVALID; ++predArc)
-                {
-                    ListDigraph::Node predNode = graph.source(predArc);
-                    if (!scheduled[instruction[predNode]])
-                    {
-                        schedulable = false;
-                        break;
-                    }
-                }
-                if (schedulable)
-                {
-                    MakeAvailable(succNode, avlist, dir);
-                }
+                MakeAvailable(a.node, avlist, dir);
             }
         }
-        else
+    }
+
+    // take node n out of avlist as TakeAvailable does when forward scheduling,
+    // but make its successors available with MakeAvailableNoCycle, so without changing the scheduler or its gates
+    void TakeAvailableNoCycle(DepGraph::Node n, avlist_t& avlist, std::map<ql::gate*,bool> & scheduled) const
+    {
+        scheduled[instruction[n]] = true;
+        avlist.erase(n);
+
+        for (auto & a : graph.succs(n))
         {
-            for (ListDigraph::InArcIt predArc(graph,n); predArc != INVALID; ++predArc)
+            if (IsSchedulable(a.node, scheduled, ql::forward_scheduling))
             {
-                ListDigraph::Node predNode = graph.source(predArc);
-                bool schedulable = true;
-                for (ListDigraph::OutArcIt succArc(graph,predNode); succArc != INVALID; ++succArc)
-                {
-                    ListDigraph::Node succNode = graph.target(succArc);
-                    if (!scheduled[instruction[succNode]])
-                    {
-                        schedulable = false;
-                        break;
-                    }
-                }
-                if (schedulable)
-                {
-                    MakeAvailable(predNode, avlist, dir);
-                }
+                MakeAvailableNoCycle(a.node, avlist);
             }
         }
     }
 
     // advance curr_cycle
-    // when no node was selected from the avlist, advance to the next cycle
-    // and try again; this makes nodes/instructions to complete execution for one more cycle,
+    // when no node was selected from the avlist, advance to the next cycle in which one of them
+    // could be immediately schedulable, and try again; this makes nodes/instructions complete execution,
     // and makes resources finally available in case of resource constrained scheduling
     // so it contributes to proceeding and to finally have an empty avlist
-    void AdvanceCurrCycle(ql::scheduling_direction_t dir, size_t& curr_cycle)
-    {
-        if (ql::forward_scheduling == dir)
-        {
-            curr_cycle++;
-        }
-        else
-        {
-            curr_cycle--;
-        }
-    }
-
-    // reading platform dependent gate attributes for rc scheduling
     //
-    // get the gate parameters that need to be passed to the resource manager;
-    // it would have been nicer if they would have been made available by the platform
-    // directly to the resource manager since this function makes the mapper dependent on cc_light
-    void GetGateParameters(std::string id, const ql::quantum_platform& platform, std::string& operation_name, std::string& operation_type, std::string& instruction_type)
+    // a node cannot be scheduled before the nodes it depends on have completed (its cycle attribute)
+    // nor before the resources are available (rm.next_available); since without scheduling a node
+    // nothing changes, the cycles in between need not be tried one by one
+    void AdvanceCurrCycle(avlist_t& avlist, ql::scheduling_direction_t dir, size_t& curr_cycle,
+                                const ql::quantum_platform& platform, ql::arch::resource_manager_t& rm)
     {
-        DOUT("... getting gate parameters of " << id);
-        if (platform.instruction_settings.count(id) > 0)
+        size_t  next_cycle = (ql::forward_scheduling == dir ? MAX_CYCLE : 0);
+        for ( auto & kn : avlist.nodes)
         {
-            DOUT("...... extracting operation_name");
-	        if ( !platform.instruction_settings[id]["cc_light_instr"].is_null() )
-	        {
-	            operation_name = platform.instruction_settings[id]["cc_light_instr"];
-	        }
-            else
+            DepGraph::Node  n = kn.second;
+            ql::gate*       gp = instruction[n];
+            size_t          cycle;
+            if (ql::forward_scheduling == dir)
             {
-	            operation_name = id;
-                DOUT("...... faking operation_name to " << operation_name);
+                cycle = std::max(curr_cycle+1, gp->cycle);
             }
-
-            DOUT("...... extracting operation_type");
-	        if ( !platform.instruction_settings[id]["type"].is_null() )
-	        {
-	            operation_type = platform.instruction_settings[id]["type"];
-	        }
             else
             {
-	            operation_type = "cc_light_type";
-                DOUT("...... faking operation_type to " << operation_type);
+                cycle = std::min(curr_cycle-1, gp->cycle);
             }
-
-            DOUT("...... extracting instruction_type");
-	        if ( !platform.instruction_settings[id]["cc_light_instr_type"].is_null() )
-	        {
-	            instruction_type = platform.instruction_settings[id]["cc_light_instr_type"];
-	        }
-            else
+            if ( !(n == s || n == t
+                || gp->type() == ql::gate_type_t::__dummy_gate__
+                || gp->type() == ql::gate_type_t::__classical_gate__
+                || gp->type() == ql::gate_type_t::__wait_gate__)
+               )
             {
-	            instruction_type = "cc_light";
-                DOUT("...... faking instruction_type to " << instruction_type);
+                size_t      operation_duration = std::ceil( static_cast<float>(gp->duration) / cycle_time);
+                cycle = rm.next_available(cycle, gp, GetDescriptor(n, platform), operation_duration);
             }
+            next_cycle = (ql::forward_scheduling == dir ? std::min(next_cycle, cycle) : std::max(next_cycle, cycle));
         }
-        else
+        DOUT("... advancing from cycle " << curr_cycle << " to " << next_cycle);
+        curr_cycle = next_cycle;
+    }
+
+    // platform dependent gate attributes for rc scheduling
+    //
+    // get the descriptor of the gate's instruction that is passed to the resource manager;
+    // it is looked up once per node and per schedule, the platform having interned it when loaded
+    const ql::instruction_descriptor_t& GetDescriptor(DepGraph::Node n, const ql::quantum_platform& platform)
+    {
+        const ql::instruction_descriptor_t* dp = descriptor[n];
+        if (dp == NULL)
         {
-            DOUT("Error: platform doesn't support gate '" << id << "'");
-            EOUT("Error: platform doesn't support gate '" << id << "'");
-            throw ql::exception("[x] Error : platform doesn't support gate!",false);
+            ql::gate*   gp = instruction[n];
+            dp = platform.find_descriptor(gp->name);
+            if (dp == NULL)
+            {
+                DOUT("Error: platform doesn't support gate '" << gp->name << "'");
+                EOUT("Error: platform doesn't support gate '" << gp->name << "'");
+                throw ql::exception("[x] Error : platform doesn't support gate!",false);
+            }
+            descriptor[n] = dp;
         }
-        DOUT("... getting gate parameters [done]");
+        return *dp;
     }
 
     // a gate must wait until all its operand are available, i.e. the gates having computed them have completed,
     // and must wait until all resources required for the gate's execution are available;
     // return true when immediately schedulable
     // when returning false, isres indicates whether resource occupation was the reason or operand completion (for debugging)
-    bool immediately_schedulable(ListDigraph::Node n, ql::scheduling_direction_t dir, const size_t curr_cycle,
+    bool immediately_schedulable(DepGraph::Node n, ql::scheduling_direction_t dir, const size_t curr_cycle,
                                 const ql::quantum_platform& platform, ql::arch::resource_manager_t& rm, bool& isres)
     {
         ql::gate*   gp = instruction[n];
@@ -1609,13 +2047,9 @@ public:
             {
                 return true;
             }
-            std::string operation_name;
-            std::string operation_type;
-            std::string instruction_type;
             size_t      operation_duration = std::ceil( static_cast<float>(gp->duration) / cycle_time);
             // size_t      operation_duration = (gp->duration+cycle_time-1) / cycle_time;
-            GetGateParameters(gp->name, platform, operation_name, operation_type, instruction_type);
-            if (rm.available(curr_cycle, gp, operation_name, operation_type, instruction_type, operation_duration))
+            if (rm.available(curr_cycle, gp, GetDescriptor(n, platform), operation_duration))
             {
                 return true;
             }
@@ -1630,32 +2064,33 @@ public:
     }
 
     // select a node from the avlist
-    // the avlist is deep-ordered from high to low criticality (see criticality_lessthan above)
-    ListDigraph::Node SelectAvailable(std::list<ListDigraph::Node>& avlist, ql::scheduling_direction_t dir, const size_t curr_cycle,
+    // the avlist is deep-ordered from high to low criticality (see deepcrit_lessthan above)
+    DepGraph::Node SelectAvailable(avlist_t& avlist, ql::scheduling_direction_t dir, const size_t curr_cycle,
                                 const ql::quantum_platform& platform, ql::arch::resource_manager_t& rm, bool & success)
     {
         success = false;                        // whether a node was found and returned
         
         DOUT("avlist(@" << curr_cycle << "):");
-        for ( auto n : avlist)
+        for ( auto & kn : avlist.nodes)
         {
-            DOUT("...... node(@" << instruction[n]->cycle << "): " << name[n] << " remaining: " << remaining[n]);
+            DOUT("...... node(@" << instruction[kn.second]->cycle << "): " << instruction[kn.second]->qasm() << " remaining: " << remaining[kn.second]);
         }
 
         // select the first immediately schedulable, if any
         // since avlist is deep-criticality ordered, highest first, the first is the most deep-critical
-        for ( auto n : avlist)
+        for ( auto & kn : avlist.nodes)
         {
+            DepGraph::Node n = kn.second;
             bool isres;
             if ( immediately_schedulable(n, dir, curr_cycle, platform, rm, isres) )
             {
-                DOUT("... node (@" << instruction[n]->cycle << "): " << name[n] << " immediately schedulable, remaining=" << remaining[n] << ", selected");
+                DOUT("... node (@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " immediately schedulable, remaining=" << remaining[n] << ", selected");
                 success = true;
                 return n;
             }
             else
             {
-                DOUT("... node (@" << instruction[n]->cycle << "): " << name[n] << " remaining=" << remaining[n] << ", waiting for " << (isres? "resource" : "dependent completion"));
+                DOUT("... node (@" << instruction[n]->cycle << "): " << instruction[n]->qasm() << " remaining=" << remaining[n] << ", waiting for " << (isres? "resource" : "dependent completion"));
             }
         }
 
@@ -1673,7 +2108,7 @@ public:
     // - bundles are collected from the circuit
     // - latency compensation and buffer-buffer delay insertion done
     // the bundles are returned, with private start/duration attributes
-    ql::ir::bundles_t schedule_post179(ql::circuit* circp, ql::scheduling_direction_t dir,
+    ql::ir::flat_bundles_t schedule_post179(ql::circuit* circp, ql::scheduling_direction_t dir,
             const ql::quantum_platform& platform, ql::arch::resource_manager_t& rm, std::string& sched_dot)
     {
         DOUT("Scheduling " << (ql::forward_scheduling == dir?"ASAP":"ALAP") << " with RC ...");
@@ -1681,30 +2116,31 @@ public:
         // scheduled[gp] :=: whether gate *gp has been scheduled, init all false
         std::map<ql::gate*,bool>    scheduled;
         // avlist :=: list of schedulable nodes, initially (see below) just s or t
-        std::list<ListDigraph::Node>    avlist;
+        avlist_t    avlist;
 
         // initializations for this scheduler
         // note that dependence graph is not modified by a scheduler, so it can be reused
         DOUT("... initialization");
-        for (ListDigraph::NodeIt n(graph); n != INVALID; ++n)
+        for (auto gp : instruction)
         {
-            scheduled[instruction[n]] = false;   // none were scheduled, including SOURCE/SINK
+            scheduled[gp] = false;   // none were scheduled, including SOURCE/SINK
         }
+        descriptor.assign(instruction.size(), NULL);    // looked up in platform when first needed
         size_t  curr_cycle;         // current cycle for which instructions are sought
+        set_remaining(dir);         // for each gate, number of cycles until end of schedule, and rank
         init_available(avlist, dir, curr_cycle);     // first node (SOURCE/SINK) is made available and curr_cycle set
-        set_remaining(dir);         // for each gate, number of cycles until end of schedule
 
         DOUT("... loop over avlist until it is empty");
         while (!avlist.empty())
         {
             bool success;
-            ListDigraph::Node   selected_node;
+            DepGraph::Node  selected_node;
             
             selected_node = SelectAvailable(avlist, dir, curr_cycle, platform, rm, success);
             if (!success)
             {
                 // i.e. none from avlist was found suitable to schedule in this cycle
-                AdvanceCurrCycle(dir, curr_cycle); 
+                AdvanceCurrCycle(avlist, dir, curr_cycle, platform, rm);
                 // so try again; eventually instrs complete and machine is empty
                 continue;
             }
@@ -1720,15 +2156,11 @@ public:
                 && gp->type() != ql::gate_type_t::__wait_gate__ 
                )
             {
-                std::string operation_name;
-                std::string operation_type;
-                std::string instruction_type;
                 size_t      operation_duration = 0;
 
-                GetGateParameters(gp->name, platform, operation_name, operation_type, instruction_type);
                 // operation_duration = (gp->duration+cycle_time-1) / cycle_time;
                 operation_duration = std::ceil( static_cast<float>(gp->duration) / cycle_time);
-                rm.reserve(curr_cycle, gp, operation_name, operation_type, instruction_type, operation_duration);
+                rm.reserve(curr_cycle, gp, GetDescriptor(selected_node, platform), operation_duration);
             }
             TakeAvailable(selected_node, avlist, scheduled, dir);   // update avlist/scheduled/cycle
             // more nodes that could be scheduled in this cycle, will be found in an other round of the loop
@@ -1760,7 +2192,7 @@ public:
 
         latency_compensation(circp, platform);
 
-        ql::ir::bundles_t   bundles;
+        ql::ir::flat_bundles_t bundles;
         bundles = ql::ir::bundler(*circp, cycle_time);
 
         insert_buffer_delays(bundles, platform);
@@ -1769,9 +2201,9 @@ public:
         return bundles;
     }
 
-    ql::ir::bundles_t schedule_asap_post179(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform, std::string& sched_dot)
+    ql::ir::flat_bundles_t schedule_asap_post179(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform, std::string& sched_dot)
     {
-        ql::ir::bundles_t   bundles;
+        ql::ir::flat_bundles_t bundles;
         DOUT("Scheduling ASAP post179");
         bundles = schedule_post179(circp, ql::forward_scheduling, platform, rm, sched_dot);
 
@@ -1779,9 +2211,9 @@ public:
         return bundles;
     }
 
-    ql::ir::bundles_t schedule_alap_post179(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform, std::string& sched_dot)
+    ql::ir::flat_bundles_t schedule_alap_post179(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform, std::string& sched_dot)
     {
-        ql::ir::bundles_t   bundles;
+        ql::ir::flat_bundles_t bundles;
         DOUT("Scheduling ALAP post179");
         bundles = schedule_post179(circp, ql::backward_scheduling, platform, rm, sched_dot);
 
@@ -1790,7 +2222,7 @@ public:
     }
 
 // =========== post179 uniform
-    ql::ir::bundles_t schedule_alap_uniform_post179()
+    ql::ir::flat_bundles_t schedule_alap_uniform_post179()
     {
         // algorithm based on "Balanced Scheduling and Operation Chaining in High-Level Synthesis for FPGA Designs"
         // by David C. Zaretsky, Gaurav Mittal, Robert P. Dick, and Prith Banerjee
@@ -1799,8 +2231,10 @@ public:
         // - dependency analysis in article figure 2 is O(n^2) because of set union
         //   this has been left out, using our own linear dependency analysis creating a digraph
         //   and using the alap values as measure instead of the dep set size computed in article's D[n]
-        // - balanced scheduling algorithm dominates with its O(n^2) when it cannot find a node to forward
-        //   no test has been devised yet to break the loop (figure 3, line 14-35)
+        // - balanced scheduling algorithm in figure 3 is O(n^2) because it scans the bundles backward
+        //   for a node to forward (figure 3, line 14-35); instead, the nodes that can be forwarded
+        //   are kept in a heap ordered on the order of that scan, so the scan is replaced by taking the top;
+        //   the result is the same, see below
         // - targeted bundle size is adjusted each cycle and is number_of_gates_to_go/number_of_non_empty_bundles_to_go
         //   this is more greedy, preventing oscillation around a target size based on all bundles,
         //   because local variations caused by local dep chains create small bundles and thus leave more gates still to go
@@ -1814,7 +2248,7 @@ public:
         // Hence, the result resembles an ALAP schedule with excess bundle lengths solved by moving nodes down ("rolling pin").
 
         DOUT("Scheduling ALAP UNIFORM to get bundles ...");
-        ql::ir::bundles_t bundles;
+        ql::ir::flat_bundles_t bundles;
 
         // initialize gp->cycle as ASAP cycles as first approximation of result;
         // note that the circuit doesn't contain the SOURCE and SINK gates but the dependence graph does;
@@ -1832,13 +2266,17 @@ public:
         set_remaining(ql::forward_scheduling);
 
         // DOUT("Creating gates_per_cycle");
-        // create gates_per_cycle[cycle] = for each cycle the list of gates at cycle cycle
+        // create gates_per_cycle[cycle] = for each cycle the number of gates at cycle cycle
         // this is the basic map to be operated upon by the uniforming scheduler below;
-        std::map<size_t,std::list<ql::gate*>> gates_per_cycle;
+        // position[node] is the node's gate's position in the circuit, to break ties as the original scan would
+        std::vector<size_t> gates_per_cycle(cycle_count+2, 0);
+        std::vector<size_t> position(graph.size(), 0);
+        size_t  pos = 0;
         for ( ql::circuit::iterator gpit = circp->begin(); gpit != circp->end(); gpit++)
         {
             ql::gate*           gp = *gpit;
-            gates_per_cycle[gp->cycle].push_back(gp);
+            gates_per_cycle[gp->cycle]++;
+            position[node[gp]] = pos++;
         }
 
         // DOUT("Displaying circuit and bundle statistics");
@@ -1851,9 +2289,9 @@ public:
         size_t gate_count = 0;
         for (size_t curr_cycle = 1; curr_cycle <= cycle_count; curr_cycle++)
         {
-            max_gates_per_cycle = std::max(max_gates_per_cycle, gates_per_cycle[curr_cycle].size());
-            if (int(gates_per_cycle[curr_cycle].size()) != 0) non_empty_bundle_count++;
-            gate_count += gates_per_cycle[curr_cycle].size();
+            max_gates_per_cycle = std::max(max_gates_per_cycle, gates_per_cycle[curr_cycle]);
+            if (gates_per_cycle[curr_cycle] != 0) non_empty_bundle_count++;
+            gate_count += gates_per_cycle[curr_cycle];
         }
         double avg_gates_per_cycle = double(gate_count)/cycle_count;
         double avg_gates_per_non_empty_cycle = double(gate_count)/non_empty_bundle_count;
@@ -1867,26 +2305,70 @@ public:
             << "; avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle
             );
 
+        // A node can be forwarded to curr_cycle when its result, when moved, is ready before end-of-circuit
+        // and before used, i.e. when curr_cycle <= latest[node], with
+        // latest[node] :=: min(cycle_count+1, min over succs of the succ's cycle) - weight[node].
+        // latest[node] only increases, when a succ is forwarded, and curr_cycle only decreases in the scan,
+        // so once a node can be forwarded, it stays so until it is forwarded or curr_cycle is not above its cycle anymore.
+        //
+        // The original algorithm scanned for each curr_cycle the bundles backward from curr_cycle-1,
+        // taking in each bundle the node with lowest remaining that could be forwarded (first in circuit order when equal),
+        // and going to the next lower bundle only when there was none.
+        // Forwarding a node only increases latest of its preds, which are in lower bundles
+        // (or in the same bundle when of zero duration), so a bundle once passed by the scan doesn't get more candidates.
+        // Hence the scan takes the node that can be forwarded with highest cycle, then lowest remaining, then lowest position,
+        // which is the top of the heap below (the avlist), when the nodes at cycles curr_cycle or higher are popped first.
+        // Nodes are pushed onto it when latest[node] reaches curr_cycle,
+        // using waiting[c] to find the nodes with latest c when the scan reaches c.
+        std::vector<long>   latest(graph.size(), 0);
+        std::vector<bool>   inlist(graph.size(), false);    // node was pushed onto the avlist
+        std::vector<std::vector<DepGraph::Node>>    waiting(cycle_count+1);
+        auto set_latest = [&](DepGraph::Node n)
+        {
+            long    l = cycle_count+1;
+            for (auto & a : graph.succs(n))
+            {
+                l = std::min(l, long(instruction[a.node]->cycle));
+            }
+            latest[n] = l - weight[n];
+        };
+        auto earlier_in_scan = [&](DepGraph::Node n1, DepGraph::Node n2)
+        {
+            // whether n2 is found before n1 in the scan, i.e. whether n1 is below n2 in the heap
+            if (instruction[n1]->cycle != instruction[n2]->cycle) return instruction[n1]->cycle < instruction[n2]->cycle;
+            if (remaining[n1] != remaining[n2]) return remaining[n1] > remaining[n2];
+            return position[n1] > position[n2];
+        };
+        std::priority_queue<DepGraph::Node, std::vector<DepGraph::Node>, decltype(earlier_in_scan)> avlist(earlier_in_scan);
+        for (auto gp : *circp)
+        {
+            DepGraph::Node  n = node[gp];
+            set_latest(n);
+            if (latest[n] >= 1)
+            {
+                waiting[std::min(latest[n], long(cycle_count))].push_back(n);
+            }
+        }
+
         // in a backward scan, make non-empty bundles max avg_gates_per_non_empty_cycle long;
         // an earlier version of the algorithm aimed at making bundles max avg_gates_per_cycle long
         // but that flawed because of frequent empty bundles causing this estimate for a uniform length being too low
         // DOUT("Backward scan uniform scheduling");
         for (size_t curr_cycle = cycle_count; curr_cycle >= 1; curr_cycle--)
         {
-            // Backward with pred_cycle from curr_cycle-1 down to 1, look for node(s) to fill up current too small bundle.
+            // Look for node(s) at cycles below curr_cycle to fill up current too small bundle.
             // After an iteration at cycle curr_cycle, all bundles from curr_cycle to cycle_count have been filled up,
             // and all bundles from 1 to curr_cycle-1 still have to be done.
             // This assumes that current bundle is never too long, excess having been moved away earlier, as ASAP does.
-            // When such a node cannot be found, this loop scans the whole circuit for each original node to fill up
-            // and this creates a O(n^2) time complexity.
-            //
-            // A test to break this prematurely based on the current data structure, wasn't devised yet.
-            // A solution is to use the dep graph instead to find a node to fill up the current node,
-            // i.e. maintain a so-called "available list" of nodes free to schedule, as in the non-uniform scheduling algorithm,
-            // which is not hard at all but which is not according to the published algorithm.
-            // When the complexity becomes a problem, it is proposed to rewrite the algorithm accordingly.
-
-            long pred_cycle = curr_cycle - 1;    // signed because can become negative
+            for (auto n : waiting[curr_cycle])
+            {
+                if (!inlist[n] && std::min(latest[n], long(cycle_count)) == long(curr_cycle))
+                {
+                    inlist[n] = true;
+                    avlist.push(n);
+                }
+            }
+            waiting[curr_cycle].clear();
 
             // target size of each bundle is number of gates still to go divided by number of non-empty cycles to go
             // it averages over non-empty bundles instead of all bundles because the latter would be very strict
@@ -1894,99 +2376,79 @@ public:
             if (non_empty_bundle_count == 0) break;     // nothing to do
             avg_gates_per_cycle = double(gate_count)/curr_cycle;
             avg_gates_per_non_empty_cycle = double(gate_count)/non_empty_bundle_count;
-            DOUT("Cycle=" << curr_cycle << " number of gates=" << gates_per_cycle[curr_cycle].size()
+            DOUT("Cycle=" << curr_cycle << " number of gates=" << gates_per_cycle[curr_cycle]
                 << "; avg_gates_per_cycle=" << avg_gates_per_cycle
                 << "; avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle);
 
-            while ( double(gates_per_cycle[curr_cycle].size()) < avg_gates_per_non_empty_cycle && pred_cycle >= 1 )
+            while ( double(gates_per_cycle[curr_cycle]) < avg_gates_per_non_empty_cycle )
             {
-                DOUT("pred_cycle=" << pred_cycle);
-                DOUT("gates_per_cycle[curr_cycle].size()=" << gates_per_cycle[curr_cycle].size());
-                size_t      min_remaining_cycle = MAX_CYCLE;
-                ql::gate*   best_predgp;
-                bool        best_predgp_found = false;
+                // nodes at curr_cycle or higher cannot be forwarded anymore
+                while (!avlist.empty() && instruction[avlist.top()]->cycle >= curr_cycle)
+                {
+                    avlist.pop();
+                }
+                if (avlist.empty())
+                {
+                    break;
+                }
+                DepGraph::Node  best_node = avlist.top();
+                avlist.pop();
+                ql::gate*       best_predgp = instruction[best_node];
+                size_t          pred_cycle = best_predgp->cycle;
+
+                // move predgp from pred_cycle to curr_cycle;
+                // adjust all bookkeeping that is affected by this
+                gates_per_cycle[pred_cycle]--;
+                if (gates_per_cycle[pred_cycle] == 0)
+                {
+                    // source bundle was non-empty, now it is empty
+                    non_empty_bundle_count--;
+                }
+                if (gates_per_cycle[curr_cycle] == 0)
+                {
+                    // target bundle was empty, now it will be non_empty
+                    non_empty_bundle_count++;
+                }
+                best_predgp->cycle = curr_cycle;        // what it is all about
+                gates_per_cycle[curr_cycle]++;
 
-                // scan bundle at pred_cycle to find suitable candidate to move forward to curr_cycle
-                for ( auto predgp : gates_per_cycle[pred_cycle] )
+                // its preds may now be forwarded to later cycles
+                for (auto & a : graph.preds(best_node))
                 {
-                    bool    forward_predgp = true;
-                    size_t  predgp_completion_cycle;
-                    ListDigraph::Node   pred_node = node[predgp];
-                    DOUT("... considering: " << predgp->qasm() << " @cycle=" << predgp->cycle << " remaining=" << remaining[pred_node]);
-
-                    // candidate's result, when moved, must be ready before end-of-circuit and before used
-                    predgp_completion_cycle = curr_cycle + std::ceil(static_cast<float>(predgp->duration)/cycle_time);
-                    // predgp_completion_cycle = curr_cycle + (predgp->duration+cycle_time-1)/cycle_time;
-                    if (predgp_completion_cycle > cycle_count + 1)  // at SINK is ok, later not
+                    DepGraph::Node  pn = a.node;
+                    if (pn == s || inlist[pn] || latest[pn] + weight[pn] < long(pred_cycle))
                     {
-                        forward_predgp = false;
-                        DOUT("... ... rejected (after circuit): " << predgp->qasm() << " would complete @" << predgp_completion_cycle << " SINK @" << cycle_count+1);
+                        // SOURCE, already in avlist, or the moved node didn't determine latest
+                        continue;
                     }
-                    else
+                    set_latest(pn);
+                    if (latest[pn] >= long(curr_cycle))
                     {
-                        for ( ListDigraph::OutArcIt arc(graph,pred_node); arc != INVALID; ++arc )
-                        {
-                            ql::gate*   target_gp = instruction[graph.target(arc)];
-                            size_t target_cycle = target_gp->cycle;
-                            if(predgp_completion_cycle > target_cycle)
-                            {
-                                forward_predgp = false;
-                                DOUT("... ... rejected (after succ): " << predgp->qasm() << " would complete @" << predgp_completion_cycle << " target=" << target_gp->qasm() << " target_cycle=" << target_cycle);
-                            }
-                        }
+                        inlist[pn] = true;
+                        avlist.push(pn);
                     }
-
-                    // when multiple nodes in bundle qualify, take the one with lowest remaining
-                    // because that is the most critical one and thus deserves a cycle as high as possible (ALAP)
-                    if (forward_predgp && remaining[pred_node] < min_remaining_cycle)
+                    else if (latest[pn] >= 1)
                     {
-                        min_remaining_cycle = remaining[pred_node];
-                        best_predgp_found = true;
-                        best_predgp = predgp;
+                        waiting[latest[pn]].push_back(pn);
                     }
                 }
 
-                // when candidate was found in this bundle, move it, and search for more in this bundle, if needed
-                // otherwise, continue scanning backward
-                if (best_predgp_found)
-                {
-                    // move predgp from pred_cycle to curr_cycle;
-                    // adjust all bookkeeping that is affected by this
-                    gates_per_cycle[pred_cycle].remove(best_predgp);
-                    if (gates_per_cycle[pred_cycle].size() == 0)
-                    {
-                        // source bundle was non-empty, now it is empty
-                        non_empty_bundle_count--;
-                    }
-                    if (gates_per_cycle[curr_cycle].size() == 0)
-                    {
-                        // target bundle was empty, now it will be non_empty
-                        non_empty_bundle_count++;
-                    }
-                    best_predgp->cycle = curr_cycle;        // what it is all about
-                    gates_per_cycle[curr_cycle].push_back(best_predgp);
-                   
-                    // recompute targets
-                    if (non_empty_bundle_count == 0) break;     // nothing to do
-                    avg_gates_per_cycle = double(gate_count)/curr_cycle;
-                    avg_gates_per_non_empty_cycle = double(gate_count)/non_empty_bundle_count;
-                    DOUT("... moved " << best_predgp->qasm() << " with remaining=" << remaining[node[best_predgp]]
-                        << " from cycle=" << pred_cycle << " to cycle=" << curr_cycle
-                        << "; new avg_gates_per_cycle=" << avg_gates_per_cycle
-                        << "; avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle
-                        );
-                }
-                else
-                {
-                    pred_cycle --;
-                }
-            }   // end for finding a bundle to forward a node from to the current cycle
+                // recompute targets
+                if (non_empty_bundle_count == 0) break;     // nothing to do
+                avg_gates_per_cycle = double(gate_count)/curr_cycle;
+                avg_gates_per_non_empty_cycle = double(gate_count)/non_empty_bundle_count;
+                DOUT("... moved " << best_predgp->qasm() << " with remaining=" << remaining[best_node]
+                    << " from cycle=" << pred_cycle << " to cycle=" << curr_cycle
+                    << "; new avg_gates_per_cycle=" << avg_gates_per_cycle
+                    << "; avg_gates_per_non_empty_cycle=" << avg_gates_per_non_empty_cycle
+                    );
+            }   // end for finding a node to forward to the current cycle
 
             // curr_cycle ready, recompute counts for remaining cycles
             // mask current cycle and its gates from the target counts:
             // - gate_count, non_empty_bundle_count, curr_cycle (as cycles still to go)
-            gate_count -= gates_per_cycle[curr_cycle].size();
-            if (gates_per_cycle[curr_cycle].size() != 0)
+            gate_count -= gates_per_cycle[curr_cycle];
+            if (gates_per_cycle[curr_cycle] != 0)
             {
                 // bundle is non-empty
                 non_empty_bundle_count--;
@@ -2003,9 +2465,9 @@ public:
         // cycle_count was not changed
         for (size_t curr_cycle = 1; curr_cycle <= cycle_count; curr_cycle++)
         {
-            max_gates_per_cycle = std::max(max_gates_per_cycle, gates_per_cycle[curr_cycle].size());
-            if (int(gates_per_cycle[curr_cycle].size()) != 0) non_empty_bundle_count++;
-            gate_count += gates_per_cycle[curr_cycle].size();
+            max_gates_per_cycle = std::max(max_gates_per_cycle, gates_per_cycle[curr_cycle]);
+            if (gates_per_cycle[curr_cycle] != 0) non_empty_bundle_count++;
+            gate_count += gates_per_cycle[curr_cycle];
         }
         avg_gates_per_cycle = double(gate_count)/cycle_count;
         avg_gates_per_non_empty_cycle = double(gate_count)/non_empty_bundle_count;
@@ -2035,38 +2497,20 @@ public:
                 )
     {
         DOUT("Get_dot post179");
-        Path<ListDigraph> p;
-        ListDigraph::ArcMap<bool> isInCritical(graph);
-        if(WithCritical)
-        {
-            for (ListDigraph::ArcIt a(graph); a != INVALID; ++a)
-            {
-                isInCritical[a] = false;
-                for ( Path<ListDigraph>::ArcIt ap(p); ap != INVALID; ++ap )
-                {
-                    if(a==ap)
-                    {
-                        isInCritical[a] = true;
-                        break;
-                    }
-                }
-            }
-        }
-
+        // no critical path is computed, so with WithCritical no arc is in it and all get EdgeStyle1
         string NodeStyle(" fontcolor=black, style=filled, fontsize=16");
         string EdgeStyle1(" color=black");
-        string EdgeStyle2(" color=red");
         string EdgeStyle = EdgeStyle1;
 
         dotout << "digraph {\ngraph [ rankdir=TD; ]; // or rankdir=LR"
             << "\nedge [fontsize=16, arrowhead=vee, arrowsize=0.5];"
             << endl;
 
-        // first print the nodes
-        for (ListDigraph::NodeIt n(graph); n != INVALID; ++n)
+        // first print the nodes, last added first
+        for (DepGraph::Node n = DepGraph::Node(graph.size())-1; n >= 0; n--)
         {
-            dotout  << "\"" << graph.id(n) << "\""
-                    << " [label=\" " << name[n] <<" \""
+            dotout  << "\"" << n << "\""
+                    << " [label=\" " << instruction[n]->qasm() <<" \""
                     << NodeStyle
                     << "];" << endl;
         }
@@ -2094,37 +2538,32 @@ public:
             dotout << ";\n}\n";
 
             // Now print ranks, as shown below
-            dotout << "{ rank=same; Cycle" << instruction[s]->cycle <<"; " << graph.id(s) << "; }\n";
+            dotout << "{ rank=same; Cycle" << instruction[s]->cycle <<"; " << s << "; }\n";
             for (auto gp : *circp)
             {
-                dotout << "{ rank=same; Cycle" << gp->cycle <<"; " << graph.id(node[gp]) << "; }\n";
+                dotout << "{ rank=same; Cycle" << gp->cycle <<"; " << node[gp] << "; }\n";
             }
-            dotout << "{ rank=same; Cycle" << instruction[t]->cycle <<"; " << graph.id(t) << "; }\n";
+            dotout << "{ rank=same; Cycle" << instruction[t]->cycle <<"; " << t << "; }\n";
         }
 
         // now print the edges
-        for (ListDigraph::ArcIt arc(graph); arc != INVALID; ++arc)
-        {
-            ListDigraph::Node srcNode = graph.source(arc);
-            ListDigraph::Node dstNode = graph.target(arc);
-            int srcID = graph.id( srcNode );
-            int dstID = graph.id( dstNode );
-
-            if(WithCritical)
-                EdgeStyle = ( isInCritical[arc]==true ) ? EdgeStyle2 : EdgeStyle1;
-
-            dotout << dec
-                << "\"" << srcID << "\""
-                << "->"
-                << "\"" << dstID << "\""
-                << "[ label=\""
-                << "q" << cause[arc]
-                << " , " << weight[arc]
-                << " , " << DepTypesNames[ depType[arc] ]
-                <<"\""
-                << " " << EdgeStyle << " "
-                << "]"
-                << endl;
+        for (DepGraph::Node srcID = DepGraph::Node(graph.size())-1; srcID >= 0; srcID--)
+        {
+            for (auto & a : graph.succs(srcID))
+            {
+                dotout << dec
+                    << "\"" << srcID << "\""
+                    << "->"
+                    << "\"" << a.node << "\""
+                    << "[ label=\""
+                    << "q" << DepGraph::cause(a)
+                    << " , " << weight[srcID]
+                    << " , " << DepTypesNames[ DepGraph::deptype(a) ]
+                    <<"\""
+                    << " " << EdgeStyle << " "
+                    << "]"
+                    << endl;
+            }
         }
 
         dotout << "}" << endl;
@@ -2135,7 +2574,7 @@ public:
 
 // =========== scheduling entry points switching out to pre179 or post179
 
-    ql::ir::bundles_t schedule_asap(std::string & sched_dot)
+    ql::ir::flat_bundles_t schedule_asap(std::string & sched_dot)
     {
         if (ql::options::get("scheduler_post179") == "no")
         {
@@ -2147,7 +2586,7 @@ public:
         }
     }
 
-    ql::ir::bundles_t schedule_asap(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform,
+    ql::ir::flat_bundles_t schedule_asap(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform,
         std::string & sched_dot)
     {
         if (ql::options::get("scheduler_post179") == "no")
@@ -2160,7 +2599,7 @@ public:
         }
     }
 
-    ql::ir::bundles_t schedule_alap(std::string & sched_dot)
+    ql::ir::flat_bundles_t schedule_alap(std::string & sched_dot)
     {
         if (ql::options::get("scheduler_post179") == "no")
         {
@@ -2172,7 +2611,7 @@ public:
         }
     }
 
-    ql::ir::bundles_t schedule_alap(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform,
+    ql::ir::flat_bundles_t schedule_alap(ql::arch::resource_manager_t & rm, const ql::quantum_platform & platform,
         std::string & sched_dot)
     {
         if (ql::options::get("scheduler_post179") == "no")
@@ -2185,7 +2624,7 @@ public:
         }
     }
 
-    ql::ir::bundles_t schedule_alap_uniform()
+    ql::ir::flat_bundles_t schedule_alap_uniform()
     {
         if (ql::options::get("scheduler_post179") == "no")
         {
@@ -0,0 +1,165 @@
+/**
+ * @file   thread_pool.h
+ * @date   10/2026
+ * @brief  fixed-size pool of worker threads running indexed tasks
+ */
+
+#ifndef QL_THREAD_POOL_H
+#define QL_THREAD_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+namespace ql
+{
+    /**
+     * pool of worker threads, created once and reused for each parallel_for call
+     *
+     * parallel_for(ntasks, f) calls f(task, worker) for each task index 0 <= task < ntasks
+     * and returns when all have completed; worker (0 <= worker < size()) identifies the thread
+     * running the task, so that f can use per-worker state without locking.
+     * Which worker runs which task is not deterministic; results must be stored per task
+     * and combined by the caller in task order to get deterministic output.
+     * An exception thrown by a task is rethrown by parallel_for, after all tasks have stopped.
+     * A pool of size 1 runs the tasks in the calling thread.
+     */
+    class thread_pool
+    {
+    private:
+        size_t                      nworkers;
+        std::vector<std::thread>    workers;
+        std::mutex                  m;
+        std::condition_variable     cv_start;       // signals workers that a job was posted or stop was set
+        std::condition_variable     cv_done;        // signals caller that all tasks of the job completed
+        std::function<void(size_t,size_t)> job;     // current job, called as job(task, worker)
+        size_t                      ntasks = 0;     // number of tasks in current job
+        size_t                      next = 0;       // next task to be taken
+        size_t                      busy = 0;       // number of tasks taken but not completed
+        size_t                      generation = 0; // incremented for each posted job
+        bool                        stop = false;
+        std::exception_ptr          error;          // first exception thrown by a task of the current job
+
+        void work(size_t worker)
+        {
+            size_t  seen = 0;
+            std::unique_lock<std::mutex> lock(m);
+            while (true)
+            {
+                cv_start.wait(lock, [this,seen]() { return stop || generation != seen; });
+                if (stop)
+                {
+                    return;
+                }
+                seen = generation;
+                while (next < ntasks)
+                {
+                    size_t task = next++;
+                    busy++;
+                    lock.unlock();
+                    try
+                    {
+                        job(task, worker);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> elock(m);
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                        next = ntasks;          // don't start further tasks
+                    }
+                    lock.lock();
+                    busy--;
+                }
+                if (busy == 0)
+                {
+                    cv_done.notify_all();
+                }
+            }
+        }
+
+    public:
+        thread_pool(size_t n) : nworkers(n == 0 ? 1 : n)
+        {
+            if (nworkers > 1)
+            {
+                for (size_t w = 0; w < nworkers; w++)
+                {
+                    workers.emplace_back(&thread_pool::work, this, w);
+                }
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stop = true;
+            }
+            cv_start.notify_all();
+            for (auto & t : workers)
+            {
+                t.join();
+            }
+        }
+
+        size_t size() const
+        {
+            return nworkers;
+        }
+
+        void parallel_for(size_t n, std::function<void(size_t,size_t)> f)
+        {
+            if (nworkers == 1 || n <= 1)
+            {
+                for (size_t task = 0; task < n; task++)
+                {
+                    f(task, 0);
+                }
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(m);
+            job = f;
+            ntasks = n;
+            next = 0;
+            busy = 0;
+            error = nullptr;
+            generation++;
+            cv_start.notify_all();
+            cv_done.wait(lock, [this]() { return next >= ntasks && busy == 0; });
+            job = nullptr;
+            if (error)
+            {
+                std::exception_ptr e = error;
+                error = nullptr;
+                lock.unlock();
+                std::rethrow_exception(e);
+            }
+        }
+    };
+
+    // number of threads that a thread count option value (e.g. mapper_threads) asks for;
+    // 0 (or a negative value) means one per core
+    inline size_t threads_from_option(const std::string & optval)
+    {
+        int nthreads = atoi(optval.c_str());
+        if (nthreads <= 0)
+        {
+            nthreads = std::thread::hardware_concurrency();
+        }
+        return nthreads;
+    }
+}
+
+#endif // QL_THREAD_POOL_H
@@ -0,0 +1,372 @@
+/**
+ * @file   bench_mapper.cc
+ * @date   10/2026
+ * @brief  mapper benchmark on the circuits of test_mapper.cc
+ *
+ * Runs each circuit with each mapper configuration in a separate process,
+ * and records wall time of the compilation, time taken by the mapper, peak resident set size,
+ * swaps added and depth before and after mapping (as reported in the prescheduler's and mapper's report files).
+ * The results are written as JSON and CSV.
+ * When a baseline (a CSV file as written by an earlier run) is given, the run fails (exit status 1)
+ * when the swaps added or depth after mapping of any run exceeds the baseline's value by more than the threshold fraction.
+ * Time and peak memory depend on the machine (and C++ library), so they are only compared with --check_time and --check_rss,
+ * against a baseline recorded on the same machine:
+ * the times of the single runs are too short to compare without timer noise, so the total mapper time of all runs is compared,
+ * and only when the baseline's total is at least mintime seconds.
+ */
+
+#define BENCH_MAPPER
+#include "test_mapper.cc"
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <vector>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <CLI/CLI.hpp>
+
+typedef struct
+{
+    std::string             name;
+    std::function<void()>   run;        // builds the circuit, sets its options and compiles it
+} bench_circuit_t;
+
+typedef struct
+{
+    std::string             name;
+    std::map<std::string,std::string> opts;   // options set before the circuit is run
+} bench_config_t;
+
+typedef struct
+{
+    std::string circuit;
+    std::string config;
+    bool        ok;         // false when the run failed, other fields then are 0
+    double      walltime;   // seconds, whole compilation
+    double      mappertime; // seconds, mapper only, from report
+    long        peakrss;    // kilobytes
+    size_t      swaps;
+    size_t      depthin;
+    size_t      depthout;
+} bench_result_t;
+
+static std::vector<bench_circuit_t> bench_circuits()
+{
+    return {
+        { "lingling7esm",   [](){ test_lingling7esm("lingling7esm", "all", "no", "1", "min"); } },
+        { "daniel2",        [](){ test_daniel2("daniel2", "all", "no", "1", "min"); } },
+        { "maxcut",         [](){ test_maxcut("maxcut", "all", "no", "1", "min"); } },
+        { "allD2",          [](){ test_allD2("allD2", "all", "no", "1", "min"); } },
+    };
+}
+
+static std::vector<bench_config_t> bench_configs()
+{
+    return {
+        { "base",           { {"mapper", "base"} } },
+        { "minextend",      { {"mapper", "minextend"} } },
+        { "minextendrc",    { {"mapper", "minextendrc"} } },
+        { "beam",           { {"mapper", "beam"}, {"mapbeamwidth", "4"} } },
+    };
+}
+
+// find the value of the first line in file fname starting with "# <key>: "
+static bool read_report_value(const std::string& fname, const std::string& key, double& val)
+{
+    std::ifstream   ifs(fname);
+    std::string     line;
+    std::string     prefix = "# " + key + ": ";
+    while (std::getline(ifs, line))
+    {
+        if (line.compare(0, prefix.size(), prefix) == 0)
+        {
+            val = atof(line.substr(prefix.size()).c_str());
+            return true;
+        }
+    }
+    return false;
+}
+
+// find the file in directory dir of which the name ends in suffix
+static std::string find_file(const std::string& dir, const std::string& suffix)
+{
+    std::string result;
+    DIR*        dp = opendir(dir.c_str());
+    if (dp == NULL)
+    {
+        return result;
+    }
+    while (struct dirent* ep = readdir(dp))
+    {
+        std::string name(ep->d_name);
+        if (name.size() >= suffix.size() && name.compare(name.size()-suffix.size(), suffix.size(), suffix) == 0)
+        {
+            result = dir + "/" + name;
+            break;
+        }
+    }
+    closedir(dp);
+    return result;
+}
+
+// in a child process: run circuit c with configuration m with output in dir,
+// and write the measurements to file descriptor fd
+static void run_child(const bench_circuit_t& c, const bench_config_t& m, const std::string& dir, int fd)
+{
+    ql::options::set("output_dir", dir);
+    for (auto & o : m.opts)
+    {
+        ql::options::set(o.first, o.second);
+    }
+
+    auto t1 = std::chrono::steady_clock::now();
+    c.run();
+    std::chrono::duration<double> walltime = std::chrono::steady_clock::now() - t1;
+
+    double  mappertime = 0, swaps = 0, depthin = 0, depthout = 0;
+    std::string inreport = find_file(dir, "_prescheduler_out.report");   // the mapper's input isn't scheduled
+    std::string outreport = find_file(dir, "_mapper_out.report");
+    bool    ok = read_report_value(inreport, "Total depth", depthin)
+              && read_report_value(outreport, "Total depth", depthout)
+              && read_report_value(outreport, "Total no. of swaps", swaps)
+              && read_report_value(outreport, "Total time taken", mappertime);
+
+    std::stringstream ss;
+    ss << walltime.count() << " " << mappertime << " " << size_t(swaps) << " " << size_t(depthin) << " " << size_t(depthout) << "\n";
+    std::string s = ss.str();
+    if (ok && write(fd, s.c_str(), s.size()) == ssize_t(s.size()))
+    {
+        _exit(0);
+    }
+    _exit(1);
+}
+
+static bench_result_t run(const bench_circuit_t& c, const bench_config_t& m, const std::string& outdir)
+{
+    bench_result_t  r = { c.name, m.name, false, 0, 0, 0, 0, 0, 0 };
+    std::string     dir = outdir + "/" + c.name + "_" + m.name;
+    mkdir(dir.c_str(), 0755);
+
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return r;
+    }
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        run_child(c, m, dir, fds[1]);
+    }
+    close(fds[1]);
+
+    std::string result;
+    char        buf[256];
+    ssize_t     n;
+    while ((n = read(fds[0], buf, sizeof(buf))) > 0)
+    {
+        result.append(buf, n);
+    }
+    close(fds[0]);
+
+    int             status = 0;
+    struct rusage   ru;
+    if (pid < 0 || wait4(pid, &status, 0, &ru) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        return r;
+    }
+    std::istringstream iss(result);
+    iss >> r.walltime >> r.mappertime >> r.swaps >> r.depthin >> r.depthout;
+    r.peakrss = ru.ru_maxrss;
+#ifdef __APPLE__
+    r.peakrss /= 1024;      // bytes there, kilobytes on Linux
+#endif
+    r.ok = !iss.fail();
+    return r;
+}
+
+static const char* csv_header = "circuit,config,ok,walltime,mappertime,peakrss_kb,swaps,depth_in,depth_out";
+
+static void write_csv(const std::string& fname, const std::vector<bench_result_t>& results)
+{
+    std::ofstream   ofs(fname);
+    ofs << csv_header << "\n";
+    for (auto & r : results)
+    {
+        ofs << r.circuit << "," << r.config << "," << r.ok << "," << r.walltime << "," << r.mappertime << ","
+            << r.peakrss << "," << r.swaps << "," << r.depthin << "," << r.depthout << "\n";
+    }
+}
+
+static void write_json(const std::string& fname, const std::vector<bench_result_t>& results)
+{
+    std::ofstream   ofs(fname);
+    ofs << "[\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        auto & r = results[i];
+        ofs << "  { \"circuit\": \"" << r.circuit << "\", \"config\": \"" << r.config << "\""
+            << ", \"ok\": " << (r.ok ? "true" : "false")
+            << ", \"walltime\": " << r.walltime << ", \"mappertime\": " << r.mappertime
+            << ", \"peakrss_kb\": " << r.peakrss << ", \"swaps\": " << r.swaps
+            << ", \"depth_in\": " << r.depthin << ", \"depth_out\": " << r.depthout << " }"
+            << (i+1 < results.size() ? "," : "") << "\n";
+    }
+    ofs << "]\n";
+}
+
+static std::map<std::string,bench_result_t> read_csv(const std::string& fname)
+{
+    std::map<std::string,bench_result_t> results;
+    std::ifstream   ifs(fname);
+    std::string     line;
+    if (!std::getline(ifs, line) || line != csv_header)
+    {
+        return results;
+    }
+    while (std::getline(ifs, line))
+    {
+        for (auto & ch : line)
+        {
+            if (ch == ',') ch = ' ';
+        }
+        std::istringstream iss(line);
+        bench_result_t  r;
+        iss >> r.circuit >> r.config >> r.ok >> r.walltime >> r.mappertime >> r.peakrss >> r.swaps >> r.depthin >> r.depthout;
+        if (!iss.fail())
+        {
+            results[r.circuit + "," + r.config] = r;
+        }
+    }
+    return results;
+}
+
+// whether value regressed relative to baseline value base; prints it when so
+static bool regressed(const bench_result_t& r, const std::string& what, double value, double base, double threshold)
+{
+    if (value > base * (1.0 + threshold))
+    {
+        std::cerr << "REGRESSION " << r.circuit << "," << r.config << ": " << what << " " << value
+                  << " exceeds baseline " << base << " by more than " << threshold*100 << "%" << std::endl;
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char ** argv)
+{
+    std::string jsonfile = "bench_mapper.json";
+    std::string csvfile = "bench_mapper.csv";
+    std::string baselinefile;
+    std::string outdir = "bench_mapper_output";
+    double      threshold = 0.25;
+    double      mintime = 0.1;
+    bool        checktime = false;
+    bool        checkrss = false;
+
+    CLI::App app{"bench_mapper: runs test_mapper circuits for several mapper options and checks against a baseline"};
+    app.add_option("--json", jsonfile, "Name of JSON results file", true);
+    app.add_option("--csv", csvfile, "Name of CSV results file", true);
+    app.add_option("--baseline", baselinefile, "Name of CSV baseline file to check the results against", true);
+    app.add_option("--threshold", threshold, "Fraction by which a result may exceed its baseline value", true);
+    app.add_option("--mintime", mintime, "Minimum total baseline mapper time in seconds for times to be compared", true);
+    app.add_flag("--check_time", checktime, "Also fail on a regression of the total mapper time");
+    app.add_flag("--check_rss", checkrss, "Also fail on a regression of the peak resident set size of a run");
+    app.add_option("--output_dir", outdir, "Name of directory for the compiler's output files", true);
+    CLI11_PARSE(app, argc, argv);
+
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("unique_output", "no");
+    ql::options::set("write_qasm_files", "no");
+    ql::options::set("write_report_files", "yes");
+    ql::options::set("print_dot_graphs", "no");
+    ql::options::set("use_default_gates", "no");
+    ql::options::set("clifford_premapper", "yes");
+    ql::options::set("mapinitone2one", "yes");
+    ql::options::set("mapselectswaps", "all");
+    ql::options::set("initialplace", "no");
+    ql::options::set("mappathselect", "all");
+    ql::options::set("mapusemoves", "yes");
+    ql::options::set("mapreverseswap", "yes");
+    ql::options::set("maptiebreak", "first");   // random would make swaps and depth irreproducible
+    ql::options::set("clifford_postmapper", "yes");
+    ql::options::set("scheduler_post179", "yes");
+    ql::options::set("scheduler", "ALAP");
+    ql::options::set("scheduler_commute", "yes");
+    ql::options::set("prescheduler", "yes");
+
+    mkdir(outdir.c_str(), 0755);
+    std::vector<bench_result_t> results;
+    for (auto & c : bench_circuits())
+    {
+        for (auto & m : bench_configs())
+        {
+            bench_result_t r = run(c, m, outdir);
+            std::cout << r.circuit << " " << r.config << ": " << (r.ok ? "" : "FAILED ")
+                      << "walltime=" << r.walltime << " mappertime=" << r.mappertime << " peakrss_kb=" << r.peakrss
+                      << " swaps=" << r.swaps << " depth_in=" << r.depthin << " depth_out=" << r.depthout << std::endl;
+            results.push_back(r);
+        }
+    }
+    write_csv(csvfile, results);
+    write_json(jsonfile, results);
+
+    int exitcode = 0;
+    for (auto & r : results)
+    {
+        if (!r.ok)
+        {
+            exitcode = 1;
+        }
+    }
+    if (!baselinefile.empty())
+    {
+        auto baseline = read_csv(baselinefile);
+        if (baseline.empty())
+        {
+            std::cerr << "no baseline results in '" << baselinefile << "'" << std::endl;
+            return 1;
+        }
+        double  totaltime = 0, basetotaltime = 0;
+        for (auto & r : results)
+        {
+            auto it = baseline.find(r.circuit + "," + r.config);
+            if (it == baseline.end())
+            {
+                std::cout << "no baseline for " << r.circuit << "," << r.config << std::endl;
+                continue;
+            }
+            auto & b = it->second;
+            bool    bad = false;
+            totaltime += r.mappertime;
+            basetotaltime += b.mappertime;
+            if (checkrss)
+            {
+                bad = regressed(r, "peakrss_kb", r.peakrss, b.peakrss, threshold) || bad;
+            }
+            bad = regressed(r, "swaps", r.swaps, b.swaps, threshold) || bad;
+            bad = regressed(r, "depth_out", r.depthout, b.depthout, threshold) || bad;
+            if (bad)
+            {
+                exitcode = 1;
+            }
+        }
+        std::cout << "total mappertime=" << totaltime << " baseline=" << basetotaltime << std::endl;
+        if (checktime && basetotaltime >= mintime)
+        {
+            bench_result_t total = { "total", "all", true, 0, totaltime, 0, 0, 0, 0 };
+            if (regressed(total, "mappertime", totaltime, basetotaltime, threshold))
+            {
+                exitcode = 1;
+            }
+        }
+    }
+    return exitcode;
+}
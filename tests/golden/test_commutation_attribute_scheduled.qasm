@@ -0,0 +1,22 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 7
+.aKernel
+
+    cnot q[0],q[3]
+    wait 3
+    x q[3]
+    cnot q[6],q[3]
+    wait 3
+    y q[6]
+    { t q[6] | cz q[3],q[1] | cz q[3],q[5] }
+    i q[3]
+    z q[3]
+    y q[6]
+    cz q[3],q[6]
+    wait 1
+    { y q[5] | y q[6] }
+    { t q[5] | t q[6] }
+    wait 2
+    { y q[5] | y q[6] }
+
@@ -0,0 +1,17 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 7
+.aKernel
+
+    cnot q[5],q[3]
+    wait 3
+    { cnot q[1],q[3] | y q[5] }
+    t q[5]
+    { cnot q[0],q[3] | cnot q[6],q[3] }
+    wait 1
+    { y q[1] | y q[5] }
+    { x q[3] | rx90 q[3] | t q[1] | xm90 q[3] | t q[5] | x45 q[3] }
+    cz q[3],q[0]
+    wait 1
+    { y q[6] | y q[1] | y q[5] | y q[0] | y q[3] }
+
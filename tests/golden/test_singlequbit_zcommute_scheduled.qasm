@@ -0,0 +1,16 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 7
+.aKernel
+
+    cz q[5],q[3]
+    wait 1
+    { cnot q[3],q[1] | y q[5] }
+    t q[5]
+    wait 2
+    { y q[1] | y q[5] }
+    { t q[3] | t q[1] | s q[3] | t q[5] | sdag q[3] }
+    { cz q[0],q[3] | cz q[3],q[6] | z q[3] }
+    wait 1
+    { y q[6] | y q[1] | y q[5] | y q[3] }
+
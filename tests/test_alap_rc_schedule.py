@@ -17,6 +17,7 @@ class Test_Alap_Rc_Schedule(unittest.TestCase):
     def setUp(self):
         ql.set_option('scheduler', self._SCHEDULER)
         ql.set_option('output_dir', output_dir)
+        ql.set_option('scheduler_threads', '1')
 
     def test_qwg(self):
         # parameters
@@ -340,6 +341,59 @@ class Test_Alap_Rc_Schedule(unittest.TestCase):
         assemble(QISA_fn)
         self.assertTrue(file_compare(QISA_fn, GOLD_fn))
 
+    def test_kernels_threads(self):
+        # several kernels with resource conflicts of different kinds, scheduled with 1 and with 4 threads;
+        # kernels are scheduled independently, so the result must be the same
+        scheduler = self._SCHEDULER
+
+        qisa = {}
+        for threads in ['1', '4']:
+            ql.set_option('scheduler_threads', threads)
+
+            prog_name = "test_kernels_threads" + threads + '_' + scheduler
+            starmon = ql.Platform("starmon", self.config)
+            prog = ql.Program(prog_name, starmon, 7, 0)
+
+            k = ql.Kernel("kernel_qwg_" + scheduler, starmon, 7, 0)
+            for j in range(7):
+                k.gate("x", [j])
+            for j in range(7):
+                k.gate("y", [j])
+            prog.add_kernel(k)
+
+            k = ql.Kernel("kernel_edge_" + scheduler, starmon, 7, 0)
+            k.gate("cz", [1, 4])
+            k.gate("cz", [0, 3])
+            k.gate("cz", [2, 5])
+            prog.add_kernel(k)
+
+            k = ql.Kernel("kernel_detuned_" + scheduler, starmon, 7, 0)
+            k.gate("cz", [0, 2])
+            k.gate("cz", [1, 4])
+            k.gate("x", [3])
+            k.gate("y", [3])
+            k.gate("cz", [2, 5])
+            k.gate("cz", [4, 6])
+            prog.add_kernel(k)
+
+            k = ql.Kernel("kernel_meas_" + scheduler, starmon, 7, 0)
+            for j in range(7):
+                k.gate("prepz", [j])
+            k.gate("h", [0])
+            k.gate("t", [0])
+            k.gate("h", [2])
+            for j in range(7):
+                k.gate("measure", [j])
+            prog.add_kernel(k)
+
+            ql.set_option("scheduler", scheduler)
+            prog.compile()
+
+            qisa[threads] = os.path.join(output_dir, prog.name+'.qisa')
+            assemble(qisa[threads])
+
+        self.assertTrue(file_compare(qisa['4'], qisa['1']))
+
 
 if __name__ == '__main__':
     # ql.set_option('log_level', 'LOG_DEBUG')
@@ -3,9 +3,11 @@ import os
 import unittest
 from openql import openql as ql
 from test_QISA_assembler_present import assemble
+from utils import file_compare
 
 curdir = os.path.dirname(__file__)
 output_dir = os.path.join(curdir, 'test_output')
+rootDir = os.path.dirname(os.path.realpath(__file__))
 ql.set_option('output_dir', output_dir)
 
 class Test_CCL_long_duration(unittest.TestCase):
@@ -54,6 +56,48 @@ class Test_CCL_long_duration(unittest.TestCase):
         QISA_fn = os.path.join(output_dir, p.name+'.qisa')
         assemble(QISA_fn)
 
+    def resource_conflicts(self, scheduler):
+        # gates of 40000 (prepz) and 700 (measure) cycles that keep a qwg, a measurement unit
+        # and qubits busy, and cz's on conflicting edges;
+        # the scheduler must skip the cycles in which these are busy;
+        # a list scheduler schedules the same with reservations kept as intervals (resource_timeline)
+        config_fn = os.path.join(curdir, 'test_cfg_CCL_long_duration.json')
+        ql.set_option('scheduler', scheduler)
+        ql.set_option('scheduler_uniform', 'no')
+
+        for timeline in ['no', 'yes']:
+            ql.set_option('resource_timeline', timeline)
+
+            platf  = ql.Platform('seven_qubits_chip', config_fn)
+            p = ql.Program("test_long_resource_conflicts_" + scheduler, platf, platf.get_qubit_number())
+            k = ql.Kernel("kernel_" + scheduler, platf, platf.get_qubit_number())
+            k.gate("prepz", [0])
+            k.gate("rx180", [1])        # qwg 0 with prepz q0
+            k.gate("prepz", [2])
+            k.gate("ry180", [3])        # qwg 1 with prepz q2
+            k.gate("measure", [0])
+            k.gate("measure", [3])      # measurement unit 0 with measure q0
+            k.gate("cz", [2, 0])
+            k.gate("cz", [3, 1])        # edge conflicting with cz q2,q0
+            k.gate("rx180", [4])
+            k.gate("measure", [1])
+            k.gate("measure", [4])      # measurement unit 1 with measure q1
+            k.gate("ry180", [0])
+            p.add_kernel(k)
+            p.compile()
+
+            GOLD_fn = os.path.join(rootDir, 'golden', p.name + '.qisa')
+            QISA_fn = os.path.join(output_dir, p.name+'.qisa')
+            assemble(QISA_fn)
+            self.assertTrue(file_compare(QISA_fn, GOLD_fn))
+        ql.set_option('resource_timeline', 'no')
+
+    def test_resource_conflicts_ASAP(self):
+        self.resource_conflicts('ASAP')
+
+    def test_resource_conflicts_ALAP(self):
+        self.resource_conflicts('ALAP')
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -1,4 +1,5 @@
 import os
+import json
 from utils import file_compare
 import unittest
 from openql import openql as ql
@@ -173,5 +174,144 @@ class Test_commutation(unittest.TestCase):
         qasm_fn = os.path.join(output_dir, p.name+'_scheduled.qasm')
         self.assertTrue( file_compare(qasm_fn, gold_fn) )
 
+    def test_singlequbit_zcommute(self):
+        # t, z, s and sdag are diagonal in the Z basis, so they commute with cz and with the control of cnot
+        config_fn = os.path.join(curdir, 'test_179.json')
+        platf = ql.Platform("starmon", config_fn)
+        ql.set_option("scheduler", 'ALAP');
+        ql.set_option("scheduler_post179", 'yes');
+        ql.set_option("scheduler_commute", 'yes');
+        ql.set_option("scheduler_commute_rotations", 'yes');
+
+        nqubits = 7
+        k = ql.Kernel("aKernel", platf, nqubits)
+
+        k.gate("cz", [0,3]);
+        k.gate("t", [3]);
+        k.gate("cz", [3,6]);
+        k.gate("y", [6]);
+        k.gate("z", [3]);
+        k.gate("cnot", [3,1]);
+        k.gate("y", [1]);
+        k.gate("t", [1]);
+        k.gate("y", [1]);
+        k.gate("s", [3]);
+        k.gate("cz", [5,3]);
+        k.gate("y", [5]);
+        k.gate("t", [5]);
+        k.gate("y", [5]);
+        k.gate("t", [5]);
+        k.gate("y", [5]);
+        k.gate("sdag", [3]);
+        k.gate("y", [3]);
+
+        sweep_points = [2]
+
+        p = ql.Program("test_singlequbit_zcommute", platf, nqubits)
+        p.set_sweep_points(sweep_points)
+        p.add_kernel(k)
+        p.compile()
+        ql.set_option("scheduler_commute_rotations", 'no');
+
+        gold_fn = rootDir + '/golden/'+ p.name + '_scheduled.qasm'
+        qasm_fn = os.path.join(output_dir, p.name+'_scheduled.qasm')
+        self.assertTrue( file_compare(qasm_fn, gold_fn) )
+
+    def test_singlequbit_xcommute(self):
+        # x, rx90, xm90 and x45 are diagonal in the X basis, so they commute with the target of cnot
+        # but not with cz
+        config_fn = os.path.join(curdir, 'test_179.json')
+        platf = ql.Platform("starmon", config_fn)
+        ql.set_option("scheduler", 'ALAP');
+        ql.set_option("scheduler_post179", 'yes');
+        ql.set_option("scheduler_commute", 'yes');
+        ql.set_option("scheduler_commute_rotations", 'yes');
+
+        nqubits = 7
+        k = ql.Kernel("aKernel", platf, nqubits)
+
+        k.gate("cnot", [0,3]);
+        k.gate("x", [3]);
+        k.gate("cnot", [6,3]);
+        k.gate("y", [6]);
+        k.gate("rx90", [3]);
+        k.gate("cnot", [1,3]);
+        k.gate("y", [1]);
+        k.gate("t", [1]);
+        k.gate("y", [1]);
+        k.gate("xm90", [3]);
+        k.gate("cnot", [5,3]);
+        k.gate("y", [5]);
+        k.gate("t", [5]);
+        k.gate("y", [5]);
+        k.gate("t", [5]);
+        k.gate("y", [5]);
+        k.gate("x45", [3]);
+        k.gate("cz", [3,0]);
+        k.gate("y", [0]);
+        k.gate("y", [3]);
+
+        sweep_points = [2]
+
+        p = ql.Program("test_singlequbit_xcommute", platf, nqubits)
+        p.set_sweep_points(sweep_points)
+        p.add_kernel(k)
+        p.compile()
+        ql.set_option("scheduler_commute_rotations", 'no');
+
+        gold_fn = rootDir + '/golden/'+ p.name + '_scheduled.qasm'
+        qasm_fn = os.path.join(output_dir, p.name+'_scheduled.qasm')
+        self.assertTrue( file_compare(qasm_fn, gold_fn) )
+
+    def test_commutation_attribute(self):
+        # the "commutation" attribute of an instruction overrides the classes derived from its name:
+        # here x doesn't commute with the target of cnot, and i commutes with cz and the control of cnot;
+        # without scheduler_commute_rotations, t and z don't commute with anything
+        with open(os.path.join(curdir, 'test_179.json')) as f:
+            config = json.load(f)
+        config["instructions"]["x"]["commutation"] = ["none"]
+        config["instructions"]["i"]["commutation"] = ["z"]
+        config_fn = os.path.join(output_dir, 'test_commutation_attribute.json')
+        with open(config_fn, 'w') as f:
+            json.dump(config, f, indent=4)
+
+        platf = ql.Platform("starmon", config_fn)
+        ql.set_option("scheduler", 'ALAP');
+        ql.set_option("scheduler_post179", 'yes');
+        ql.set_option("scheduler_commute", 'yes');
+        ql.set_option("scheduler_commute_rotations", 'no');
+
+        nqubits = 7
+        k = ql.Kernel("aKernel", platf, nqubits)
+
+        k.gate("cnot", [0,3]);
+        k.gate("x", [3]);
+        k.gate("cnot", [6,3]);
+        k.gate("y", [6]);
+        k.gate("t", [6]);
+        k.gate("y", [6]);
+        k.gate("cz", [3,1]);
+        k.gate("i", [3]);
+        k.gate("cz", [3,5]);
+        k.gate("y", [5]);
+        k.gate("t", [5]);
+        k.gate("y", [5]);
+        k.gate("z", [3]);
+        k.gate("cz", [3,6]);
+        k.gate("y", [6]);
+        k.gate("t", [6]);
+        k.gate("y", [6]);
+
+        sweep_points = [2]
+
+        p = ql.Program("test_commutation_attribute", platf, nqubits)
+        p.set_sweep_points(sweep_points)
+        p.add_kernel(k)
+        p.compile()
+
+        gold_fn = rootDir + '/golden/'+ p.name + '_scheduled.qasm'
+        qasm_fn = os.path.join(output_dir, p.name+'_scheduled.qasm')
+        self.assertTrue( file_compare(qasm_fn, gold_fn) )
+
 if __name__ == '__main__':
     unittest.main()
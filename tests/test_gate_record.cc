@@ -0,0 +1,154 @@
+// tests of the compact gate records of src/gate_record.h:
+// the attributes of gates of which the operands fit are inline in the record,
+// those of other gates are spilled and then read from the gate by compact_circuit_t
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+
+#include <gate_record.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond << std::endl;  \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+// gates with operands and durations that fit are recorded inline
+void
+test_inline()
+{
+    ql::hadamard    h(2);
+    ql::cnot        cx(0, 1);
+    ql::toffoli     tf(4, 5, 6);
+    ql::measure     ms(3, 1);
+    ql::circuit     c = { &h, &cx, &tf, &ms };
+    ql::compact_circuit_t   kc(c);
+
+    CHECK(kc.size() == 4);
+    for (size_t i = 0; i < kc.size(); i++)
+    {
+        CHECK(!kc[i].spilled);
+        CHECK(kc.gate(i) == c[i]);
+        CHECK(kc[i].type() == c[i]->type());
+        CHECK(kc[i].name() == c[i]->name);
+        CHECK(kc.duration(i) == c[i]->duration);
+        CHECK(kc[i].duration == c[i]->duration);
+        CHECK(kc.qubit_count(i) == c[i]->operands.size());
+        CHECK(kc[i].nqubits == c[i]->operands.size());
+        for (size_t k = 0; k < kc.qubit_count(i); k++)
+        {
+            CHECK(kc.qubit(i, k) == c[i]->operands[k]);
+            CHECK(kc[i].qubits[k] == c[i]->operands[k]);
+        }
+        CHECK(kc.creg_count(i) == c[i]->creg_operands.size());
+        for (size_t k = 0; k < kc.creg_count(i); k++)
+        {
+            CHECK(kc.creg(i, k) == c[i]->creg_operands[k]);
+        }
+    }
+    CHECK(kc.creg_count(3) == 1 && kc.creg(3, 0) == 1);
+}
+
+// gates with more operands than fit inline, with operands beyond 32 bits
+// or with a duration beyond 32 bits are recorded as spilled
+void
+test_spilled()
+{
+    ql::hadamard    manyq(0);
+    manyq.operands = { 0, 1, 2, 3 };
+    ql::cnot        manyc(0, 1);
+    manyc.creg_operands = { 2, 3 };
+    ql::hadamard    bigq(0);
+    bigq.operands = { size_t(1) << 32 };
+    ql::cnot        bigc(2, 3);
+    bigc.creg_operands = { size_t(1) << 33 };
+    ql::cphase      longd(5, 6);
+    longd.duration = (size_t(1) << 32) + 20;
+    ql::circuit     c = { &manyq, &manyc, &bigq, &bigc, &longd };
+    ql::compact_circuit_t   kc(c);
+
+    for (size_t i = 0; i < kc.size(); i++)
+    {
+        CHECK(kc[i].spilled);
+        CHECK(kc[i].nqubits == 0 && kc[i].ncregs == 0 && kc[i].duration == 0);
+        CHECK(kc[i].type() == c[i]->type());
+        CHECK(kc[i].name() == c[i]->name);
+        CHECK(kc.duration(i) == c[i]->duration);
+        CHECK(kc.qubit_count(i) == c[i]->operands.size());
+        for (size_t k = 0; k < kc.qubit_count(i); k++)
+        {
+            CHECK(kc.qubit(i, k) == c[i]->operands[k]);
+        }
+        CHECK(kc.creg_count(i) == c[i]->creg_operands.size());
+        for (size_t k = 0; k < kc.creg_count(i); k++)
+        {
+            CHECK(kc.creg(i, k) == c[i]->creg_operands[k]);
+        }
+    }
+    CHECK(kc.qubit_count(0) == 4);
+    CHECK(kc.qubit(2, 0) == size_t(1) << 32);
+    CHECK(kc.creg(3, 0) == size_t(1) << 33);
+    CHECK(kc.duration(4) == (size_t(1) << 32) + 20);
+}
+
+// equal names get equal ids, and records made without names don't intern them
+void
+test_names()
+{
+    ql::hadamard    h1(0);
+    ql::cnot        cx(0, 1);
+    ql::hadamard    h2(1);
+    ql::circuit     c = { &h1, &cx, &h2 };
+    ql::compact_circuit_t   kc(c);
+    ql::compact_circuit_t   kcnn(c, false);
+
+    CHECK(kc[0].name_id == kc[2].name_id);
+    CHECK(kc[0].name_id != kc[1].name_id);
+    CHECK(kc[0].name_id == ql::instruction_names::id(h1.name));
+    CHECK(ql::instruction_names::name(kc[1].name_id) == cx.name);
+    for (size_t i = 0; i < kcnn.size(); i++)
+    {
+        CHECK(kcnn[i].name_id == ql::gate_record_t::no_name);
+        CHECK(kcnn.qubit(i, 0) == kc.qubit(i, 0));
+    }
+}
+
+// cycles changed in the records are copied back to the gates
+void
+test_write_cycles()
+{
+    ql::hadamard    h(0);
+    ql::hadamard    manyq(0);
+    manyq.operands = { 0, 1, 2, 3 };
+    ql::circuit     c = { &h, &manyq };
+    ql::compact_circuit_t   kc(c);
+
+    kc[0].cycle = 7;
+    kc[1].cycle = 9;
+    kc.write_cycles();
+    CHECK(h.cycle == 7);
+    CHECK(manyq.cycle == 9);
+}
+
+int main(int argc, char ** argv)
+{
+    test_inline();
+    test_spilled();
+    test_names();
+    test_write_cycles();
+
+    if (failures != 0)
+    {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
@@ -5,8 +5,9 @@
 #
 # assumes config files: test_mapper_rig.json, test_mapper_s7.json and test_mapper_s17.json
 #
-# written to avoid initial placement since that is not portable
-# (although turning it on with options and enabling it by uncommenting first line of src/mapper.h would test it)
+# written to avoid initial placement by the MIP solver since that is not portable
+# (although turning it on with options and enabling it by uncommenting first line of src/mapper.h would test it);
+# initial placement by the heuristic placer (option initialplaceportfolio) is tested
 # for option assumptions, see setUp below
 # see for more details, comment lines with each individual test below
 
@@ -47,6 +48,7 @@ class Test_mapper(unittest.TestCase):
         ql.set_option('mapinitone2one', 'yes')
         ql.set_option('initialplace', 'no')
         ql.set_option('initialplace2qhorizon', '0')
+        ql.set_option('initialplaceportfolio', 'no')
         ql.set_option('mapusemoves', 'yes')
         ql.set_option('mapreverseswap', 'yes')
         ql.set_option('mappathselect', 'all')
@@ -54,6 +56,10 @@ class Test_mapper(unittest.TestCase):
         ql.set_option('maprecNN2q', 'no')
         ql.set_option('mapselectmaxlevel', '0')
         ql.set_option('mapselectmaxwidth', 'min')
+        ql.set_option('mapper_threads', '1')
+        ql.set_option('mapbeamwidth', '4')
+        ql.set_option('maplookaheadwindow', '0')
+        ql.set_option('resource_timeline', 'no')
         
         ql.set_option('write_qasm_files', 'no')
         ql.set_option('write_report_files', 'no')
@@ -399,6 +405,232 @@ class Test_mapper(unittest.TestCase):
 
 
 
+    def test_mapper_threads(self):
+        # the allD circuit, mapped with lookahead so that alternatives are evaluated in parallel;
+        # worker threads create their gates in private kernels and arenas,
+        # so the result must be the same with 4 threads as with 1 thread
+        config = os.path.join(rootDir, "test_mapper_s7.json")
+        num_qubits = 7
+        ql.set_option('mapselectmaxlevel', '1')
+
+        qisa = {}
+        for threads in ['1', '4']:
+            ql.set_option('mapper_threads', threads)
+
+            prog_name = "test_mapper_threads" + threads
+            kernel_name = "kernel_threads"
+            starmon = ql.Platform("starmon", config)
+            prog = ql.Program(prog_name, starmon, num_qubits, 0)
+            k = ql.Kernel(kernel_name, starmon, num_qubits, 0)
+
+            for j in range(7):
+                k.gate("x", [j])
+            for i in range(7):
+                for j in range(7):
+                    if (i != j):
+                        k.gate("cnot", [i,j])
+            for j in range(7):
+                k.gate("x", [j])
+
+            prog.add_kernel(k)
+            prog.compile()
+
+            qisa[threads] = os.path.join(output_dir, prog.name+'.qisa')
+            assemble(qisa[threads])
+
+        self.assertTrue(file_compare(qisa['4'], qisa['1']))
+
+
+    def test_mapper_threads_select(self):
+        # the allDopt circuit, mapped with deeper and wider lookahead and the critical tie break,
+        # evaluating alternatives by a pool of 3 threads;
+        # each alternative is evaluated independently of the thread doing so,
+        # so the result must be the same as with 1 thread
+        config = os.path.join(rootDir, "test_mapper_s7.json")
+        num_qubits = 7
+        ql.set_option('mapselectmaxlevel', '2')
+        ql.set_option('mapselectmaxwidth', 'minplusone')
+        ql.set_option('maptiebreak', 'critical')
+        cnots = [[0,3],[3,0],[6,4],[4,6],[3,1],[1,3],[5,2],[2,5],[1,4],[4,1],[3,5],[5,3],
+                 [6,3],[3,6],[2,0],[0,2],[0,1],[1,0],[3,4],[4,3],[1,6],[6,1],[6,5],[5,6],
+                 [3,2],[2,3],[5,0],[0,5],[0,6],[6,0],[1,5],[5,1],[0,4],[4,0],[6,2],[2,6],
+                 [2,1],[1,2],[5,4],[4,5],[2,4],[4,2]]
+
+        qisa = {}
+        for threads in ['1', '3']:
+            ql.set_option('mapper_threads', threads)
+
+            prog_name = "test_mapper_threads_select" + threads
+            kernel_name = "kernel_threads_select"
+            starmon = ql.Platform("starmon", config)
+            prog = ql.Program(prog_name, starmon, num_qubits, 0)
+            k = ql.Kernel(kernel_name, starmon, num_qubits, 0)
+
+            for j in range(7):
+                k.gate("x", [j])
+            for c in cnots:
+                k.gate("cnot", c)
+            for j in range(7):
+                k.gate("x", [j])
+
+            prog.add_kernel(k)
+            prog.compile()
+
+            qisa[threads] = os.path.join(output_dir, prog.name+'.qisa')
+            assemble(qisa[threads])
+
+        self.assertTrue(file_compare(qisa['3'], qisa['1']))
+
+
+    def test_mapper_beam(self):
+        # the allD circuit, mapped by the beam mapper looking 3 levels ahead;
+        # the entries of a level are expanded in parallel with more threads,
+        # so the result must be the same with 1 thread as with 4 threads
+        config = os.path.join(rootDir, "test_mapper_s7.json")
+        num_qubits = 7
+        ql.set_option('mapper', 'beam')
+        ql.set_option('mapbeamwidth', '4')
+        ql.set_option('mapselectmaxlevel', '3')
+
+        for threads in ['1', '4']:
+            ql.set_option('mapper_threads', threads)
+
+            prog_name = "test_mapper_beam"
+            kernel_name = "kernel_beam"
+            starmon = ql.Platform("starmon", config)
+            prog = ql.Program(prog_name, starmon, num_qubits, 0)
+            k = ql.Kernel(kernel_name, starmon, num_qubits, 0)
+
+            for j in range(7):
+                k.gate("x", [j])
+            for i in range(7):
+                for j in range(7):
+                    if (i != j):
+                        k.gate("cnot", [i,j])
+            for j in range(7):
+                k.gate("x", [j])
+
+            prog.add_kernel(k)
+            prog.compile()
+
+            GOLD_fn = os.path.join(rootDir, 'golden', prog.name + '.qisa')
+            QISA_fn = os.path.join(output_dir, prog.name+'.qisa')
+
+            assemble(QISA_fn)
+            self.assertTrue(file_compare(QISA_fn, GOLD_fn))
+
+
+    def test_mapper_window(self):
+        # the allD circuit, mapped looking 1 level ahead with a window of 8 gates in the dependence graph,
+        # so that the graph is refilled several times;
+        # the alternatives are evaluated on forks of the future in parallel with more threads,
+        # so the result must be the same with 1 thread as with 4 threads
+        config = os.path.join(rootDir, "test_mapper_s7.json")
+        num_qubits = 7
+        ql.set_option('mapselectmaxlevel', '1')
+        ql.set_option('maplookaheadwindow', '8')
+
+        for threads in ['1', '4']:
+            ql.set_option('mapper_threads', threads)
+
+            prog_name = "test_mapper_window"
+            kernel_name = "kernel_window"
+            starmon = ql.Platform("starmon", config)
+            prog = ql.Program(prog_name, starmon, num_qubits, 0)
+            k = ql.Kernel(kernel_name, starmon, num_qubits, 0)
+
+            for j in range(7):
+                k.gate("x", [j])
+            for i in range(7):
+                for j in range(7):
+                    if (i != j):
+                        k.gate("cnot", [i,j])
+            for j in range(7):
+                k.gate("x", [j])
+
+            prog.add_kernel(k)
+            prog.compile()
+
+            GOLD_fn = os.path.join(rootDir, 'golden', prog.name + '.qisa')
+            QISA_fn = os.path.join(output_dir, prog.name+'.qisa')
+
+            assemble(QISA_fn)
+            self.assertTrue(file_compare(QISA_fn, GOLD_fn))
+
+
+    def test_mapper_timeline(self):
+        # the allD circuit, mapped with the resource reservations kept as intervals and as busy cycles;
+        # with intervals, the mapper's scheduler can put gates in gaps left earlier in the schedule,
+        # so the result is different, here shorter
+        config = os.path.join(rootDir, "test_mapper_s7.json")
+        num_qubits = 7
+
+        for timeline in ['no', 'yes']:
+            ql.set_option('resource_timeline', timeline)
+
+            prog_name = "test_mapper_timeline_" + timeline
+            kernel_name = "kernel_timeline"
+            starmon = ql.Platform("starmon", config)
+            prog = ql.Program(prog_name, starmon, num_qubits, 0)
+            k = ql.Kernel(kernel_name, starmon, num_qubits, 0)
+
+            for j in range(7):
+                k.gate("x", [j])
+            for i in range(7):
+                for j in range(7):
+                    if (i != j):
+                        k.gate("cnot", [i,j])
+            for j in range(7):
+                k.gate("x", [j])
+
+            prog.add_kernel(k)
+            prog.compile()
+
+            GOLD_fn = os.path.join(rootDir, 'golden', prog.name + '.qisa')
+            QISA_fn = os.path.join(output_dir, prog.name+'.qisa')
+
+            assemble(QISA_fn)
+            self.assertTrue(file_compare(QISA_fn, GOLD_fn))
+
+
+    def test_mapper_allIPheur(self):
+        # the allIP circuit, now with initial placement by the heuristic placer, which is portable;
+        # it should find a placement in which all cnots are nearest neighbor, so no swaps/moves are inserted
+        v = 'allIPheur'
+        config = os.path.join(rootDir, "test_mapper_s7.json")
+        num_qubits = 7
+        ql.set_option('initialplace', 'yes')
+        ql.set_option('initialplaceportfolio', 'yes')
+
+        # create and set platform
+        prog_name = "test_mapper_" + v
+        kernel_name = "kernel_" + v
+        starmon = ql.Platform("starmon", config)
+        prog = ql.Program(prog_name, starmon, num_qubits, 0)
+        k = ql.Kernel(kernel_name, starmon, num_qubits, 0)
+
+        for j in range(7):
+            k.gate("x", [j])
+        k.gate("cnot", [0,1]);
+        k.gate("cnot", [1,2]);
+        k.gate("cnot", [2,3]);
+        k.gate("cnot", [3,4]);
+        k.gate("cnot", [4,5]);
+        k.gate("cnot", [5,6]);
+        for j in range(7):
+            k.gate("x", [j])
+
+        prog.add_kernel(k)
+        prog.compile()
+
+        GOLD_fn = os.path.join(rootDir, 'golden', prog.name + '.qisa')
+        QISA_fn = os.path.join(output_dir, prog.name+'.qisa')
+
+        assemble(QISA_fn)
+        self.assertTrue(file_compare(QISA_fn, GOLD_fn))
+
+
+
     def test_mapper_lingling5(self):
         # parameters
         # 'realistic' circuit
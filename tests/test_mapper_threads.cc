@@ -0,0 +1,98 @@
+// test of the mapper with more than one worker thread (option mapper_threads):
+// the alternatives are then evaluated concurrently on forks of the mapper's past and future,
+// which share the dependence graph and the gates of the input circuit;
+// the mapped circuit, with the cycles of its gates, must be the same as with one thread;
+// build with -fsanitize=thread (e.g. cmake -DCMAKE_CXX_FLAGS=-fsanitize=thread) to also check for data races
+
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include <openql_i.h>
+#include <mapper.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            std::cout << __FILE__ << ":" << __LINE__ << ": failed: " #cond << std::endl;  \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+// map the allD circuit, with each qubit interacting with each other one,
+// and return the mapped circuit as qasm with the cycle of each gate, and the number of forks of the past made
+std::string
+map_allD(std::string threads, size_t& npastforks)
+{
+    int n = 7;
+    ql::options::set("mapper_threads", threads);
+    ql::quantum_platform starmon("starmon", "test_mapper_s7.json");
+    ql::set_platform(starmon);
+    ql::quantum_kernel k("kernel_threads", starmon, n, 0);
+
+    for (int j=0; j<n; j++) { k.gate("x", j); }
+    for (int i=0; i<n; i++) { for (int j=0; j<n; j++) { if (i != j) { k.gate("cnot", i,j); } } }
+    for (int j=0; j<n; j++) { k.gate("x", j); }
+
+    Mapper mapper;
+    mapper.Init(&starmon);
+    mapper.Map(k);
+    npastforks = mapper.stats.npastforks;
+
+    std::stringstream ss;
+    for (auto gp : k.c)
+    {
+        ss << gp->cycle << ": " << gp->qasm() << "\n";
+    }
+    return ss.str();
+}
+
+// map with the given mapper and 1 or 4 threads, with lookahead so that alternatives are evaluated in parallel
+void
+test_threads(std::string mapperopt)
+{
+    ql::options::set("mapper", mapperopt);
+    size_t      npastforks1, npastforks4;
+    std::string mapped1 = map_allD("1", npastforks1);
+    std::string mapped4 = map_allD("4", npastforks4);
+    CHECK(!mapped1.empty());
+    CHECK(mapped1 == mapped4);
+    if (mapperopt != "beam")
+    {
+        CHECK(npastforks1 == 0 && npastforks4 > 0);     // with 4 threads, alternatives were evaluated on forks
+    }
+    if (mapped1 != mapped4)
+    {
+        std::cout << "mapper=" << mapperopt << " with 1 thread:\n" << mapped1 << "with 4 threads:\n" << mapped4;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    ql::utils::logger::set_log_level("LOG_NOTHING");
+    ql::options::set("use_default_gates", "no");
+    ql::options::set("mapinitone2one", "yes");
+    ql::options::set("initialplace", "no");
+    ql::options::set("mapusemoves", "no");
+    ql::options::set("maplookahead", "all");
+    ql::options::set("maprecNN2q", "no");
+    ql::options::set("mapselectmaxlevel", "1");
+    ql::options::set("mapselectmaxwidth", "min");
+    ql::options::set("maptiebreak", "first");
+    ql::options::set("mapbeamwidth", "4");
+
+    test_threads("minextendrc");
+    test_threads("maxfidelity");
+    test_threads("beam");
+
+    if (failures != 0)
+    {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}